@@ -30,6 +30,11 @@ std::string Settings::ToString() const {
   stream << "start_paused: " << start_paused << std::endl;
   stream << "trace_skia: " << trace_skia << std::endl;
   stream << "trace_startup: " << trace_startup << std::endl;
+  stream << "trace_categories:" << std::endl;
+  for (const auto& category : trace_categories) {
+    stream << "    " << category << std::endl;
+  }
+  stream << "trace_export_path: " << trace_export_path << std::endl;
   stream << "endless_trace_buffer: " << endless_trace_buffer << std::endl;
   stream << "enable_dart_profiling: " << enable_dart_profiling << std::endl;
   stream << "dart_non_checked_mode: " << dart_non_checked_mode << std::endl;
@@ -37,8 +42,23 @@ std::string Settings::ToString() const {
   stream << "observatory_port: " << observatory_port << std::endl;
   stream << "ipv6: " << ipv6 << std::endl;
   stream << "use_test_fonts: " << use_test_fonts << std::endl;
+  stream << "prewarm_font_families:" << std::endl;
+  for (const auto& family : prewarm_font_families) {
+    stream << "    " << family << std::endl;
+  }
+  stream << "prewarm_font_locales:" << std::endl;
+  for (const auto& locale : prewarm_font_locales) {
+    stream << "    " << locale << std::endl;
+  }
   stream << "enable_software_rendering: " << enable_software_rendering
          << std::endl;
+  stream << "latest_value_platform_channels:" << std::endl;
+  for (const auto& channel : latest_value_platform_channels) {
+    stream << "    " << channel << std::endl;
+  }
+  stream << "resample_pointer_events: " << resample_pointer_events
+         << std::endl;
+  stream << "vsync_refresh_rate: " << vsync_refresh_rate << std::endl;
   stream << "log_tag: " << log_tag << std::endl;
   stream << "icu_data_path: " << icu_data_path << std::endl;
   stream << "assets_dir: " << assets_dir << std::endl;
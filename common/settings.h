@@ -38,6 +38,8 @@ struct Settings {
   std::string main_dart_file_path;
   std::string packages_file_path;
 
+  // Also the directory to which the rasterizer writes the frames that exceed
+  // the tracing threshold set on their scene.
   std::string temp_directory_path;
   std::vector<std::string> dart_flags;
 
@@ -45,6 +47,15 @@ struct Settings {
   bool start_paused = false;
   bool trace_skia = false;
   bool trace_startup = false;
+  // Categories of the trace events that are recorded. Events of all categories
+  // are recorded if empty. Events are only emitted while the Dart timeline or
+  // the trace exporter records them. Applies to all shells in the process.
+  std::vector<std::string> trace_categories;
+  // Trace events are recorded from startup without the Dart VM service and
+  // the most recent ones are written to this file, in the Chrome trace event
+  // format, each time the process receives SIGUSR2. Traces can also be written
+  // on request with messages on the flutter/tracing channel.
+  std::string trace_export_path;
   bool endless_trace_buffer = false;
   bool enable_dart_profiling = false;
   bool dart_non_checked_mode = false;
@@ -64,6 +75,12 @@ struct Settings {
 
   // Font settings
   bool use_test_fonts = false;
+  // Font families loaded on a background thread while the shell starts up so
+  // that the first frame showing text does not have to load them on the UI
+  // thread. Each family is loaded for each of the locales, or for the default
+  // locale if none are given.
+  std::vector<std::string> prewarm_font_families;
+  std::vector<std::string> prewarm_font_locales;
 
   // Engine settings
   TaskObserverAdd task_observer_add;
@@ -77,6 +94,16 @@ struct Settings {
   bool enable_software_rendering = false;
   bool skia_deterministic_rendering_on_cpu = false;
   bool verbose_logging = false;
+  // Platform channels on which only the most recent message is delivered to
+  // the isolate. Messages that are superseded before the UI thread gets to
+  // them are dropped and their responses completed empty.
+  std::vector<std::string> latest_value_platform_channels;
+  // Pointer data is held until the next frame and the moves of each pointer
+  // are merged into one move resampled to the frame time.
+  bool resample_pointer_events = false;
+  // The rate in Hz at which frames are paced when the platform has no vsync
+  // source. Frames are rendered as fast as possible if zero or less.
+  double vsync_refresh_rate = 60.0;
   std::string log_tag = "flutter";
   std::string icu_data_path;
 
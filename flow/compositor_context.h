@@ -9,6 +9,7 @@
 #include <string>
 
 #include "flutter/flow/instrumentation.h"
+#include "flutter/flow/layer_timings.h"
 #include "flutter/flow/raster_cache.h"
 #include "flutter/flow/texture.h"
 #include "lib/fxl/macros.h"
@@ -36,6 +37,14 @@ class CompositorContext {
 
     GrContext* gr_context() const { return gr_context_; }
 
+    // The layers of the frame are timed into |layer_timings| while it is set.
+    // It must outlive the rasterization of the frame.
+    void set_layer_timings(LayerTimings* layer_timings) {
+      layer_timings_ = layer_timings;
+    }
+
+    LayerTimings* layer_timings() const { return layer_timings_; }
+
     virtual bool Raster(LayerTree& layer_tree, bool ignore_raster_cache);
 
    private:
@@ -43,6 +52,7 @@ class CompositorContext {
     GrContext* gr_context_;
     SkCanvas* canvas_;
     const bool instrumentation_enabled_;
+    LayerTimings* layer_timings_ = nullptr;
 
     FXL_DISALLOW_COPY_AND_ASSIGN(ScopedFrame);
   };
@@ -0,0 +1,81 @@
+// Copyright 2018 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/flow/flow_test_utils.h"
+
+#include <chrono>
+#include <thread>
+
+#include "third_party/skia/include/core/SkPictureRecorder.h"
+
+namespace flow {
+
+TestLayer::TestLayer(const SkRect& bounds, fxl::TimeDelta paint_time)
+    : bounds_(bounds), paint_time_(paint_time) {}
+
+TestLayer::~TestLayer() = default;
+
+void TestLayer::Preroll(PrerollContext* context, const SkMatrix& matrix) {
+  set_paint_bounds(bounds_);
+}
+
+void TestLayer::Paint(PaintContext& context) const {
+  if (paint_time_ > fxl::TimeDelta::Zero()) {
+    std::this_thread::sleep_for(
+        std::chrono::microseconds(paint_time_.ToMicroseconds()));
+  }
+}
+
+TestPictureLayerFactory::TestPictureLayerFactory()
+    : unref_queue_(fxl::MakeRefCounted<SkiaUnrefQueue>(
+          thread_.GetTaskRunner(),
+          fxl::TimeDelta::Zero())) {}
+
+TestPictureLayerFactory::~TestPictureLayerFactory() = default;
+
+std::unique_ptr<PictureLayer> TestPictureLayerFactory::Make(
+    sk_sp<SkPicture> picture) {
+  auto layer = std::make_unique<PictureLayer>();
+  layer->set_picture({std::move(picture), unref_queue_});
+  layer->set_is_complex(true);
+  return layer;
+}
+
+sk_sp<SkPicture> GetSamplePicture() {
+  SkPictureRecorder recorder;
+  recorder.beginRecording(SkRect::MakeWH(150, 100));
+  SkPaint paint;
+  paint.setColor(SK_ColorRED);
+  recorder.getRecordingCanvas()->drawRect(SkRect::MakeXYWH(10, 10, 80, 80),
+                                          paint);
+  return recorder.finishRecordingAsPicture();
+}
+
+std::unique_ptr<LayerTree> MakeTestLayerTree(std::unique_ptr<Layer> root_layer,
+                                             const SkISize& frame_size) {
+  auto layer_tree = std::make_unique<LayerTree>();
+  layer_tree->set_frame_size(frame_size);
+  layer_tree->set_root_layer(std::move(root_layer));
+  return layer_tree;
+}
+
+bool RasterTestFrame(CompositorContext& compositor_context,
+                     LayerTree& layer_tree,
+                     bool ignore_raster_cache,
+                     LayerTimings* layer_timings) {
+  SkPictureRecorder recorder;
+  recorder.beginRecording(SkRect::MakeWH(layer_tree.frame_size().width(),
+                                         layer_tree.frame_size().height()));
+  bool rastered = false;
+  {
+    auto frame = compositor_context.AcquireFrame(
+        nullptr, recorder.getRecordingCanvas(), false);
+    frame->set_layer_timings(layer_timings);
+    rastered = frame->Raster(layer_tree, ignore_raster_cache);
+  }
+  recorder.finishRecordingAsPicture();
+  return rastered;
+}
+
+}  // namespace flow
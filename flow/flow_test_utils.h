@@ -0,0 +1,78 @@
+// Copyright 2018 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_FLOW_FLOW_TEST_UTILS_H_
+#define FLUTTER_FLOW_FLOW_TEST_UTILS_H_
+
+#include <memory>
+
+#include "flutter/flow/compositor_context.h"
+#include "flutter/flow/layer_timings.h"
+#include "flutter/flow/layers/layer.h"
+#include "flutter/flow/layers/layer_tree.h"
+#include "flutter/flow/layers/picture_layer.h"
+#include "flutter/flow/skia_gpu_object.h"
+#include "flutter/fml/thread.h"
+#include "lib/fxl/macros.h"
+#include "lib/fxl/time/time_delta.h"
+#include "third_party/skia/include/core/SkPicture.h"
+
+namespace flow {
+
+// A layer with fixed paint bounds that takes at least |paint_time| to paint.
+class TestLayer : public Layer {
+ public:
+  explicit TestLayer(const SkRect& bounds,
+                     fxl::TimeDelta paint_time = fxl::TimeDelta::Zero());
+
+  ~TestLayer() override;
+
+  void Preroll(PrerollContext* context, const SkMatrix& matrix) override;
+
+  void Paint(PaintContext& context) const override;
+
+  const char* GetTypeName() const override { return "TestLayer"; }
+
+ private:
+  const SkRect bounds_;
+  const fxl::TimeDelta paint_time_;
+
+  FXL_DISALLOW_COPY_AND_ASSIGN(TestLayer);
+};
+
+// Makes picture layers that the raster cache always considers, as they are
+// marked complex. Their pictures are released on a thread of the factory, so
+// the factory must outlive them.
+class TestPictureLayerFactory {
+ public:
+  TestPictureLayerFactory();
+
+  ~TestPictureLayerFactory();
+
+  std::unique_ptr<PictureLayer> Make(sk_sp<SkPicture> picture);
+
+ private:
+  fml::Thread thread_;
+  fxl::RefPtr<SkiaUnrefQueue> unref_queue_;
+
+  FXL_DISALLOW_COPY_AND_ASSIGN(TestPictureLayerFactory);
+};
+
+// A picture of a red square in a 150x100 frame.
+sk_sp<SkPicture> GetSamplePicture();
+
+std::unique_ptr<LayerTree> MakeTestLayerTree(std::unique_ptr<Layer> root_layer,
+                                             const SkISize& frame_size);
+
+// Rasters the layer tree in a frame of the compositor context onto a picture
+// recorder and returns whether that succeeded. The layers are timed if
+// |layer_timings| is not null.
+bool RasterTestFrame(CompositorContext& compositor_context,
+                     LayerTree& layer_tree,
+                     bool ignore_raster_cache,
+                     LayerTimings* layer_timings = nullptr);
+
+}  // namespace flow
+
+#endif  // FLUTTER_FLOW_FLOW_TEST_UTILS_H_
@@ -0,0 +1,43 @@
+// Copyright 2018 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/flow/layer_profile.h"
+
+namespace flow {
+
+static void AddEntry(LayerProfile::Totals& totals,
+                     const LayerTimings::Entry& entry) {
+  totals.count++;
+  totals.preroll_time = totals.preroll_time + entry.self_preroll_time;
+  totals.paint_time = totals.paint_time + entry.self_paint_time;
+  totals.raster_cache_time = totals.raster_cache_time + entry.raster_cache_time;
+}
+
+LayerProfile::LayerProfile() = default;
+
+LayerProfile::~LayerProfile() = default;
+
+void LayerProfile::AddFrame(const LayerTimings& timings) {
+  frame_count_++;
+  for (const auto& entry : timings.entries()) {
+    AddEntry(totals_by_type_[entry.type_name], entry);
+    if (entry.picture_id == 0) {
+      continue;
+    }
+    uint32_t picture_id = entry.picture_id;
+    if (totals_by_picture_.size() >= kMaxPictures &&
+        totals_by_picture_.count(picture_id) == 0) {
+      picture_id = 0;
+    }
+    AddEntry(totals_by_picture_[picture_id], entry);
+  }
+}
+
+void LayerProfile::Reset() {
+  frame_count_ = 0;
+  totals_by_type_.clear();
+  totals_by_picture_.clear();
+}
+
+}  // namespace flow
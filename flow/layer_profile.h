@@ -0,0 +1,64 @@
+// Copyright 2018 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_FLOW_LAYER_PROFILE_H_
+#define FLUTTER_FLOW_LAYER_PROFILE_H_
+
+#include <stdint.h>
+
+#include <map>
+#include <string>
+
+#include "flutter/flow/layer_timings.h"
+#include "lib/fxl/macros.h"
+#include "lib/fxl/time/time_delta.h"
+
+namespace flow {
+
+// Sums the layer timings of many frames by layer type and by picture. Only the
+// time layers spend themselves is summed, not that of their children, so that
+// the totals point at the layers that are expensive.
+class LayerProfile {
+ public:
+  struct Totals {
+    // The number of layers summed, over all frames.
+    size_t count = 0;
+    fxl::TimeDelta preroll_time;
+    fxl::TimeDelta paint_time;
+    fxl::TimeDelta raster_cache_time;
+  };
+
+  // Pictures are summed individually up to this many. The layers of other
+  // pictures are summed under picture 0.
+  static constexpr size_t kMaxPictures = 1024;
+
+  LayerProfile();
+
+  ~LayerProfile();
+
+  void AddFrame(const LayerTimings& timings);
+
+  void Reset();
+
+  size_t frame_count() const { return frame_count_; }
+
+  const std::map<std::string, Totals>& totals_by_type() const {
+    return totals_by_type_;
+  }
+
+  const std::map<uint32_t, Totals>& totals_by_picture() const {
+    return totals_by_picture_;
+  }
+
+ private:
+  size_t frame_count_ = 0;
+  std::map<std::string, Totals> totals_by_type_;
+  std::map<uint32_t, Totals> totals_by_picture_;
+
+  FXL_DISALLOW_COPY_AND_ASSIGN(LayerProfile);
+};
+
+}  // namespace flow
+
+#endif  // FLUTTER_FLOW_LAYER_PROFILE_H_
@@ -0,0 +1,87 @@
+// Copyright 2018 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/flow/layer_profile.h"
+
+#include <memory>
+
+#include "flutter/flow/compositor_context.h"
+#include "flutter/flow/flow_test_utils.h"
+#include "flutter/flow/layers/transform_layer.h"
+#include "gtest/gtest.h"
+
+TEST(LayerProfile, SumsTheSelfTimesOfLayersByType) {
+  const auto paint_time = fxl::TimeDelta::FromMilliseconds(1);
+  auto root = std::make_unique<flow::TransformLayer>();
+  root->set_transform(SkMatrix::I());
+  root->Add(std::make_unique<flow::TestLayer>(SkRect::MakeWH(10, 10),
+                                              paint_time));
+  root->Add(std::make_unique<flow::TestLayer>(SkRect::MakeWH(10, 10),
+                                              paint_time));
+  auto layer_tree =
+      flow::MakeTestLayerTree(std::move(root), SkISize::Make(100, 100));
+
+  flow::CompositorContext compositor_context;
+  flow::LayerProfile profile;
+  for (int i = 0; i < 2; i++) {
+    flow::LayerTimings timings;
+    ASSERT_TRUE(
+        flow::RasterTestFrame(compositor_context, *layer_tree, true, &timings));
+    profile.AddFrame(timings);
+  }
+
+  ASSERT_EQ(profile.frame_count(), 2u);
+  const auto& totals = profile.totals_by_type();
+  ASSERT_EQ(totals.size(), 2u);
+  ASSERT_EQ(totals.at("TestLayer").count, 4u);
+  ASSERT_EQ(totals.at("TransformLayer").count, 2u);
+  ASSERT_GE(totals.at("TestLayer").paint_time.ToMillisecondsF(), 4.0);
+  // The transform layers do not account for the time of their children.
+  ASSERT_LT(totals.at("TransformLayer").paint_time,
+            totals.at("TestLayer").paint_time);
+  ASSERT_TRUE(profile.totals_by_picture().empty());
+
+  profile.Reset();
+  ASSERT_EQ(profile.frame_count(), 0u);
+  ASSERT_TRUE(profile.totals_by_type().empty());
+}
+
+TEST(LayerProfile, SumsTheRasterCacheTimesOfPictures) {
+  flow::TestPictureLayerFactory picture_layers;
+  auto cached_picture = flow::GetSamplePicture();
+  auto other_picture = flow::GetSamplePicture();
+  auto root = std::make_unique<flow::TransformLayer>();
+  root->set_transform(SkMatrix::I());
+  root->Add(picture_layers.Make(cached_picture));
+  root->Add(picture_layers.Make(cached_picture));
+  root->Add(picture_layers.Make(other_picture));
+  auto layer_tree =
+      flow::MakeTestLayerTree(std::move(root), SkISize::Make(150, 100));
+
+  // The pictures are rasterized once they have been drawn often enough.
+  flow::CompositorContext compositor_context;
+  flow::LayerProfile profile;
+  for (int i = 0; i < 3; i++) {
+    flow::LayerTimings timings;
+    ASSERT_TRUE(flow::RasterTestFrame(compositor_context, *layer_tree, false,
+                                      &timings));
+    profile.AddFrame(timings);
+  }
+
+  const auto& pictures = profile.totals_by_picture();
+  ASSERT_EQ(pictures.size(), 2u);
+  const auto& cached = pictures.at(cached_picture->uniqueID());
+  const auto& other = pictures.at(other_picture->uniqueID());
+  // The layers of a picture are summed together.
+  ASSERT_EQ(cached.count, 6u);
+  ASSERT_EQ(other.count, 3u);
+  ASSERT_GT(cached.raster_cache_time, fxl::TimeDelta::Zero());
+  ASSERT_GT(other.raster_cache_time, fxl::TimeDelta::Zero());
+
+  const auto& picture_layer_totals =
+      profile.totals_by_type().at("PictureLayer");
+  ASSERT_EQ(picture_layer_totals.count, 9u);
+  ASSERT_EQ(picture_layer_totals.raster_cache_time,
+            cached.raster_cache_time + other.raster_cache_time);
+}
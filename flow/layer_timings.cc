@@ -0,0 +1,135 @@
+// Copyright 2018 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/flow/layer_timings.h"
+
+#include <iomanip>
+#include <sstream>
+
+#include "flutter/flow/layers/layer.h"
+#include "lib/fxl/logging.h"
+
+namespace flow {
+
+LayerTimings::LayerTimings() = default;
+
+LayerTimings::~LayerTimings() = default;
+
+size_t LayerTimings::IndexForLayer(const Layer& layer) {
+  auto found = indices_.find(&layer);
+  if (found != indices_.end()) {
+    return found->second;
+  }
+  Entry entry;
+  entry.type_name = layer.GetTypeName();
+  entry.depth = nested_times_.size();
+  entries_.push_back(entry);
+  indices_[&layer] = entries_.size() - 1;
+  return entries_.size() - 1;
+}
+
+void LayerTimings::BeginScope() {
+  nested_times_.push_back(fxl::TimeDelta::Zero());
+}
+
+fxl::TimeDelta LayerTimings::EndScope(fxl::TimeDelta elapsed) {
+  FXL_DCHECK(!nested_times_.empty());
+  const fxl::TimeDelta nested = nested_times_.back();
+  nested_times_.pop_back();
+  if (!nested_times_.empty()) {
+    nested_times_.back() = nested_times_.back() + elapsed;
+  }
+  return elapsed - nested;
+}
+
+LayerTimings::ScopedPreroll::ScopedPreroll(LayerTimings* timings,
+                                           const Layer& layer)
+    : timings_(timings), layer_(layer) {
+  if (!timings_) {
+    return;
+  }
+  // The entry is added before the children are prerolled so that entries end
+  // up in the order of the tree.
+  index_ = timings_->IndexForLayer(layer_);
+  timings_->BeginScope();
+  start_ = fxl::TimePoint::Now();
+}
+
+LayerTimings::ScopedPreroll::~ScopedPreroll() {
+  if (!timings_) {
+    return;
+  }
+  const fxl::TimeDelta elapsed = fxl::TimePoint::Now() - start_;
+  Entry& entry = timings_->entries_[index_];
+  entry.preroll_time = entry.preroll_time + elapsed;
+  entry.self_preroll_time =
+      entry.self_preroll_time + timings_->EndScope(elapsed);
+  entry.paint_bounds = layer_.paint_bounds();
+}
+
+LayerTimings::ScopedPaint::ScopedPaint(LayerTimings* timings,
+                                       const Layer& layer)
+    : timings_(timings), layer_(layer) {
+  if (!timings_) {
+    return;
+  }
+  timings_->BeginScope();
+  start_ = fxl::TimePoint::Now();
+}
+
+LayerTimings::ScopedPaint::~ScopedPaint() {
+  if (!timings_) {
+    return;
+  }
+  const fxl::TimeDelta elapsed = fxl::TimePoint::Now() - start_;
+  const fxl::TimeDelta self_elapsed = timings_->EndScope(elapsed);
+  Entry& entry = timings_->entries_[timings_->IndexForLayer(layer_)];
+  entry.paint_time = entry.paint_time + elapsed;
+  entry.self_paint_time = entry.self_paint_time + self_elapsed;
+}
+
+LayerTimings::ScopedRasterCache::ScopedRasterCache(LayerTimings* timings,
+                                                   const Layer& layer,
+                                                   uint32_t picture_id)
+    : timings_(timings), layer_(layer) {
+  if (!timings_) {
+    return;
+  }
+  timings_->entries_[timings_->IndexForLayer(layer_)].picture_id = picture_id;
+  timings_->BeginScope();
+  start_ = fxl::TimePoint::Now();
+}
+
+LayerTimings::ScopedRasterCache::~ScopedRasterCache() {
+  if (!timings_) {
+    return;
+  }
+  const fxl::TimeDelta elapsed = fxl::TimePoint::Now() - start_;
+  timings_->EndScope(elapsed);
+  Entry& entry = timings_->entries_[timings_->IndexForLayer(layer_)];
+  entry.raster_cache_time = entry.raster_cache_time + elapsed;
+}
+
+std::string LayerTimings::ToString() const {
+  std::stringstream stream;
+  stream << std::fixed << std::setprecision(3);
+  for (const auto& entry : entries_) {
+    stream << std::string(entry.depth * 2, ' ') << entry.type_name
+           << " preroll: " << entry.preroll_time.ToMillisecondsF()
+           << "ms paint: " << entry.paint_time.ToMillisecondsF()
+           << "ms self paint: " << entry.self_paint_time.ToMillisecondsF()
+           << "ms bounds: [" << entry.paint_bounds.left() << ", "
+           << entry.paint_bounds.top() << ", " << entry.paint_bounds.right()
+           << ", " << entry.paint_bounds.bottom() << "]";
+    if (entry.picture_id != 0) {
+      stream << " picture: " << entry.picture_id
+             << " raster cache: " << entry.raster_cache_time.ToMillisecondsF()
+             << "ms";
+    }
+    stream << std::endl;
+  }
+  return stream.str();
+}
+
+}  // namespace flow
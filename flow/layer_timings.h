@@ -0,0 +1,126 @@
+// Copyright 2018 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_FLOW_LAYER_TIMINGS_H_
+#define FLUTTER_FLOW_LAYER_TIMINGS_H_
+
+#include <stdint.h>
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "lib/fxl/macros.h"
+#include "lib/fxl/time/time_delta.h"
+#include "lib/fxl/time/time_point.h"
+#include "third_party/skia/include/core/SkRect.h"
+
+namespace flow {
+
+class Layer;
+
+// The time each layer of a frame took to preroll and to paint. Layers are
+// timed only while the preroll and paint contexts of the frame refer to a
+// LayerTimings, so frames that are not timed pay no more than a null check per
+// layer.
+class LayerTimings {
+ public:
+  struct Entry {
+    const char* type_name = nullptr;
+    // The depth of the layer in the tree. The root layer is at depth 0.
+    size_t depth = 0;
+    SkRect paint_bounds = SkRect::MakeEmpty();
+    // The unique ID of the picture of picture layers, zero for other layers.
+    uint32_t picture_id = 0;
+    // Including the children of the layer.
+    fxl::TimeDelta preroll_time;
+    fxl::TimeDelta paint_time;
+    // Excluding the children of the layer and the raster cache.
+    fxl::TimeDelta self_preroll_time;
+    fxl::TimeDelta self_paint_time;
+    // Spent looking up and populating the raster cache entry of the picture.
+    fxl::TimeDelta raster_cache_time;
+  };
+
+  // Times the preroll of a layer if |timings| is not null.
+  class ScopedPreroll {
+   public:
+    ScopedPreroll(LayerTimings* timings, const Layer& layer);
+
+    ~ScopedPreroll();
+
+   private:
+    LayerTimings* timings_;
+    const Layer& layer_;
+    size_t index_ = 0;
+    fxl::TimePoint start_;
+
+    FXL_DISALLOW_COPY_AND_ASSIGN(ScopedPreroll);
+  };
+
+  // Times the paint of a layer if |timings| is not null.
+  class ScopedPaint {
+   public:
+    ScopedPaint(LayerTimings* timings, const Layer& layer);
+
+    ~ScopedPaint();
+
+   private:
+    LayerTimings* timings_;
+    const Layer& layer_;
+    fxl::TimePoint start_;
+
+    FXL_DISALLOW_COPY_AND_ASSIGN(ScopedPaint);
+  };
+
+  // Times the raster cache work done for the picture of a picture layer
+  // during its preroll if |timings| is not null.
+  class ScopedRasterCache {
+   public:
+    ScopedRasterCache(LayerTimings* timings,
+                      const Layer& layer,
+                      uint32_t picture_id);
+
+    ~ScopedRasterCache();
+
+   private:
+    LayerTimings* timings_;
+    const Layer& layer_;
+    fxl::TimePoint start_;
+
+    FXL_DISALLOW_COPY_AND_ASSIGN(ScopedRasterCache);
+  };
+
+  LayerTimings();
+
+  ~LayerTimings();
+
+  // The timed layers, in the order in which they were prerolled. Layers come
+  // before their children.
+  const std::vector<Entry>& entries() const { return entries_; }
+
+  // One line per layer, indented by depth, with the preroll and paint times in
+  // milliseconds.
+  std::string ToString() const;
+
+ private:
+  std::vector<Entry> entries_;
+  std::unordered_map<const Layer*, size_t> indices_;
+  // For each scope being timed, from the outermost, the time spent in the
+  // scopes nested in it so far.
+  std::vector<fxl::TimeDelta> nested_times_;
+
+  size_t IndexForLayer(const Layer& layer);
+
+  void BeginScope();
+
+  // Returns the part of |elapsed| not spent in nested scopes.
+  fxl::TimeDelta EndScope(fxl::TimeDelta elapsed);
+
+  FXL_DISALLOW_COPY_AND_ASSIGN(LayerTimings);
+};
+
+}  // namespace flow
+
+#endif  // FLUTTER_FLOW_LAYER_TIMINGS_H_
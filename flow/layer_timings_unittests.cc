@@ -0,0 +1,83 @@
+// Copyright 2018 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/flow/layer_timings.h"
+
+#include <memory>
+#include <string>
+
+#include "flutter/flow/compositor_context.h"
+#include "flutter/flow/flow_test_utils.h"
+#include "flutter/flow/layers/transform_layer.h"
+#include "gtest/gtest.h"
+#include "third_party/skia/include/core/SkPictureRecorder.h"
+
+TEST(LayerTimings, TimesEachLayerOfTimedFramesInTreeOrder) {
+  auto child = std::make_unique<flow::TransformLayer>();
+  child->set_transform(SkMatrix::I());
+  child->Add(std::make_unique<flow::TestLayer>(SkRect::MakeWH(10, 10)));
+  auto root = std::make_unique<flow::TransformLayer>();
+  root->set_transform(SkMatrix::I());
+  root->Add(std::move(child));
+  root->Add(
+      std::make_unique<flow::TestLayer>(SkRect::MakeXYWH(20, 20, 10, 10)));
+  auto layer_tree =
+      flow::MakeTestLayerTree(std::move(root), SkISize::Make(100, 100));
+
+  flow::CompositorContext compositor_context;
+
+  // Frames are not timed by default.
+  {
+    SkPictureRecorder recorder;
+    recorder.beginRecording(SkRect::MakeWH(100, 100));
+    auto frame = compositor_context.AcquireFrame(
+        nullptr, recorder.getRecordingCanvas(), false);
+    ASSERT_EQ(frame->layer_timings(), nullptr);
+    ASSERT_TRUE(frame->Raster(*layer_tree, true));
+  }
+
+  flow::LayerTimings timings;
+  ASSERT_TRUE(
+      flow::RasterTestFrame(compositor_context, *layer_tree, true, &timings));
+
+  const auto& entries = timings.entries();
+  ASSERT_EQ(entries.size(), 4u);
+  ASSERT_EQ(std::string(entries[0].type_name), "TransformLayer");
+  ASSERT_EQ(entries[0].depth, 0u);
+  ASSERT_EQ(entries[0].paint_bounds, SkRect::MakeWH(30, 30));
+  ASSERT_EQ(std::string(entries[1].type_name), "TransformLayer");
+  ASSERT_EQ(entries[1].depth, 1u);
+  ASSERT_EQ(std::string(entries[2].type_name), "TestLayer");
+  ASSERT_EQ(entries[2].depth, 2u);
+  ASSERT_EQ(std::string(entries[3].type_name), "TestLayer");
+  ASSERT_EQ(entries[3].depth, 1u);
+  ASSERT_EQ(entries[3].paint_bounds, SkRect::MakeXYWH(20, 20, 10, 10));
+
+  // Layers include the time of their children.
+  ASSERT_GE(entries[0].preroll_time, entries[1].preroll_time);
+  ASSERT_GE(entries[1].preroll_time, entries[2].preroll_time);
+  ASSERT_GE(entries[0].paint_time, entries[1].paint_time);
+  ASSERT_GE(entries[1].paint_time, entries[2].paint_time);
+}
+
+TEST(LayerTimings, TimesTheRasterCacheOfPictureLayers) {
+  flow::TestPictureLayerFactory picture_layers;
+  auto picture = flow::GetSamplePicture();
+  auto layer_tree = flow::MakeTestLayerTree(picture_layers.Make(picture),
+                                            SkISize::Make(150, 100));
+
+  flow::CompositorContext compositor_context;
+  flow::LayerTimings timings;
+  ASSERT_TRUE(
+      flow::RasterTestFrame(compositor_context, *layer_tree, false, &timings));
+
+  const auto& entries = timings.entries();
+  ASSERT_EQ(entries.size(), 1u);
+  ASSERT_EQ(std::string(entries[0].type_name), "PictureLayer");
+  ASSERT_EQ(entries[0].picture_id, picture->uniqueID());
+  ASSERT_GT(entries[0].raster_cache_time, fxl::TimeDelta::Zero());
+  // The raster cache is not part of the layer's own preroll time.
+  ASSERT_LE(entries[0].self_preroll_time + entries[0].raster_cache_time,
+            entries[0].preroll_time);
+}
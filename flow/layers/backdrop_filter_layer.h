@@ -18,6 +18,8 @@ class BackdropFilterLayer : public ContainerLayer {
 
   void Paint(PaintContext& context) const override;
 
+  const char* GetTypeName() const override { return "BackdropFilterLayer"; }
+
  private:
   sk_sp<SkImageFilter> filter_;
 
@@ -31,6 +31,8 @@ class ChildSceneLayer : public Layer {
 
   void Paint(PaintContext& context) const override;
 
+  const char* GetTypeName() const override { return "ChildSceneLayer"; }
+
   void UpdateScene(SceneUpdateContext& context) override;
 
  private:
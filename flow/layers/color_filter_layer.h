@@ -20,6 +20,8 @@ class ColorFilterLayer : public ContainerLayer {
 
   void Paint(PaintContext& context) const override;
 
+  const char* GetTypeName() const override { return "ColorFilterLayer"; }
+
  private:
   SkColor color_;
   SkBlendMode blend_mode_;
@@ -28,7 +28,10 @@ void ContainerLayer::PrerollChildren(PrerollContext* context,
                                      SkRect* child_paint_bounds) {
   for (auto& layer : layers_) {
     PrerollContext child_context = *context;
-    layer->Preroll(&child_context, child_matrix);
+    {
+      LayerTimings::ScopedPreroll timing(context->layer_timings, *layer);
+      layer->Preroll(&child_context, child_matrix);
+    }
 
     if (layer->needs_system_composite()) {
       set_needs_system_composite(true);
@@ -44,6 +47,7 @@ void ContainerLayer::PaintChildren(PaintContext& context) const {
   // and the trace event on this common function has a small overhead.
   for (auto& layer : layers_) {
     if (layer->needs_painting()) {
+      LayerTimings::ScopedPaint timing(context.layer_timings, *layer);
       layer->Paint(context);
     }
   }
@@ -9,6 +9,7 @@
 #include <vector>
 
 #include "flutter/flow/instrumentation.h"
+#include "flutter/flow/layer_timings.h"
 #include "flutter/flow/raster_cache.h"
 #include "flutter/flow/texture.h"
 #include "flutter/glue/trace_event.h"
@@ -48,6 +49,8 @@ class Layer {
     GrContext* gr_context;
     SkColorSpace* dst_color_space;
     SkRect child_paint_bounds;
+    // Times the preroll of each layer if not null.
+    LayerTimings* layer_timings;
   };
 
   virtual void Preroll(PrerollContext* context, const SkMatrix& matrix);
@@ -58,6 +61,8 @@ class Layer {
     const Stopwatch& engine_time;
     TextureRegistry& texture_registry;
     const bool checkerboard_offscreen_layers;
+    // Times the paint of each layer if not null.
+    LayerTimings* layer_timings;
   };
 
   // Calls SkCanvas::saveLayer and restores the layer upon destruction. Also
@@ -80,6 +85,9 @@ class Layer {
 
   virtual void Paint(PaintContext& context) const = 0;
 
+  // The name of the type of the layer, used when reporting layer timings.
+  virtual const char* GetTypeName() const { return "Layer"; }
+
 #if defined(OS_FUCHSIA)
   // Updates the system composited scene.
   virtual void UpdateScene(SceneUpdateContext& context);
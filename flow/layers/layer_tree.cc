@@ -30,8 +30,10 @@ void LayerTree::Preroll(CompositorContext::ScopedFrame& frame,
       frame.gr_context(),
       color_space,
       SkRect::MakeEmpty(),
+      frame.layer_timings(),
   };
 
+  LayerTimings::ScopedPreroll timing(context.layer_timings, *root_layer_);
   root_layer_->Preroll(&context, SkMatrix::I());
 }
 
@@ -67,11 +69,14 @@ void LayerTree::Paint(CompositorContext::ScopedFrame& frame) const {
       frame.context().frame_time(),        //
       frame.context().engine_time(),       //
       frame.context().texture_registry(),  //
-      checkerboard_offscreen_layers_       //
+      checkerboard_offscreen_layers_,      //
+      frame.layer_timings(),               //
   };
 
-  if (root_layer_->needs_painting())
+  if (root_layer_->needs_painting()) {
+    LayerTimings::ScopedPaint timing(context.layer_timings, *root_layer_);
     root_layer_->Paint(context);
+  }
 }
 
 sk_sp<SkPicture> LayerTree::Flatten(const SkRect& bounds) {
@@ -89,6 +94,7 @@ sk_sp<SkPicture> LayerTree::Flatten(const SkRect& bounds) {
       nullptr,              // gr_context  (used for the raster cache)
       nullptr,              // SkColorSpace* dst_color_space
       SkRect::MakeEmpty(),  // SkRect child_paint_bounds
+      nullptr,              // layer timings (not timed)
   };
 
   const Stopwatch unused_stopwatch;
@@ -99,7 +105,8 @@ sk_sp<SkPicture> LayerTree::Flatten(const SkRect& bounds) {
       unused_stopwatch,         // frame time (dont care)
       unused_stopwatch,         // engine time (dont care)
       unused_texture_registry,  // texture registry (not supported)
-      false                     // checkerboard offscreen layers
+      false,                    // checkerboard offscreen layers
+      nullptr,                  // layer timings (not timed)
   };
 
   // Even if we don't have a root layer, we still need to create an empty
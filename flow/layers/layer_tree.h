@@ -13,6 +13,7 @@
 #include "flutter/flow/layers/layer.h"
 #include "lib/fxl/macros.h"
 #include "lib/fxl/time/time_delta.h"
+#include "lib/fxl/time/time_point.h"
 #include "third_party/skia/include/core/SkPicture.h"
 #include "third_party/skia/include/core/SkSize.h"
 
@@ -52,9 +53,25 @@ class LayerTree {
 
   const fxl::TimeDelta& construction_time() const { return construction_time_; }
 
-  // The number of frame intervals missed after which the compositor must
-  // trace the rasterized picture to a trace file. Specify 0 to disable all
-  // tracing
+  // The time at which the frame is to be presented, if it was built for a
+  // vsync pulse. Frames rasterized later than this are missed.
+  void set_target_time(fxl::TimePoint target_time) {
+    target_time_ = target_time;
+  }
+
+  fxl::TimePoint target_time() const { return target_time_; }
+
+  // The time between the vsync pulse the frame was built for and its target
+  // time. Zero if the frame was not built for a vsync pulse.
+  void set_frame_interval(fxl::TimeDelta frame_interval) {
+    frame_interval_ = frame_interval;
+  }
+
+  fxl::TimeDelta frame_interval() const { return frame_interval_; }
+
+  // The number of frame intervals after which the rasterizer captures the
+  // frame, with the time each of its layers took, for offline analysis.
+  // Specify 0 to disable all tracing.
   void set_rasterizer_tracing_threshold(uint32_t interval) {
     rasterizer_tracing_threshold_ = interval;
   }
@@ -75,6 +92,8 @@ class LayerTree {
   SkISize frame_size_;  // Physical pixels.
   std::unique_ptr<Layer> root_layer_;
   fxl::TimeDelta construction_time_;
+  fxl::TimePoint target_time_;
+  fxl::TimeDelta frame_interval_;
   uint32_t rasterizer_tracing_threshold_;
   bool checkerboard_raster_cache_images_;
   bool checkerboard_offscreen_layers_;
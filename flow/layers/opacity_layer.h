@@ -18,6 +18,8 @@ class OpacityLayer : public ContainerLayer {
 
   void Paint(PaintContext& context) const override;
 
+  const char* GetTypeName() const override { return "OpacityLayer"; }
+
   // TODO(chinmaygarde): Once MZ-139 is addressed, introduce a new node in the
   // session scene hierarchy.
 
@@ -15,6 +15,8 @@ PictureLayer::~PictureLayer() = default;
 void PictureLayer::Preroll(PrerollContext* context, const SkMatrix& matrix) {
   SkPicture* sk_picture = picture();
 
+  LayerTimings::ScopedRasterCache timing(context->layer_timings, *this,
+                                         sk_picture->uniqueID());
   if (auto cache = context->raster_cache) {
     SkMatrix ctm = matrix;
     ctm.postTranslate(offset_.x(), offset_.y());
@@ -32,6 +32,8 @@ class PictureLayer : public Layer {
 
   void Paint(PaintContext& context) const override;
 
+  const char* GetTypeName() const override { return "PictureLayer"; }
+
  private:
   SkPoint offset_;
   // Even though pictures themselves are not GPU resources, they may reference
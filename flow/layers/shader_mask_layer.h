@@ -24,6 +24,8 @@ class ShaderMaskLayer : public ContainerLayer {
 
   void Paint(PaintContext& context) const override;
 
+  const char* GetTypeName() const override { return "ShaderMaskLayer"; }
+
  private:
   sk_sp<SkShader> shader_;
   SkRect mask_rect_;
@@ -26,6 +26,8 @@ class TextureLayer : public Layer {
   void Preroll(PrerollContext* context, const SkMatrix& matrix) override;
   void Paint(PaintContext& context) const override;
 
+  const char* GetTypeName() const override { return "TextureLayer"; }
+
  private:
   SkPoint offset_;
   SkSize size_;
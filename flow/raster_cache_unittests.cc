@@ -3,19 +3,13 @@
 // found in the LICENSE file.
 
 #include "flutter/flow/raster_cache.h"
+
+#include <memory>
+
+#include "flutter/flow/compositor_context.h"
+#include "flutter/flow/flow_test_utils.h"
 #include "gtest/gtest.h"
 #include "third_party/skia/include/core/SkPicture.h"
-#include "third_party/skia/include/core/SkPictureRecorder.h"
-
-sk_sp<SkPicture> GetSamplePicture() {
-  SkPictureRecorder recorder;
-  recorder.beginRecording(SkRect::MakeWH(150, 100));
-  SkPaint paint;
-  paint.setColor(SK_ColorRED);
-  recorder.getRecordingCanvas()->drawRect(SkRect::MakeXYWH(10, 10, 80, 80),
-                                          paint);
-  return recorder.finishRecordingAsPicture();
-}
 
 TEST(RasterCache, SimpleInitialization) {
   flow::RasterCache cache;
@@ -28,7 +22,7 @@ TEST(RasterCache, ThresholdIsRespected) {
 
   SkMatrix matrix = SkMatrix::I();
 
-  auto picture = GetSamplePicture();
+  auto picture = flow::GetSamplePicture();
 
   sk_sp<SkImage> image;
 
@@ -50,7 +44,7 @@ TEST(RasterCache, ThresholdIsRespectedWhenZero) {
 
   SkMatrix matrix = SkMatrix::I();
 
-  auto picture = GetSamplePicture();
+  auto picture = flow::GetSamplePicture();
 
   sk_sp<SkImage> image;
 
@@ -72,7 +66,7 @@ TEST(RasterCache, SweepsRemoveUnusedFrames) {
 
   SkMatrix matrix = SkMatrix::I();
 
-  auto picture = GetSamplePicture();
+  auto picture = flow::GetSamplePicture();
 
   sk_sp<SkImage> image;
 
@@ -93,3 +87,21 @@ TEST(RasterCache, SweepsRemoveUnusedFrames) {
   ASSERT_FALSE(cache.GetPrerolledImage(NULL, picture.get(), matrix, srgb.get(),
                                        true, false));  // 5
 }
+
+TEST(RasterCache, SurvivesFlatteningTheLayerTree) {
+  flow::TestPictureLayerFactory picture_layers;
+  auto picture = flow::GetSamplePicture();
+  auto layer_tree = flow::MakeTestLayerTree(picture_layers.Make(picture),
+                                            SkISize::Make(150, 100));
+
+  flow::CompositorContext compositor_context;
+  for (int i = 0; i < 3; i++) {
+    ASSERT_TRUE(flow::RasterTestFrame(compositor_context, *layer_tree, false));
+  }
+
+  // Slow frames are captured by flattening their layer tree after the frame
+  // ends. Doing so must not evict the entries of the frame.
+  ASSERT_TRUE(layer_tree->Flatten(SkRect::MakeWH(150, 100)));
+  ASSERT_TRUE(compositor_context.raster_cache().GetPrerolledImage(
+      nullptr, picture.get(), SkMatrix::I(), nullptr, true, false));
+}
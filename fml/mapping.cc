@@ -6,6 +6,10 @@
 
 namespace fml {
 
+uint8_t* Mapping::GetMutableMapping() {
+  return nullptr;
+}
+
 DataMapping::DataMapping(std::vector<uint8_t> data) : data_(std::move(data)) {}
 
 DataMapping::~DataMapping() = default;
@@ -17,4 +21,8 @@ size_t DataMapping::GetSize() const {
 const uint8_t* DataMapping::GetMapping() const {
   return data_.data();
 }
+
+uint8_t* DataMapping::GetMutableMapping() {
+  return data_.data();
+}
 }  // namespace fml
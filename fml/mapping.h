@@ -25,6 +25,9 @@ class Mapping {
 
   virtual const uint8_t* GetMapping() const = 0;
 
+  // The mapping if it may be written to, null if it may be read-only memory.
+  virtual uint8_t* GetMutableMapping();
+
  private:
   FML_DISALLOW_COPY_AND_ASSIGN(Mapping);
 };
@@ -66,6 +69,8 @@ class DataMapping : public Mapping {
 
   const uint8_t* GetMapping() const override;
 
+  uint8_t* GetMutableMapping() override;
+
  private:
   std::vector<uint8_t> data_;
 
@@ -113,6 +113,13 @@ void MessageLoopImpl::RegisterTask(fxl::Closure task,
 }
 
 void MessageLoopImpl::RunExpiredTasks() {
+  fml::tracing::BeginTimelineBatch();
+  InvokeExpiredTasks();
+  // Send the events of the tasks now that their trace events are closed.
+  fml::tracing::EndTimelineBatch();
+}
+
+void MessageLoopImpl::InvokeExpiredTasks() {
   TRACE_EVENT0("fml", "MessageLoop::RunExpiredTasks");
   std::vector<fxl::Closure> invocations;
 
@@ -81,6 +81,8 @@ class MessageLoopImpl : public fxl::RefCountedThreadSafe<MessageLoopImpl> {
 
   void RunExpiredTasks();
 
+  void InvokeExpiredTasks();
+
   FML_DISALLOW_COPY_AND_ASSIGN(MessageLoopImpl);
 };
 
@@ -18,6 +18,7 @@
 #include <string>
 
 #include "flutter/fml/message_loop.h"
+#include "flutter/fml/trace_event.h"
 #include "lib/fxl/synchronization/waitable_event.h"
 
 namespace fml {
@@ -70,6 +71,7 @@ void Thread::SetCurrentThreadName(const std::string& name) {
   if (name == "") {
     return;
   }
+  tracing::SetCurrentThreadName(name);
 #if OS_MACOSX
   pthread_setname_np(name.c_str());
 #elif OS_LINUX || OS_ANDROID
@@ -4,19 +4,449 @@
 
 #include "flutter/fml/trace_event.h"
 
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <vector>
+
+#include "flutter/fml/thread_local.h"
 #include "third_party/dart/runtime/include/dart_tools_api.h"
 
 namespace fml {
 namespace tracing {
 
+namespace {
+
+std::atomic<bool> gRecording = {false};
+std::atomic<bool> gTimelineEnabled = {false};
+
+class CategoryRegistry {
+ public:
+  static CategoryRegistry& Get() {
+    // Leaked so that the flags outlive the call sites that cache them.
+    static CategoryRegistry* registry = new CategoryRegistry();
+    return *registry;
+  }
+
+  const std::atomic<bool>& GetEnabledFlag(TraceArg category_group) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& category : categories_) {
+      if (category.name == category_group) {
+        return category.enabled;
+      }
+    }
+    categories_.emplace_back(category_group);
+    auto& category = categories_.back();
+    category.enabled.store(IsEnabledLocked(category.name),
+                           std::memory_order_relaxed);
+    return category.enabled;
+  }
+
+  void SetEnabledCategories(const std::vector<std::string>& categories) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    enabled_categories_ =
+        std::set<std::string>(categories.begin(), categories.end());
+    UpdateEnabledFlagsLocked();
+  }
+
+  // Called when events start or stop being recorded anywhere.
+  void UpdateEnabledFlags() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    UpdateEnabledFlagsLocked();
+  }
+
+ private:
+  struct Category {
+    explicit Category(std::string name) : name(std::move(name)) {}
+
+    const std::string name;
+    std::atomic<bool> enabled;
+  };
+
+  std::mutex mutex_;
+  // A deque so that the flags handed out never move.
+  std::deque<Category> categories_;
+  std::set<std::string> enabled_categories_;
+
+  bool IsEnabledLocked(const std::string& category) const {
+    if (!gRecording.load(std::memory_order_relaxed) &&
+        !gTimelineEnabled.load(std::memory_order_relaxed)) {
+      return false;
+    }
+    return enabled_categories_.empty() ||
+           enabled_categories_.count(category) != 0;
+  }
+
+  void UpdateEnabledFlagsLocked() {
+    for (auto& category : categories_) {
+      category.enabled.store(IsEnabledLocked(category.name),
+                             std::memory_order_relaxed);
+    }
+  }
+};
+
+Dart_Timeline_Event_Type DartTypeForEventType(TraceEventType type) {
+  switch (type) {
+    case TraceEventType::kBegin:
+      return Dart_Timeline_Event_Begin;
+    case TraceEventType::kEnd:
+      return Dart_Timeline_Event_End;
+    case TraceEventType::kInstant:
+      return Dart_Timeline_Event_Instant;
+    case TraceEventType::kAsyncBegin:
+      return Dart_Timeline_Event_Async_Begin;
+    case TraceEventType::kAsyncEnd:
+      return Dart_Timeline_Event_Async_End;
+    case TraceEventType::kFlowBegin:
+      return Dart_Timeline_Event_Flow_Begin;
+    case TraceEventType::kFlowStep:
+      return Dart_Timeline_Event_Flow_Step;
+    case TraceEventType::kFlowEnd:
+      return Dart_Timeline_Event_Flow_End;
+  }
+  return Dart_Timeline_Event_Instant;
+}
+
+// The timeline attributes the event to the calling thread, so this must be
+// called on the thread that emitted the event.
+void SendToTimeline(const TraceEventRecord& event) {
+  const char* argument_names[TraceEventRecord::kMaxArguments];
+  const char* argument_values[TraceEventRecord::kMaxArguments];
+  for (size_t i = 0; i < event.argument_count; i++) {
+    argument_names[i] = event.argument_names[i];
+    argument_values[i] = event.argument_values[i];
+  }
+  Dart_TimelineEvent(event.name,                        // label
+                     event.timestamp_micros,            // timestamp0
+                     event.id,                          // async id
+                     DartTypeForEventType(event.type),  // event type
+                     static_cast<intptr_t>(event.argument_count),
+                     argument_names,  // argument_names
+                     argument_values  // argument_values
+  );
+}
+
+// A single producer, single consumer ring of events. The thread that owns the
+// buffer pushes without locking, the flush drains it under the lock of the
+// recorder.
+class TraceBuffer {
+ public:
+  // About 140KB per thread once the thread records.
+  static constexpr size_t kCapacity = 1024;
+  // Events for the Dart timeline are sent at least this often, so that long
+  // tasks do not hold on to theirs.
+  static constexpr size_t kTimelineBatchCapacity = 64;
+
+  explicit TraceBuffer(int64_t thread_id) : thread_id_(thread_id) {}
+
+  int64_t GetThreadID() const { return thread_id_; }
+
+  void Push(const TraceEventRecord& event) {
+    const size_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail - head_.load(std::memory_order_acquire) == kCapacity) {
+      dropped_.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+    // Threads that are only named never allocate the ring.
+    if (events_.empty()) {
+      events_.resize(kCapacity);
+    }
+    events_[tail % kCapacity] = event;
+    tail_.store(tail + 1, std::memory_order_release);
+  }
+
+  bool IsEmpty() const {
+    return head_.load(std::memory_order_relaxed) ==
+           tail_.load(std::memory_order_acquire);
+  }
+
+  // Only called on the thread that owns the buffer.
+  void AddToTimelineBatch(const TraceEventRecord& event) {
+    std::lock_guard<std::mutex> lock(timeline_batch_mutex_);
+    if (timeline_batch_.empty()) {
+      timeline_batch_.reserve(kTimelineBatchCapacity);
+    }
+    timeline_batch_.push_back(event);
+    if (timeline_batch_.size() == kTimelineBatchCapacity) {
+      SendTimelineBatchLocked();
+    }
+  }
+
+  // Called on the thread that owns the buffer, except when the timeline stops.
+  void SendTimelineBatch() {
+    std::lock_guard<std::mutex> lock(timeline_batch_mutex_);
+    SendTimelineBatchLocked();
+  }
+
+  size_t Drain(const std::function<void(const TraceEventRecord&)>& callback) {
+    const size_t head = head_.load(std::memory_order_relaxed);
+    const size_t tail = tail_.load(std::memory_order_acquire);
+    for (size_t i = head; i < tail; i++) {
+      callback(events_[i % kCapacity]);
+    }
+    head_.store(tail, std::memory_order_release);
+    return dropped_.exchange(0, std::memory_order_relaxed);
+  }
+
+ private:
+  const int64_t thread_id_;
+  std::vector<TraceEventRecord> events_;
+  std::atomic<size_t> head_ = {0};
+  std::atomic<size_t> tail_ = {0};
+  std::atomic<size_t> dropped_ = {0};
+  // Only contended when the timeline stops while the thread emits events.
+  std::mutex timeline_batch_mutex_;
+  std::vector<TraceEventRecord> timeline_batch_;
+
+  void SendTimelineBatchLocked() {
+    for (const auto& event : timeline_batch_) {
+      SendToTimeline(event);
+    }
+    timeline_batch_.clear();
+  }
+
+  FML_DISALLOW_COPY_AND_ASSIGN(TraceBuffer);
+};
+
+class Recorder {
+ public:
+  static Recorder& Get() {
+    static Recorder* recorder = new Recorder();
+    return *recorder;
+  }
+
+  // Null if the current thread has no buffer yet.
+  TraceBuffer* FindCurrentThreadBuffer() {
+    auto holder =
+        reinterpret_cast<std::shared_ptr<TraceBuffer>*>(tls_buffer_.Get());
+    return holder != nullptr ? holder->get() : nullptr;
+  }
+
+  TraceBuffer* GetCurrentThreadBuffer() {
+    if (auto buffer = FindCurrentThreadBuffer()) {
+      return buffer;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto buffer = std::make_shared<TraceBuffer>(next_thread_id_++);
+    buffers_.push_back(buffer);
+    tls_buffer_.Set(reinterpret_cast<intptr_t>(
+        new std::shared_ptr<TraceBuffer>(std::move(buffer))));
+    return buffers_.back().get();
+  }
+
+  void SetCurrentThreadName(const std::string& name) {
+    auto buffer = GetCurrentThreadBuffer();
+    std::lock_guard<std::mutex> lock(mutex_);
+    thread_names_[buffer->GetThreadID()] = name;
+  }
+
+  std::map<int64_t, std::string> GetThreadNames() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return thread_names_;
+  }
+
+  // Events are only batched on threads that are running a task of a message
+  // loop.
+  bool IsBatchingTimelineEvents() { return tls_batch_depth_.Get() > 0; }
+
+  void BeginTimelineBatch() {
+    tls_batch_depth_.Set(tls_batch_depth_.Get() + 1);
+  }
+
+  void EndTimelineBatch() {
+    const intptr_t depth = tls_batch_depth_.Get() - 1;
+    tls_batch_depth_.Set(depth);
+    if (depth == 0) {
+      if (auto buffer = FindCurrentThreadBuffer()) {
+        buffer->SendTimelineBatch();
+      }
+    }
+  }
+
+  // Sends the batches of all threads. The timeline attributes the events to
+  // the calling thread, but they would be lost otherwise.
+  void SendAllTimelineBatches() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& buffer : buffers_) {
+      buffer->SendTimelineBatch();
+    }
+  }
+
+  size_t Flush(const std::function<void(const TraceEventRecord&)>& callback) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t dropped = 0;
+    for (const auto& buffer : buffers_) {
+      dropped += buffer->Drain(callback);
+    }
+    // Forget the buffers of the threads that have exited once they are empty.
+    buffers_.erase(std::remove_if(buffers_.begin(), buffers_.end(),
+                                  [](const std::shared_ptr<TraceBuffer>& b) {
+                                    return b.use_count() == 1 && b->IsEmpty();
+                                  }),
+                   buffers_.end());
+    return dropped;
+  }
+
+ private:
+  // Owns a reference to the buffer of the thread until it exits.
+  ThreadLocal tls_buffer_;
+  // The number of nested timeline batches of the thread.
+  ThreadLocal tls_batch_depth_;
+  std::mutex mutex_;
+  std::vector<std::shared_ptr<TraceBuffer>> buffers_;
+  std::map<int64_t, std::string> thread_names_;
+  int64_t next_thread_id_ = 1;
+
+  Recorder()
+      : tls_buffer_([](intptr_t value) {
+          auto holder = reinterpret_cast<std::shared_ptr<TraceBuffer>*>(value);
+          // The thread is exiting, so this is its last chance to send them.
+          (*holder)->SendTimelineBatch();
+          delete holder;
+        }) {}
+
+  FML_DISALLOW_COPY_AND_ASSIGN(Recorder);
+};
+
+// Copies at most |size| - 1 bytes of the source. A truncated copy ends before
+// the code point that did not fit, so that valid UTF-8 stays valid.
+void CopyString(char* destination, size_t size, TraceArg source) {
+  if (source == nullptr) {
+    destination[0] = '\0';
+    return;
+  }
+  size_t length = strnlen(source, size);
+  if (length == size) {
+    length = size - 1;
+    // Back up over the continuation bytes of the code point that was cut.
+    while (length > 0 &&
+           (static_cast<unsigned char>(source[length]) & 0xC0) == 0x80) {
+      length--;
+    }
+  }
+  memcpy(destination, source, length);
+  destination[length] = '\0';
+}
+
+// Copies the event into the ring buffer of the thread while recording and
+// sends it to the Dart timeline while that is enabled, batched if the thread
+// is running a task. Events are only emitted while one of the two is, as
+// categories are disabled otherwise.
+void EmitEvent(TraceEventType type,
+               TraceArg category_group,
+               TraceArg name,
+               TraceIDArg id,
+               size_t argument_count,
+               const char* const* argument_names,
+               const char* const* argument_values) {
+  const bool recording = gRecording.load(std::memory_order_relaxed);
+  const bool timeline_enabled =
+      gTimelineEnabled.load(std::memory_order_relaxed);
+  if (!recording && !timeline_enabled) {
+    return;
+  }
+  auto buffer = Recorder::Get().GetCurrentThreadBuffer();
+  TraceEventRecord event;
+  event.type = type;
+  event.timestamp_micros = Dart_TimelineGetMicros();
+  event.id = id;
+  event.thread_id = buffer->GetThreadID();
+  event.category = category_group != nullptr ? category_group : "";
+  event.name = name != nullptr ? name : "";
+  event.argument_count = argument_count < TraceEventRecord::kMaxArguments
+                             ? argument_count
+                             : TraceEventRecord::kMaxArguments;
+  for (size_t i = 0; i < event.argument_count; i++) {
+    event.argument_names[i] = argument_names[i];
+    CopyString(event.argument_values[i], sizeof(event.argument_values[i]),
+               argument_values[i]);
+  }
+  if (recording) {
+    buffer->Push(event);
+  }
+  if (timeline_enabled) {
+    if (Recorder::Get().IsBatchingTimelineEvents()) {
+      buffer->AddToTimelineBatch(event);
+    } else {
+      SendToTimeline(event);
+    }
+  }
+}
+
+}  // namespace
+
+const std::atomic<bool>& GetCategoryEnabledFlag(TraceArg category_group) {
+  return CategoryRegistry::Get().GetEnabledFlag(category_group);
+}
+
+bool IsCategoryEnabled(TraceArg category_group) {
+  return GetCategoryEnabledFlag(category_group)
+      .load(std::memory_order_relaxed);
+}
+
+void SetEnabledCategories(const std::vector<std::string>& categories) {
+  CategoryRegistry::Get().SetEnabledCategories(categories);
+}
+
+void SetTimelineEnabled(bool enabled) {
+  if (!enabled) {
+    // The timeline drops the events sent once it has stopped.
+    Recorder::Get().SendAllTimelineBatches();
+  }
+  gTimelineEnabled.store(enabled, std::memory_order_relaxed);
+  CategoryRegistry::Get().UpdateEnabledFlags();
+}
+
+bool IsTimelineEnabled() {
+  return gTimelineEnabled.load(std::memory_order_relaxed);
+}
+
+void BeginTimelineBatch() {
+  Recorder::Get().BeginTimelineBatch();
+}
+
+void EndTimelineBatch() {
+  Recorder::Get().EndTimelineBatch();
+}
+
+void StartRecording() {
+  gRecording.store(true, std::memory_order_relaxed);
+  CategoryRegistry::Get().UpdateEnabledFlags();
+}
+
+void StopRecording() {
+  gRecording.store(false, std::memory_order_relaxed);
+  CategoryRegistry::Get().UpdateEnabledFlags();
+}
+
+bool IsRecording() {
+  return gRecording.load(std::memory_order_relaxed);
+}
+
+void SetCurrentThreadName(const std::string& name) {
+  Recorder::Get().SetCurrentThreadName(name);
+}
+
+std::map<int64_t, std::string> GetThreadNames() {
+  return Recorder::Get().GetThreadNames();
+}
+
+size_t FlushRecordedEvents(
+    const std::function<void(const TraceEventRecord&)>& callback) {
+  return Recorder::Get().Flush(callback);
+}
+
 void TraceEvent0(TraceArg category_group, TraceArg name) {
-  Dart_TimelineEvent(name,                       // label
-                     Dart_TimelineGetMicros(),   // timestamp0
-                     0,                          // timestamp1_or_async_id
-                     Dart_Timeline_Event_Begin,  // event type
-                     0,                          // argument_count
-                     nullptr,                    // argument_names
-                     nullptr                     // argument_values
+  EmitEvent(TraceEventType::kBegin,     // type
+            category_group,             // category_group
+            name,                       // name
+            0,                          // id
+            0,                          // argument_count
+            nullptr,                    // argument_names
+            nullptr                     // argument_values
   );
 }
 
@@ -26,13 +456,13 @@ void TraceEvent1(TraceArg category_group,
                  TraceArg arg1_val) {
   const char* arg_names[] = {arg1_name};
   const char* arg_values[] = {arg1_val};
-  Dart_TimelineEvent(name,                       // label
-                     Dart_TimelineGetMicros(),   // timestamp0
-                     0,                          // timestamp1_or_async_id
-                     Dart_Timeline_Event_Begin,  // event type
-                     1,                          // argument_count
-                     arg_names,                  // argument_names
-                     arg_values                  // argument_values
+  EmitEvent(TraceEventType::kBegin,     // type
+            category_group,             // category_group
+            name,                       // name
+            0,                          // id
+            1,                          // argument_count
+            arg_names,                  // argument_names
+            arg_values                  // argument_values
   );
 }
 
@@ -44,50 +474,50 @@ void TraceEvent2(TraceArg category_group,
                  TraceArg arg2_val) {
   const char* arg_names[] = {arg1_name, arg2_name};
   const char* arg_values[] = {arg1_val, arg2_val};
-  Dart_TimelineEvent(name,                       // label
-                     Dart_TimelineGetMicros(),   // timestamp0
-                     0,                          // timestamp1_or_async_id
-                     Dart_Timeline_Event_Begin,  // event type
-                     2,                          // argument_count
-                     arg_names,                  // argument_names
-                     arg_values                  // argument_values
+  EmitEvent(TraceEventType::kBegin,     // type
+            category_group,             // category_group
+            name,                       // name
+            0,                          // id
+            2,                          // argument_count
+            arg_names,                  // argument_names
+            arg_values                  // argument_values
   );
 }
 
 void TraceEventEnd(TraceArg name) {
-  Dart_TimelineEvent(name,                      // label
-                     Dart_TimelineGetMicros(),  // timestamp0
-                     0,                         // timestamp1_or_async_id
-                     Dart_Timeline_Event_End,   // event type
-                     0,                         // argument_count
-                     nullptr,                   // argument_names
-                     nullptr                    // argument_values
+  EmitEvent(TraceEventType::kEnd,     // type
+            nullptr,                  // category_group
+            name,                     // name
+            0,                        // id
+            0,                        // argument_count
+            nullptr,                  // argument_names
+            nullptr                   // argument_values
   );
 }
 
 void TraceEventAsyncBegin0(TraceArg category_group,
                            TraceArg name,
                            TraceIDArg id) {
-  Dart_TimelineEvent(name,                             // label
-                     Dart_TimelineGetMicros(),         // timestamp0
-                     id,                               // timestamp1_or_async_id
-                     Dart_Timeline_Event_Async_Begin,  // event type
-                     0,                                // argument_count
-                     nullptr,                          // argument_names
-                     nullptr                           // argument_values
+  EmitEvent(TraceEventType::kAsyncBegin,      // type
+            category_group,                   // category_group
+            name,                             // name
+            id,                               // id
+            0,                                // argument_count
+            nullptr,                          // argument_names
+            nullptr                           // argument_values
   );
 }
 
 void TraceEventAsyncEnd0(TraceArg category_group,
                          TraceArg name,
                          TraceIDArg id) {
-  Dart_TimelineEvent(name,                           // label
-                     Dart_TimelineGetMicros(),       // timestamp0
-                     id,                             // timestamp1_or_async_id
-                     Dart_Timeline_Event_Async_End,  // event type
-                     0,                              // argument_count
-                     nullptr,                        // argument_names
-                     nullptr                         // argument_values
+  EmitEvent(TraceEventType::kAsyncEnd,      // type
+            category_group,                 // category_group
+            name,                           // name
+            id,                             // id
+            0,                              // argument_count
+            nullptr,                        // argument_names
+            nullptr                         // argument_values
   );
 }
 
@@ -98,13 +528,13 @@ void TraceEventAsyncBegin1(TraceArg category_group,
                            TraceArg arg1_val) {
   const char* arg_names[] = {arg1_name};
   const char* arg_values[] = {arg1_val};
-  Dart_TimelineEvent(name,                             // label
-                     Dart_TimelineGetMicros(),         // timestamp0
-                     id,                               // timestamp1_or_async_id
-                     Dart_Timeline_Event_Async_Begin,  // event type
-                     1,                                // argument_count
-                     arg_names,                        // argument_names
-                     arg_values                        // argument_values
+  EmitEvent(TraceEventType::kAsyncBegin,      // type
+            category_group,                   // category_group
+            name,                             // name
+            id,                               // id
+            1,                                // argument_count
+            arg_names,                        // argument_names
+            arg_values                        // argument_values
   );
 }
 
@@ -115,61 +545,61 @@ void TraceEventAsyncEnd1(TraceArg category_group,
                          TraceArg arg1_val) {
   const char* arg_names[] = {arg1_name};
   const char* arg_values[] = {arg1_val};
-  Dart_TimelineEvent(name,                           // label
-                     Dart_TimelineGetMicros(),       // timestamp0
-                     id,                             // timestamp1_or_async_id
-                     Dart_Timeline_Event_Async_End,  // event type
-                     1,                              // argument_count
-                     arg_names,                      // argument_names
-                     arg_values                      // argument_values
+  EmitEvent(TraceEventType::kAsyncEnd,      // type
+            category_group,                 // category_group
+            name,                           // name
+            id,                             // id
+            1,                              // argument_count
+            arg_names,                      // argument_names
+            arg_values                      // argument_values
   );
 }
 
 void TraceEventInstant0(TraceArg category_group, TraceArg name) {
-  Dart_TimelineEvent(name,                         // label
-                     Dart_TimelineGetMicros(),     // timestamp0
-                     0,                            // timestamp1_or_async_id
-                     Dart_Timeline_Event_Instant,  // event type
-                     0,                            // argument_count
-                     nullptr,                      // argument_names
-                     nullptr                       // argument_values
+  EmitEvent(TraceEventType::kInstant,     // type
+            category_group,               // category_group
+            name,                         // name
+            0,                            // id
+            0,                            // argument_count
+            nullptr,                      // argument_names
+            nullptr                       // argument_values
   );
 }
 
 void TraceEventFlowBegin0(TraceArg category_group,
                           TraceArg name,
                           TraceIDArg id) {
-  Dart_TimelineEvent(name,                            // label
-                     Dart_TimelineGetMicros(),        // timestamp0
-                     id,                              // timestamp1_or_async_id
-                     Dart_Timeline_Event_Flow_Begin,  // event type
-                     0,                               // argument_count
-                     nullptr,                         // argument_names
-                     nullptr                          // argument_values
+  EmitEvent(TraceEventType::kFlowBegin,      // type
+            category_group,                  // category_group
+            name,                            // name
+            id,                              // id
+            0,                               // argument_count
+            nullptr,                         // argument_names
+            nullptr                          // argument_values
   );
 }
 
 void TraceEventFlowStep0(TraceArg category_group,
                          TraceArg name,
                          TraceIDArg id) {
-  Dart_TimelineEvent(name,                           // label
-                     Dart_TimelineGetMicros(),       // timestamp0
-                     id,                             // timestamp1_or_async_id
-                     Dart_Timeline_Event_Flow_Step,  // event type
-                     0,                              // argument_count
-                     nullptr,                        // argument_names
-                     nullptr                         // argument_values
+  EmitEvent(TraceEventType::kFlowStep,      // type
+            category_group,                 // category_group
+            name,                           // name
+            id,                             // id
+            0,                              // argument_count
+            nullptr,                        // argument_names
+            nullptr                         // argument_values
   );
 }
 
 void TraceEventFlowEnd0(TraceArg category_group, TraceArg name, TraceIDArg id) {
-  Dart_TimelineEvent(name,                          // label
-                     Dart_TimelineGetMicros(),      // timestamp0
-                     id,                            // timestamp1_or_async_id
-                     Dart_Timeline_Event_Flow_End,  // event type
-                     0,                             // argument_count
-                     nullptr,                       // argument_names
-                     nullptr                        // argument_values
+  EmitEvent(TraceEventType::kFlowEnd,      // type
+            category_group,                // category_group
+            name,                          // name
+            id,                            // id
+            0,                             // argument_count
+            nullptr,                       // argument_names
+            nullptr                        // argument_values
   );
 }
 
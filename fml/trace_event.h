@@ -5,54 +5,91 @@
 #ifndef FLUTTER_FML_TRACE_EVENT_H_
 #define FLUTTER_FML_TRACE_EVENT_H_
 
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
+#include <functional>
+#include <map>
 #include <string>
+#include <vector>
 
 #include "flutter/fml/macros.h"
 
 #ifndef TRACE_EVENT_HIDE_MACROS
 
-#define TRACE_EVENT0(category_group, name)           \
-  ::fml::tracing::TraceEvent0(category_group, name); \
-  ::fml::tracing::ScopedInstantEnd __trace_end0_##__LINE__(name);
-
-#define TRACE_EVENT1(category_group, name, arg1_name, arg1_val)           \
-  ::fml::tracing::TraceEvent1(category_group, name, arg1_name, arg1_val); \
-  ::fml::tracing::ScopedInstantEnd __trace_end1_##__LINE__(name);
+#define __FML__TOKEN_CAT__(x, y) x##y
+#define __FML__TOKEN_CAT__2(x, y) __FML__TOKEN_CAT__(x, y)
+#define __FML__UNIQUE(prefix) __FML__TOKEN_CAT__2(prefix, __LINE__)
+
+// The enable flag of the category is looked up once per call site. After
+// that, events of disabled categories cost a load and a branch.
+#define __FML__TRACE_CATEGORY_FLAG(category_group) \
+  static const std::atomic<bool>& __FML__UNIQUE(__trace_category_) = \
+      ::fml::tracing::GetCategoryEnabledFlag(category_group);
+
+#define __FML__TRACE_IF_CATEGORY_ENABLED(category_group, call) \
+  do {                                                          \
+    __FML__TRACE_CATEGORY_FLAG(category_group)                  \
+    if (__FML__UNIQUE(__trace_category_)                        \
+            .load(std::memory_order_relaxed)) {                 \
+      call;                                                     \
+    }                                                           \
+  } while (0)
+
+#define TRACE_EVENT0(category_group, name)                           \
+  __FML__TRACE_CATEGORY_FLAG(category_group)                         \
+  ::fml::tracing::ScopedTraceEvent __FML__UNIQUE(__trace_event_)(    \
+      __FML__UNIQUE(__trace_category_), category_group, name);
+
+#define TRACE_EVENT1(category_group, name, arg1_name, arg1_val)     \
+  __FML__TRACE_CATEGORY_FLAG(category_group)                        \
+  ::fml::tracing::ScopedTraceEvent __FML__UNIQUE(__trace_event_)(   \
+      __FML__UNIQUE(__trace_category_), category_group, name, arg1_name, \
+      arg1_val);
 
 #define TRACE_EVENT2(category_group, name, arg1_name, arg1_val, arg2_name, \
                      arg2_val)                                             \
-  ::fml::tracing::TraceEvent2(category_group, name, arg1_name, arg1_val,   \
-                              arg2_name, arg2_val);                        \
-  ::fml::tracing::ScopedInstantEnd __trace_end2_##__LINE__(name);
+  __FML__TRACE_CATEGORY_FLAG(category_group)                               \
+  ::fml::tracing::ScopedTraceEvent __FML__UNIQUE(__trace_event_)(          \
+      __FML__UNIQUE(__trace_category_), category_group, name, arg1_name,   \
+      arg1_val, arg2_name, arg2_val);
 
 #define TRACE_EVENT_ASYNC_BEGIN0(category_group, name, id) \
-  ::fml::tracing::TraceEventAsyncBegin0(category_group, name, id);
+  __FML__TRACE_IF_CATEGORY_ENABLED(                        \
+      category_group,                                      \
+      ::fml::tracing::TraceEventAsyncBegin0(category_group, name, id))
 
 #define TRACE_EVENT_ASYNC_END0(category_group, name, id) \
-  ::fml::tracing::TraceEventAsyncEnd0(category_group, name, id);
+  __FML__TRACE_IF_CATEGORY_ENABLED(                      \
+      category_group,                                    \
+      ::fml::tracing::TraceEventAsyncEnd0(category_group, name, id))
 
-#define TRACE_EVENT_ASYNC_BEGIN1(category_group, name, id, arg1_name,        \
-                                 arg1_val)                                   \
-  ::fml::tracing::TraceEventAsyncBegin1(category_group, name, id, arg1_name, \
-                                        arg1_val);
+#define TRACE_EVENT_ASYNC_BEGIN1(category_group, name, id, arg1_name,         \
+                                 arg1_val)                                    \
+  __FML__TRACE_IF_CATEGORY_ENABLED(                                           \
+      category_group, ::fml::tracing::TraceEventAsyncBegin1(                  \
+                          category_group, name, id, arg1_name, arg1_val))
 
 #define TRACE_EVENT_ASYNC_END1(category_group, name, id, arg1_name, arg1_val) \
-  ::fml::tracing::TraceEventAsyncEnd1(category_group, name, id, arg1_name,    \
-                                      arg1_val);
+  __FML__TRACE_IF_CATEGORY_ENABLED(                                           \
+      category_group, ::fml::tracing::TraceEventAsyncEnd1(                    \
+                          category_group, name, id, arg1_name, arg1_val))
 
 #define TRACE_EVENT_INSTANT0(category_group, name) \
-  ::fml::tracing::TraceEventInstant0(category_group, name);
+  __FML__TRACE_IF_CATEGORY_ENABLED(                \
+      category_group, ::fml::tracing::TraceEventInstant0(category_group, name))
 
 #define TRACE_FLOW_BEGIN(category, name, id) \
-  ::fml::tracing::TraceEventFlowBegin0(category, name, id);
+  __FML__TRACE_IF_CATEGORY_ENABLED(          \
+      category, ::fml::tracing::TraceEventFlowBegin0(category, name, id))
 
 #define TRACE_FLOW_STEP(category, name, id) \
-  ::fml::tracing::TraceEventFlowStep0(category, name, id);
+  __FML__TRACE_IF_CATEGORY_ENABLED(         \
+      category, ::fml::tracing::TraceEventFlowStep0(category, name, id))
 
 #define TRACE_FLOW_END(category, name, id) \
-  ::fml::tracing::TraceEventFlowEnd0(category, name, id);
+  __FML__TRACE_IF_CATEGORY_ENABLED(        \
+      category, ::fml::tracing::TraceEventFlowEnd0(category, name, id))
 
 #endif  // TRACE_EVENT_HIDE_MACROS
 
@@ -106,6 +143,144 @@ void TraceEventFlowStep0(TraceArg category_group, TraceArg name, TraceIDArg id);
 
 void TraceEventFlowEnd0(TraceArg category_group, TraceArg name, TraceIDArg id);
 
+// Returns the flag that is set while events of the category are recorded. The
+// flag lives as long as the process, so call sites may cache it.
+const std::atomic<bool>& GetCategoryEnabledFlag(TraceArg category_group);
+
+bool IsCategoryEnabled(TraceArg category_group);
+
+// Only events of the given categories are recorded from now on. Events of all
+// categories are recorded if the list is empty, which is the default.
+// Categories are only ever enabled while the Dart timeline records the events
+// of the engine or while events are recorded per thread, so that events cost
+// no more than a load and a branch while nobody traces.
+void SetEnabledCategories(const std::vector<std::string>& categories);
+
+// Whether the Dart timeline records the events of the engine. Set when the
+// embedder stream of the timeline is enabled or disabled. Disabling it sends
+// the events still batched on any thread.
+void SetTimelineEnabled(bool enabled);
+
+bool IsTimelineEnabled();
+
+// Events emitted on the current thread between these calls are batched and
+// sent to the Dart timeline by the thread once the outermost batch ends, or
+// once the batch is full. Events emitted outside of a batch, such as those of
+// threads without a message loop, are sent right away. The message loop
+// batches the events of the tasks it runs.
+void BeginTimelineBatch();
+
+void EndTimelineBatch();
+
+enum class TraceEventType {
+  kBegin,
+  kEnd,
+  kInstant,
+  kAsyncBegin,
+  kAsyncEnd,
+  kFlowBegin,
+  kFlowStep,
+  kFlowEnd,
+};
+
+// A trace event recorded in the ring buffer of the thread that emitted it.
+// Categories, names and argument names are kept by pointer, so they must be
+// string literals or otherwise outlive recording, as they are in the tracing
+// macros. Argument values are copied and truncated to fit, at a code point
+// boundary so that they remain valid UTF-8.
+struct TraceEventRecord {
+  static constexpr size_t kMaxArguments = 2;
+
+  TraceEventType type;
+  int64_t timestamp_micros;
+  int64_t id;
+  int64_t thread_id;
+  // Empty for the end of a scoped event.
+  const char* category;
+  const char* name;
+  size_t argument_count;
+  const char* argument_names[kMaxArguments];
+  char argument_values[kMaxArguments][32];
+};
+
+// While recording, the events of the enabled categories are also copied into
+// a ring buffer per thread, in addition to being sent to the Dart timeline if
+// it is enabled.
+// Threads write to their buffers without locking. Events are dropped when the
+// buffer of a thread, which holds about a thousand events, is full until it is
+// flushed.
+void StartRecording();
+
+void StopRecording();
+
+bool IsRecording();
+
+// Moves the recorded events of every thread, in order per thread, to the
+// callback and returns the number of events dropped since the last flush. May
+// be called on any thread, for example on a background thread that writes the
+// events out, while other threads keep recording.
+size_t FlushRecordedEvents(
+    const std::function<void(const TraceEventRecord&)>& callback);
+
+// Names the current thread in recorded traces. fml::Thread names its threads.
+void SetCurrentThreadName(const std::string& name);
+
+// The names of the threads, by the thread ID of their recorded events.
+std::map<int64_t, std::string> GetThreadNames();
+
+// Ends the event of the given name if its category was enabled when the scope
+// began. The name must outlive the scope, as literals and __FUNCTION__ do.
+class ScopedTraceEvent {
+ public:
+  ScopedTraceEvent(const std::atomic<bool>& category_enabled,
+                   TraceArg category_group,
+                   TraceArg name)
+      : name_(category_enabled.load(std::memory_order_relaxed) ? name
+                                                               : nullptr) {
+    if (name_ != nullptr) {
+      TraceEvent0(category_group, name);
+    }
+  }
+
+  ScopedTraceEvent(const std::atomic<bool>& category_enabled,
+                   TraceArg category_group,
+                   TraceArg name,
+                   TraceArg arg1_name,
+                   TraceArg arg1_val)
+      : name_(category_enabled.load(std::memory_order_relaxed) ? name
+                                                               : nullptr) {
+    if (name_ != nullptr) {
+      TraceEvent1(category_group, name, arg1_name, arg1_val);
+    }
+  }
+
+  ScopedTraceEvent(const std::atomic<bool>& category_enabled,
+                   TraceArg category_group,
+                   TraceArg name,
+                   TraceArg arg1_name,
+                   TraceArg arg1_val,
+                   TraceArg arg2_name,
+                   TraceArg arg2_val)
+      : name_(category_enabled.load(std::memory_order_relaxed) ? name
+                                                               : nullptr) {
+    if (name_ != nullptr) {
+      TraceEvent2(category_group, name, arg1_name, arg1_val, arg2_name,
+                  arg2_val);
+    }
+  }
+
+  ~ScopedTraceEvent() {
+    if (name_ != nullptr) {
+      TraceEventEnd(name_);
+    }
+  }
+
+ private:
+  const TraceArg name_;
+
+  FML_DISALLOW_COPY_AND_ASSIGN(ScopedTraceEvent);
+};
+
 class ScopedInstantEnd {
  public:
   ScopedInstantEnd(std::string str) : label_(std::move(str)) {}
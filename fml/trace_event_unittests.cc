@@ -0,0 +1,101 @@
+// Copyright 2018 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "flutter/fml/trace_event.h"
+#include "gtest/gtest.h"
+
+namespace fml {
+namespace tracing {
+
+static void EmitTestEvents() {
+  TRACE_EVENT0("fml_test", "Scope");
+  TRACE_EVENT_INSTANT0("fml_test_other", "Instant");
+}
+
+static std::vector<std::string> FlushEventNames() {
+  std::vector<std::string> names;
+  FlushRecordedEvents([&names](const TraceEventRecord& event) {
+    names.push_back(event.name);
+  });
+  return names;
+}
+
+TEST(TraceEventTest, RecordsOnlyEnabledCategories) {
+  FlushRecordedEvents([](const TraceEventRecord&) {});
+  StartRecording();
+
+  SetEnabledCategories({"fml_test_other"});
+  ASSERT_FALSE(IsCategoryEnabled("fml_test"));
+  ASSERT_TRUE(IsCategoryEnabled("fml_test_other"));
+  EmitTestEvents();
+  ASSERT_EQ(FlushEventNames(), std::vector<std::string>({"Instant"}));
+
+  SetEnabledCategories({});
+  ASSERT_TRUE(IsCategoryEnabled("fml_test"));
+  EmitTestEvents();
+  ASSERT_EQ(FlushEventNames(),
+            std::vector<std::string>({"Scope", "Instant", "Scope"}));
+
+  StopRecording();
+  EmitTestEvents();
+  ASSERT_TRUE(FlushEventNames().empty());
+}
+
+TEST(TraceEventTest, DisablesCategoriesWhileNothingRecords) {
+  SetEnabledCategories({});
+  ASSERT_FALSE(IsTimelineEnabled());
+  ASSERT_FALSE(IsCategoryEnabled("fml_test"));
+
+  StartRecording();
+  ASSERT_TRUE(IsCategoryEnabled("fml_test"));
+  StopRecording();
+  ASSERT_FALSE(IsCategoryEnabled("fml_test"));
+}
+
+TEST(TraceEventTest, RecordsEventsOfEachThreadInOrder) {
+  FlushRecordedEvents([](const TraceEventRecord&) {});
+  StartRecording();
+  std::thread([]() { EmitTestEvents(); }).join();
+  StopRecording();
+
+  std::vector<TraceEventRecord> events;
+  ASSERT_EQ(FlushRecordedEvents([&events](const TraceEventRecord& event) {
+              events.push_back(event);
+            }),
+            0u);
+  ASSERT_EQ(events.size(), 3u);
+  ASSERT_EQ(events[0].type, TraceEventType::kBegin);
+  ASSERT_EQ(events[1].type, TraceEventType::kInstant);
+  ASSERT_EQ(events[2].type, TraceEventType::kEnd);
+  ASSERT_EQ(std::string(events[1].category), "fml_test_other");
+  ASSERT_EQ(events[0].thread_id, events[2].thread_id);
+  ASSERT_LE(events[0].timestamp_micros, events[2].timestamp_micros);
+}
+
+TEST(TraceEventTest, TruncatesArgumentValuesAtCodePoints) {
+  FlushRecordedEvents([](const TraceEventRecord&) {});
+  StartRecording();
+  // Thirty two bytes, of which the last code point does not fit.
+  std::string value(30, 'a');
+  value += "\xC3\xA9";
+  { TRACE_EVENT1("fml_test", "Scope", "value", value.c_str()); }
+  StopRecording();
+
+  std::vector<std::string> values;
+  FlushRecordedEvents([&values](const TraceEventRecord& event) {
+    if (event.type == TraceEventType::kBegin) {
+      ASSERT_EQ(event.argument_count, 1u);
+      ASSERT_EQ(std::string(event.argument_names[0]), "value");
+      values.push_back(event.argument_values[0]);
+    }
+  });
+  ASSERT_EQ(values, std::vector<std::string>({std::string(30, 'a')}));
+}
+
+}  // namespace tracing
+}  // namespace fml
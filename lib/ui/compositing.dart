@@ -247,6 +247,11 @@ class SceneBuilder extends NativeFieldWrapperClass2 {
 
   /// Sets a threshold after which additional debugging information should be recorded.
   ///
+  /// Frames that take longer than `frameInterval` frame intervals to
+  /// rasterize are written, as an SKP together with the time each of their
+  /// layers took, to the cache directory of the application. A
+  /// `frameInterval` of zero disables this.
+  ///
   /// Currently this interface is difficult to use by end-developers. If you're
   /// interested in using this feature, please contact [flutter-dev](https://groups.google.com/forum/#!forum/flutter-dev).
   /// We'll hopefully be able to figure out how to make this feature more useful
@@ -4,8 +4,11 @@
 
 #include "flutter/lib/ui/text/font_collection.h"
 
+#include <limits>
 #include <mutex>
+#include <string>
 
+#include "flutter/fml/trace_event.h"
 #include "flutter/lib/ui/text/asset_manager_font_provider.h"
 #include "flutter/runtime/test_font_data.h"
 #include "third_party/rapidjson/rapidjson/document.h"
@@ -14,6 +17,7 @@
 #include "third_party/skia/include/core/SkStream.h"
 #include "third_party/skia/include/core/SkTypeface.h"
 #include "txt/asset_font_manager.h"
+#include "txt/paragraph_builder.h"
 #include "txt/test_font_manager.h"
 #include "txt/typeface_font_asset_provider.h"
 
@@ -106,4 +110,47 @@ void FontCollection::RegisterTestFonts() {
   collection_->DisableFontFallback();
 }
 
+void FontCollection::Prewarm(std::shared_ptr<txt::FontCollection> collection,
+                             const std::vector<std::string>& families,
+                             const std::vector<std::string>& locales) {
+  TRACE_EVENT0("flutter", "FontCollection::Prewarm");
+
+  const std::u16string text =
+      u"The quick brown fox jumps over the lazy dog. 0123456789";
+  std::vector<std::string> prewarm_locales(locales);
+  if (prewarm_locales.empty()) {
+    prewarm_locales.push_back("");
+  }
+
+  for (const auto& family : families) {
+    for (const auto& locale : prewarm_locales) {
+      TRACE_EVENT2("flutter", "FontCollection::PrewarmFamily", "family",
+                   family.c_str(), "locale", locale.c_str());
+      txt::TextStyle text_style;
+      text_style.font_family = family;
+      text_style.locale = locale;
+      txt::ParagraphBuilder builder(txt::ParagraphStyle(), collection);
+      builder.PushStyle(text_style);
+      builder.AddText(text);
+      builder.Pop();
+      builder.Build()->Layout(std::numeric_limits<double>::max());
+    }
+  }
+}
+
+void FontCollection::TraceFallbackCacheStats() {
+  txt::FontCollection::FallbackCacheStats stats =
+      collection_->GetFallbackCacheStats();
+  if (stats.hits == last_traced_fallback_stats_.hits &&
+      stats.misses == last_traced_fallback_stats_.misses) {
+    return;
+  }
+  last_traced_fallback_stats_ = stats;
+
+  std::string hits = std::to_string(stats.hits);
+  std::string misses = std::to_string(stats.misses);
+  TRACE_EVENT2("flutter", "FontFallbackCache", "hits", hits.c_str(), "misses",
+               misses.c_str());
+}
+
 }  // namespace blink
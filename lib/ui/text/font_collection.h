@@ -6,6 +6,7 @@
 #define FLUTTER_LIB_UI_TEXT_FONT_COLLECTION_H_
 
 #include <memory>
+#include <string>
 #include <vector>
 
 #include "flutter/assets/asset_manager.h"
@@ -27,8 +28,22 @@ class FontCollection {
 
   void RegisterTestFonts();
 
+  // Lays out a short run of text with each of the families of the collection.
+  // This fills the collection's cache of families and the process wide caches
+  // of typefaces, font coverage and HarfBuzz faces, so the engine finds the
+  // families ready when it first needs them. Blocks until done and may be
+  // called on any thread, while the collection is in use on the UI thread.
+  static void Prewarm(std::shared_ptr<txt::FontCollection> collection,
+                      const std::vector<std::string>& families,
+                      const std::vector<std::string>& locales);
+
+  // Emits a trace event with the font fallback cache counters if they changed
+  // since the last call.
+  void TraceFallbackCacheStats();
+
  private:
   std::shared_ptr<txt::FontCollection> collection_;
+  txt::FontCollection::FallbackCacheStats last_traced_fallback_stats_;
 
   FXL_DISALLOW_COPY_AND_ASSIGN(FontCollection);
 };
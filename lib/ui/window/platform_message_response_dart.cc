@@ -16,9 +16,6 @@ namespace blink {
 
 namespace {
 
-// Avoid copying the contents of messages beyond a certain size.
-const int kMessageCopyThreshold = 1000;
-
 void MessageDataFinalizer(void* isolate_callback_data,
                           Dart_WeakPersistentHandle handle,
                           void* peer) {
@@ -34,15 +31,34 @@ Dart_Handle WrapByteData(std::vector<uint8_t> data) {
     Dart_Handle data_handle = Dart_NewExternalTypedDataWithFinalizer(
         Dart_TypedData_kByteData, heap_data->data(), heap_data->size(),
         heap_data, heap_data->size(), MessageDataFinalizer);
-    DART_CHECK_VALID(data_handle);
+    if (Dart_IsError(data_handle))
+      delete heap_data;
     return data_handle;
   }
 }
 
+void MappingFinalizer(void* isolate_callback_data,
+                      Dart_WeakPersistentHandle handle,
+                      void* peer) {
+  delete reinterpret_cast<fml::Mapping*>(peer);
+}
+
 Dart_Handle WrapByteData(std::unique_ptr<fml::Mapping> mapping) {
-  std::vector<uint8_t> data(mapping->GetSize());
-  memcpy(data.data(), mapping->GetMapping(), mapping->GetSize());
-  return WrapByteData(std::move(data));
+  const size_t size = mapping->GetSize();
+  // Dart may write to the byte data, so mappings that may be read-only memory,
+  // such as those of assets, are copied.
+  uint8_t* bytes = mapping->GetMutableMapping();
+  if (size < kMessageCopyThreshold || bytes == nullptr) {
+    return WrapByteData(
+        std::vector<uint8_t>(mapping->GetMapping(),
+                             mapping->GetMapping() + size));
+  }
+  fml::Mapping* peer = mapping.release();
+  Dart_Handle data_handle = Dart_NewExternalTypedDataWithFinalizer(
+      Dart_TypedData_kByteData, bytes, size, peer, size, MappingFinalizer);
+  if (Dart_IsError(data_handle))
+    delete peer;
+  return data_handle;
 }
 
 }  // anonymous namespace
@@ -75,6 +91,8 @@ void PlatformMessageResponseDart::Complete(std::unique_ptr<fml::Mapping> data) {
         tonic::DartState::Scope scope(dart_state);
 
         Dart_Handle byte_buffer = WrapByteData(std::move(data));
+        if (Dart_IsError(byte_buffer))
+          byte_buffer = Dart_Null();
         tonic::DartInvoke(callback.Release(), {byte_buffer});
       }));
 }
@@ -20,4 +20,8 @@ void PointerDataPacket::SetPointerData(size_t i, const PointerData& data) {
   memcpy(&data_[i * sizeof(PointerData)], &data, sizeof(PointerData));
 }
 
+PointerData& PointerDataPacket::GetPointerData(size_t i) {
+  return *reinterpret_cast<PointerData*>(&data_[i * sizeof(PointerData)]);
+}
+
 }  // namespace blink
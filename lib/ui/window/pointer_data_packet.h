@@ -21,6 +21,10 @@ class PointerDataPacket {
   ~PointerDataPacket();
 
   void SetPointerData(size_t i, const PointerData& data);
+  // Returns the |i|th pointer data in the packet's own storage, so that it can
+  // be filled in without being copied. The packet starts out zeroed.
+  PointerData& GetPointerData(size_t i);
+  size_t GetPointerCount() const { return data_.size() / sizeof(PointerData); }
   const std::vector<uint8_t>& data() const { return data_; }
 
  private:
@@ -12,6 +12,7 @@
 #include "lib/tonic/dart_library_natives.h"
 #include "lib/tonic/dart_microtask_queue.h"
 #include "lib/tonic/logging/dart_invoke.h"
+#include "lib/tonic/scopes/dart_api_scope.h"
 #include "lib/tonic/typed_data/dart_byte_data.h"
 
 using tonic::DartInvokeField;
@@ -22,6 +23,54 @@ using tonic::ToDart;
 namespace blink {
 namespace {
 
+void PlatformMessageDataFinalizer(void* isolate_callback_data,
+                                  Dart_WeakPersistentHandle handle,
+                                  void* peer) {
+  delete reinterpret_cast<fxl::RefPtr<PlatformMessage>*>(peer);
+}
+
+// Large payloads are not copied: the typed data points into the message's
+// buffer and holds a reference to the message until it is collected.
+Dart_Handle WrapPlatformMessageData(fxl::RefPtr<PlatformMessage> message) {
+  const std::vector<uint8_t>& data = message->data();
+  if (data.size() < kMessageCopyThreshold)
+    return ToByteData(data);
+
+  uint8_t* bytes = const_cast<uint8_t*>(data.data());
+  intptr_t size = data.size();
+  auto* peer = new fxl::RefPtr<PlatformMessage>(std::move(message));
+  Dart_Handle data_handle = Dart_NewExternalTypedDataWithFinalizer(
+      Dart_TypedData_kByteData, bytes, size, peer, size,
+      PlatformMessageDataFinalizer);
+  if (Dart_IsError(data_handle))
+    delete peer;
+  return data_handle;
+}
+
+void PointerDataPacketFinalizer(void* isolate_callback_data,
+                                Dart_WeakPersistentHandle handle,
+                                void* peer) {
+  delete reinterpret_cast<PointerDataPacket*>(peer);
+}
+
+// Packets are always handed to Dart without a copy, even single events, as the
+// engine never reads a packet again once it has been dispatched.
+Dart_Handle WrapPointerDataPacket(std::unique_ptr<PointerDataPacket> packet) {
+  const std::vector<uint8_t>& data = packet->data();
+  if (data.empty())
+    return ToByteData(data);
+
+  uint8_t* bytes = const_cast<uint8_t*>(data.data());
+  intptr_t size = data.size();
+  PointerDataPacket* peer = packet.release();
+  Dart_Handle data_handle = Dart_NewExternalTypedDataWithFinalizer(
+      Dart_TypedData_kByteData, bytes, size, peer, size,
+      PointerDataPacketFinalizer);
+  if (Dart_IsError(data_handle))
+    delete peer;
+  return data_handle;
+}
+
 void DefaultRouteName(Dart_NativeArguments args) {
   std::string routeName =
       UIDartState::Current()->window()->client()->DefaultRouteName();
@@ -204,8 +253,29 @@ void Window::DispatchPlatformMessage(fxl::RefPtr<PlatformMessage> message) {
   if (!dart_state)
     return;
   tonic::DartState::Scope scope(dart_state);
+  InvokeDispatchPlatformMessage(std::move(message));
+}
+
+void Window::DispatchPlatformMessages(
+    std::vector<fxl::RefPtr<PlatformMessage>> messages) {
+  tonic::DartState* dart_state = library_.dart_state().get();
+  if (!dart_state)
+    return;
+  tonic::DartState::Scope scope(dart_state);
+  for (auto& message : messages) {
+    // Release the handles of each message before dispatching the next one.
+    tonic::DartApiScope api_scope;
+    InvokeDispatchPlatformMessage(std::move(message));
+    // Run the microtasks of each message before the next one is handled, as if
+    // each message had been dispatched by a task of its own.
+    UIDartState::Current()->FlushMicrotasksNow();
+  }
+}
+
+void Window::InvokeDispatchPlatformMessage(
+    fxl::RefPtr<PlatformMessage> message) {
   Dart_Handle data_handle =
-      (message->hasData()) ? ToByteData(message->data()) : Dart_Null();
+      (message->hasData()) ? WrapPlatformMessageData(message) : Dart_Null();
   if (Dart_IsError(data_handle))
     return;
 
@@ -220,13 +290,14 @@ void Window::DispatchPlatformMessage(fxl::RefPtr<PlatformMessage> message) {
       {ToDart(message->channel()), data_handle, ToDart(response_id)});
 }
 
-void Window::DispatchPointerDataPacket(const PointerDataPacket& packet) {
+void Window::DispatchPointerDataPacket(
+    std::unique_ptr<PointerDataPacket> packet) {
   tonic::DartState* dart_state = library_.dart_state().get();
   if (!dart_state)
     return;
   tonic::DartState::Scope scope(dart_state);
 
-  Dart_Handle data_handle = ToByteData(packet.data());
+  Dart_Handle data_handle = WrapPointerDataPacket(std::move(packet));
   if (Dart_IsError(data_handle))
     return;
   DartInvokeField(library_.value(), "_dispatchPointerDataPacket",
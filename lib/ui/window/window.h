@@ -5,6 +5,7 @@
 #ifndef FLUTTER_LIB_UI_WINDOW_WINDOW_H_
 #define FLUTTER_LIB_UI_WINDOW_WINDOW_H_
 
+#include <memory>
 #include <unordered_map>
 
 #include "flutter/lib/ui/semantics/semantics_update.h"
@@ -23,6 +24,10 @@ namespace blink {
 class FontCollection;
 class Scene;
 
+// Payloads at least this large are handed to Dart as external typed data that
+// owns the native buffer instead of being copied into the Dart heap.
+constexpr size_t kMessageCopyThreshold = 1000;
+
 Dart_Handle ToByteData(const std::vector<uint8_t>& buffer);
 
 class WindowClient {
@@ -55,7 +60,11 @@ class Window final {
   void UpdateUserSettingsData(const std::string& data);
   void UpdateSemanticsEnabled(bool enabled);
   void DispatchPlatformMessage(fxl::RefPtr<PlatformMessage> message);
-  void DispatchPointerDataPacket(const PointerDataPacket& packet);
+  // Dispatches the messages in order, entering the isolate only once. The
+  // microtasks scheduled by each message run before the next is dispatched.
+  void DispatchPlatformMessages(
+      std::vector<fxl::RefPtr<PlatformMessage>> messages);
+  void DispatchPointerDataPacket(std::unique_ptr<PointerDataPacket> packet);
   void DispatchSemanticsAction(int32_t id,
                                SemanticsAction action,
                                std::vector<uint8_t> args);
@@ -76,6 +85,9 @@ class Window final {
   int next_response_id_ = 1;
   std::unordered_map<int, fxl::RefPtr<blink::PlatformMessageResponse>>
       pending_responses_;
+
+  // Must be called with the isolate of |library_| current.
+  void InvokeDispatchPlatformMessage(fxl::RefPtr<PlatformMessage> message);
 };
 
 }  // namespace blink
@@ -151,6 +151,15 @@ bool DartFileModifiedCallback(const char* source_url, int64_t since_ms) {
 
 void ThreadExitCallback() {}
 
+// Trace event categories are only enabled while the timeline records them.
+void EmbedderTimelineStartRecording() {
+  fml::tracing::SetTimelineEnabled(true);
+}
+
+void EmbedderTimelineStopRecording() {
+  fml::tracing::SetTimelineEnabled(false);
+}
+
 Dart_Handle GetVMServiceAssetsArchiveCallback() {
 #if (FLUTTER_RUNTIME_MODE == FLUTTER_RUNTIME_MODE_RELEASE) || \
     (FLUTTER_RUNTIME_MODE == FLUTTER_RUNTIME_MODE_DYNAMIC_RELEASE)
@@ -403,6 +412,13 @@ DartVM::DartVM(const Settings& settings,
 
   Dart_SetFileModifiedCallback(&DartFileModifiedCallback);
 
+  Dart_SetEmbedderTimelineCallbacks(&EmbedderTimelineStartRecording,
+                                    &EmbedderTimelineStopRecording);
+  if (settings.trace_startup) {
+    // The startup trace is recorded before the timeline can be enabled.
+    fml::tracing::SetTimelineEnabled(true);
+  }
+
   {
     TRACE_EVENT0("flutter", "Dart_Initialize");
     Dart_InitializeParams params = {};
@@ -0,0 +1,26 @@
+// Copyright 2018 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+import 'dart:async';
+import 'dart:convert';
+import 'dart:typed_data';
+import 'dart:ui';
+
+// Logs each message and the microtask it schedules. The "done" message sends
+// the log back on the "log" channel.
+void platform_message_ordering_main() {
+  final List<String> log = <String>[];
+  window.onPlatformMessage =
+      (String name, ByteData data, PlatformMessageResponseCallback callback) {
+    if (name == 'done') {
+      final Uint8List bytes = new Uint8List.fromList(utf8.encode(log.join(',')));
+      window.sendPlatformMessage('log', bytes.buffer.asByteData(), null);
+      return;
+    }
+    log.add('message $name');
+    scheduleMicrotask(() {
+      log.add('microtask $name');
+    });
+  };
+}
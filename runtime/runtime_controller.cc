@@ -199,12 +199,23 @@ bool RuntimeController::DispatchPlatformMessage(
   return false;
 }
 
+bool RuntimeController::DispatchPlatformMessages(
+    std::vector<fxl::RefPtr<PlatformMessage>> messages) {
+  if (auto window = GetWindowIfAvailable()) {
+    TRACE_EVENT1("flutter", "RuntimeController::DispatchPlatformMessage",
+                 "mode", "batch");
+    window->DispatchPlatformMessages(std::move(messages));
+    return true;
+  }
+  return false;
+}
+
 bool RuntimeController::DispatchPointerDataPacket(
-    const PointerDataPacket& packet) {
+    std::unique_ptr<PointerDataPacket> packet) {
   if (auto window = GetWindowIfAvailable()) {
     TRACE_EVENT1("flutter", "RuntimeController::DispatchPointerDataPacket",
                  "mode", "basic");
-    window->DispatchPointerDataPacket(packet);
+    window->DispatchPointerDataPacket(std::move(packet));
     return true;
   }
   return false;
@@ -55,7 +55,10 @@ class RuntimeController final : public WindowClient {
 
   bool DispatchPlatformMessage(fxl::RefPtr<PlatformMessage> message);
 
-  bool DispatchPointerDataPacket(const PointerDataPacket& packet);
+  bool DispatchPlatformMessages(
+      std::vector<fxl::RefPtr<PlatformMessage>> messages);
+
+  bool DispatchPointerDataPacket(std::unique_ptr<PointerDataPacket> packet);
 
   bool DispatchSemanticsAction(int32_t id,
                                SemanticsAction action,
@@ -0,0 +1,94 @@
+// Copyright 2018 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <string>
+#include <vector>
+
+#include "flutter/lib/ui/text/font_collection.h"
+#include "flutter/runtime/dart_isolate.h"
+#include "flutter/runtime/dart_vm.h"
+#include "flutter/runtime/runtime_controller.h"
+#include "flutter/runtime/runtime_delegate.h"
+#include "flutter/testing/testing.h"
+#include "flutter/testing/thread_test.h"
+
+#define CURRENT_TEST_NAME                                           \
+  std::string {                                                     \
+    ::testing::UnitTest::GetInstance()->current_test_info()->name() \
+  }
+
+namespace blink {
+
+using RuntimeControllerTest = ::testing::ThreadTest;
+
+// Keeps the platform messages sent by the isolate.
+class TestRuntimeDelegate : public RuntimeDelegate {
+ public:
+  std::vector<fxl::RefPtr<PlatformMessage>> messages;
+
+  std::string DefaultRouteName() override { return "/"; }
+
+  void ScheduleFrame(bool regenerate_layer_tree) override {}
+
+  void Render(std::unique_ptr<flow::LayerTree> layer_tree) override {}
+
+  void UpdateSemantics(SemanticsNodeUpdates update) override {}
+
+  void HandlePlatformMessage(fxl::RefPtr<PlatformMessage> message) override {
+    messages.push_back(std::move(message));
+  }
+
+  FontCollection& GetFontCollection() override { return font_collection_; }
+
+ private:
+  FontCollection font_collection_;
+};
+
+TEST_F(RuntimeControllerTest, RunsMicrotasksOfEachBatchedPlatformMessage) {
+  Settings settings = {};
+  settings.task_observer_add = [](intptr_t, fxl::Closure) {};
+  settings.task_observer_remove = [](intptr_t) {};
+  auto vm = DartVM::ForProcess(settings);
+  ASSERT_TRUE(vm);
+  TaskRunners task_runners(CURRENT_TEST_NAME,       //
+                           GetCurrentTaskRunner(),  //
+                           GetCurrentTaskRunner(),  //
+                           GetCurrentTaskRunner(),  //
+                           GetCurrentTaskRunner()   //
+  );
+  TestRuntimeDelegate delegate;
+  RuntimeController runtime_controller(
+      delegate,                  // runtime delegate
+      vm.get(),                  // VM
+      vm->GetIsolateSnapshot(),  // isolate snapshot
+      vm->GetSharedSnapshot(),   // shared snapshot
+      std::move(task_runners),   // task runners
+      {},                        // resource context
+      nullptr,                   // skia unref queue
+      "main.dart",               // advisory script uri
+      "main"                     // advisory script entrypoint
+  );
+  auto root_isolate = runtime_controller.GetRootIsolate();
+  ASSERT_TRUE(root_isolate);
+  ASSERT_TRUE(root_isolate->PrepareForRunningFromSource(
+      testing::GetFixturesPath() +
+          std::string{"/platform_message_ordering.dart"},
+      ""));
+  ASSERT_TRUE(root_isolate->Run("platform_message_ordering_main"));
+
+  std::vector<fxl::RefPtr<PlatformMessage>> messages;
+  for (const char* channel : {"a", "b", "done"}) {
+    messages.push_back(fxl::MakeRefCounted<PlatformMessage>(
+        channel, std::vector<uint8_t>{0}, nullptr));
+  }
+  ASSERT_TRUE(runtime_controller.DispatchPlatformMessages(std::move(messages)));
+
+  ASSERT_EQ(delegate.messages.size(), 1u);
+  ASSERT_EQ(delegate.messages[0]->channel(), "log");
+  const auto& log = delegate.messages[0]->data();
+  ASSERT_EQ(std::string(log.begin(), log.end()),
+            "message a,microtask a,message b,microtask b");
+}
+
+}  // namespace blink
@@ -30,6 +30,10 @@ const fxl::StringView ServiceProtocol::kFlushUIThreadTasksExtensionName =
     "_flutter.flushUIThreadTasks";
 const fxl::StringView ServiceProtocol::kSetAssetBundlePathExtensionName =
     "_flutter.setAssetBundlePath";
+const fxl::StringView ServiceProtocol::kSetLayerProfilingEnabledExtensionName =
+    "_flutter.setLayerProfilingEnabled";
+const fxl::StringView ServiceProtocol::kGetLayerProfileExtensionName =
+    "_flutter.getLayerProfile";
 
 static constexpr fxl::StringView kViewIdPrefx = "_flutterView/";
 static constexpr fxl::StringView kListViewsExtensionName = "_flutter.listViews";
@@ -45,6 +49,8 @@ ServiceProtocol::ServiceProtocol()
           kRunInViewExtensionName,
           kFlushUIThreadTasksExtensionName,
           kSetAssetBundlePathExtensionName,
+          kSetLayerProfilingEnabledExtensionName,
+          kGetLayerProfileExtensionName,
       }) {}
 
 ServiceProtocol::~ServiceProtocol() {
@@ -25,6 +25,8 @@ class ServiceProtocol {
   static const fxl::StringView kRunInViewExtensionName;
   static const fxl::StringView kFlushUIThreadTasksExtensionName;
   static const fxl::StringView kSetAssetBundlePathExtensionName;
+  static const fxl::StringView kSetLayerProfilingEnabledExtensionName;
+  static const fxl::StringView kGetLayerProfileExtensionName;
 
   class Handler {
    public:
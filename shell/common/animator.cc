@@ -12,10 +12,12 @@ namespace shell {
 
 Animator::Animator(Delegate& delegate,
                    blink::TaskRunners task_runners,
-                   std::unique_ptr<VsyncWaiter> waiter)
+                   std::unique_ptr<VsyncWaiter> waiter,
+                   std::shared_ptr<FrameTimings> frame_timings)
     : delegate_(delegate),
       task_runners_(std::move(task_runners)),
       waiter_(std::move(waiter)),
+      frame_timings_(std::move(frame_timings)),
       last_begin_frame_time_(),
       dart_frame_deadline_(0),
       layer_tree_pipeline_(fxl::MakeRefCounted<LayerTreePipeline>(2)),
@@ -25,7 +27,9 @@ Animator::Animator(Delegate& delegate,
       regenerate_layer_tree_(false),
       frame_scheduled_(false),
       dimension_change_pending_(false),
-      weak_factory_(this) {}
+      weak_factory_(this) {
+  FXL_DCHECK(frame_timings_);
+}
 
 Animator::~Animator() = default;
 
@@ -48,6 +52,18 @@ void Animator::SetDimensionChangePending() {
   dimension_change_pending_ = true;
 }
 
+void Animator::SetRefreshRate(double refresh_rate) {
+  waiter_->SetRefreshRate(refresh_rate);
+}
+
+void Animator::OnFrameRasterized(fxl::TimeDelta raster_time) {
+  waiter_->OnFrameRasterized(raster_time);
+}
+
+FrameTimings& Animator::GetFrameTimings() {
+  return *frame_timings_;
+}
+
 // This Parity is used by the timeline component to correctly align
 // GPU Workloads events with their respective Framework Workload.
 const char* Animator::FrameParity() {
@@ -64,6 +80,8 @@ void Animator::BeginFrame(fxl::TimePoint frame_start_time,
                           fxl::TimePoint frame_target_time) {
   TRACE_EVENT_ASYNC_END0("flutter", "Frame Request Pending", frame_number_++);
 
+  const fxl::TimePoint begin_frame_time = fxl::TimePoint::Now();
+
   frame_scheduled_ = false;
   regenerate_layer_tree_ = false;
   pending_frame_semaphore_.Signal();
@@ -89,6 +107,9 @@ void Animator::BeginFrame(fxl::TimePoint frame_start_time,
 
   last_begin_frame_time_ = frame_start_time;
   dart_frame_deadline_ = FxlToDartOrEarlier(frame_target_time);
+  frame_timings_->RecordVsyncLatency(begin_frame_time - frame_start_time);
+  build_start_time_ = begin_frame_time;
+  frame_target_time_ = frame_target_time;
   {
     TRACE_EVENT2("flutter", "Framework Workload", "mode", "basic", "frame",
                  FrameParity());
@@ -111,8 +132,18 @@ void Animator::Render(std::unique_ptr<flow::LayerTree> layer_tree) {
 
   if (layer_tree) {
     // Note the frame time for instrumentation.
-    layer_tree->set_construction_time(fxl::TimePoint::Now() -
-                                      last_begin_frame_time_);
+    const fxl::TimePoint now = fxl::TimePoint::Now();
+    layer_tree->set_construction_time(now - last_begin_frame_time_);
+    // Only the first layer tree rendered for a vsync pulse is a frame. Others,
+    // such as those rendered when semantics are enabled, are not timed.
+    if (frame_target_time_ != fxl::TimePoint()) {
+      frame_timings_->RecordBuildTime(now - build_start_time_);
+      layer_tree->set_target_time(frame_target_time_);
+      layer_tree->set_frame_interval(frame_target_time_ -
+                                     last_begin_frame_time_);
+      build_start_time_ = fxl::TimePoint();
+      frame_target_time_ = fxl::TimePoint();
+    }
   }
 
   // Commit the pending continuation.
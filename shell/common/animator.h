@@ -5,7 +5,10 @@
 #ifndef FLUTTER_SHELL_COMMON_ANIMATOR_H_
 #define FLUTTER_SHELL_COMMON_ANIMATOR_H_
 
+#include <memory>
+
 #include "flutter/common/task_runners.h"
+#include "flutter/shell/common/frame_timings.h"
 #include "flutter/shell/common/rasterizer.h"
 #include "flutter/shell/common/vsync_waiter.h"
 #include "flutter/synchronization/pipeline.h"
@@ -35,7 +38,8 @@ class Animator final {
 
   Animator(Delegate& delegate,
            blink::TaskRunners task_runners,
-           std::unique_ptr<VsyncWaiter> waiter);
+           std::unique_ptr<VsyncWaiter> waiter,
+           std::shared_ptr<FrameTimings> frame_timings);
 
   ~Animator();
 
@@ -49,6 +53,13 @@ class Animator final {
 
   void SetDimensionChangePending();
 
+  void SetRefreshRate(double refresh_rate);
+
+  void OnFrameRasterized(fxl::TimeDelta raster_time);
+
+  // The timings this animator records the frames it begins in.
+  FrameTimings& GetFrameTimings();
+
  private:
   using LayerTreePipeline = flutter::Pipeline<flow::LayerTree>;
 
@@ -65,8 +76,13 @@ class Animator final {
   Delegate& delegate_;
   blink::TaskRunners task_runners_;
   std::unique_ptr<VsyncWaiter> waiter_;
+  std::shared_ptr<FrameTimings> frame_timings_;
 
   fxl::TimePoint last_begin_frame_time_;
+  // When the frame being built began to be built and is to be presented. Both
+  // are reset once the frame is rendered.
+  fxl::TimePoint build_start_time_;
+  fxl::TimePoint frame_target_time_;
   int64_t dart_frame_deadline_;
   fxl::RefPtr<LayerTreePipeline> layer_tree_pipeline_;
   flutter::Semaphore pending_frame_semaphore_;
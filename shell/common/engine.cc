@@ -4,6 +4,7 @@
 
 #include "flutter/shell/common/engine.h"
 
+#include <atomic>
 #include <memory>
 #include <utility>
 
@@ -14,6 +15,7 @@
 #include "flutter/shell/common/animator.h"
 #include "flutter/shell/common/platform_view.h"
 #include "flutter/shell/common/shell.h"
+#include "flutter/shell/common/trace_exporter.h"
 #include "lib/fxl/files/eintr_wrapper.h"
 #include "lib/fxl/files/file.h"
 #include "lib/fxl/files/path.h"
@@ -22,6 +24,7 @@
 #include "third_party/rapidjson/rapidjson/document.h"
 #include "third_party/skia/include/core/SkCanvas.h"
 #include "third_party/skia/include/core/SkPictureRecorder.h"
+#include "txt/font_metadata_cache.h"
 
 #ifdef ERROR
 #undef ERROR
@@ -34,6 +37,12 @@ static constexpr char kLifecycleChannel[] = "flutter/lifecycle";
 static constexpr char kNavigationChannel[] = "flutter/navigation";
 static constexpr char kLocalizationChannel[] = "flutter/localization";
 static constexpr char kSettingsChannel[] = "flutter/settings";
+static constexpr char kTracingChannel[] = "flutter/tracing";
+static constexpr char kFrameTimingsChannel[] = "flutter/frametimings";
+
+// Set while a flush of the font metadata cache is posted to an IO thread. The
+// cache is process wide, so idle notifications of every engine share it.
+static std::atomic_bool g_font_metadata_flush_pending(false);
 
 Engine::Engine(Delegate& delegate,
                blink::DartVM& vm,
@@ -46,6 +55,7 @@ Engine::Engine(Delegate& delegate,
                fxl::RefPtr<flow::SkiaUnrefQueue> unref_queue)
     : delegate_(delegate),
       settings_(std::move(settings)),
+      io_task_runner_(task_runners.GetIOTaskRunner()),
       animator_(std::move(animator)),
       load_script_error_(tonic::kNoError),
       activity_running_(false),
@@ -65,6 +75,13 @@ Engine::Engine(Delegate& delegate,
       settings_.advisory_script_uri,        // advisory script uri
       settings_.advisory_script_entrypoint  // advisory script entrypoint
   );
+
+  // Font coverage computed by earlier launches is kept next to the other
+  // temporary files of the application.
+  if (!settings_.temp_directory_path.empty()) {
+    txt::FontMetadataCache::GetInstance().SetCacheDirectory(
+        settings_.temp_directory_path);
+  }
 }
 
 Engine::~Engine() = default;
@@ -162,12 +179,24 @@ bool Engine::PrepareAndLaunchIsolate(RunConfiguration configuration) {
 
 void Engine::BeginFrame(fxl::TimePoint frame_time) {
   TRACE_EVENT0("flutter", "Engine::BeginFrame");
+  DispatchPendingPointerData(frame_time);
   runtime_controller_->BeginFrame(frame_time);
+  font_collection_.TraceFallbackCacheStats();
 }
 
 void Engine::NotifyIdle(int64_t deadline) {
   TRACE_EVENT0("flutter", "Engine::NotifyIdle");
   runtime_controller_->NotifyIdle(deadline);
+  // Write the cache file if new font families were created, without holding
+  // up the UI thread. Idle notifications arriving before the IO thread gets to
+  // a posted flush don't post another one.
+  if (txt::FontMetadataCache::GetInstance().HasPendingEntries() &&
+      !g_font_metadata_flush_pending.exchange(true)) {
+    io_task_runner_->PostTask([]() {
+      g_font_metadata_flush_pending = false;
+      txt::FontMetadataCache::GetInstance().Flush();
+    });
+  }
 }
 
 std::pair<bool, uint32_t> Engine::GetUIIsolateReturnCode() {
@@ -230,6 +259,9 @@ void Engine::DispatchPlatformMessage(
   } else if (message->channel() == kSettingsChannel) {
     HandleSettingsPlatformMessage(message.get());
     return;
+  } else if (message->channel() == kTracingChannel) {
+    HandleTracingPlatformMessage(std::move(message));
+    return;
   }
 
   if (runtime_controller_->IsRootIsolateRunning() &&
@@ -242,6 +274,50 @@ void Engine::DispatchPlatformMessage(
     HandleNavigationPlatformMessage(std::move(message));
 }
 
+void Engine::DispatchPlatformMessages(
+    std::vector<fxl::RefPtr<blink::PlatformMessage>> messages) {
+  std::vector<fxl::RefPtr<blink::PlatformMessage>> batch;
+  for (auto& message : messages) {
+    if (IsEnginePlatformChannel(message->channel())) {
+      // Keep the order of the messages intact.
+      DispatchPlatformMessagesToRuntime(std::move(batch));
+      batch.clear();
+      DispatchPlatformMessage(std::move(message));
+    } else {
+      batch.push_back(std::move(message));
+    }
+  }
+  DispatchPlatformMessagesToRuntime(std::move(batch));
+}
+
+bool Engine::IsEnginePlatformChannel(const std::string& channel) const {
+  return channel == kLifecycleChannel || channel == kLocalizationChannel ||
+         channel == kSettingsChannel || channel == kTracingChannel;
+}
+
+void Engine::DispatchPlatformMessagesToRuntime(
+    std::vector<fxl::RefPtr<blink::PlatformMessage>> messages) {
+  if (messages.empty()) {
+    return;
+  }
+
+  if (messages.size() == 1) {
+    DispatchPlatformMessage(std::move(messages.front()));
+    return;
+  }
+
+  if (runtime_controller_->IsRootIsolateRunning() &&
+      runtime_controller_->DispatchPlatformMessages(messages)) {
+    return;
+  }
+
+  // If there's no runtime_, we may still need to set the initial route.
+  for (auto& message : messages) {
+    if (message->channel() == kNavigationChannel)
+      HandleNavigationPlatformMessage(std::move(message));
+  }
+}
+
 bool Engine::HandleLifecyclePlatformMessage(blink::PlatformMessage* message) {
   const auto& data = message->data();
   std::string state(reinterpret_cast<const char*>(data.data()), data.size());
@@ -317,8 +393,53 @@ void Engine::HandleSettingsPlatformMessage(blink::PlatformMessage* message) {
   }
 }
 
-void Engine::DispatchPointerDataPacket(const blink::PointerDataPacket& packet) {
-  runtime_controller_->DispatchPointerDataPacket(packet);
+// Lets the platform record a trace and write it to a file without the Dart VM
+// service. The trace is written to the trace export path of the settings
+// unless the call gives another.
+void Engine::HandleTracingPlatformMessage(
+    fxl::RefPtr<blink::PlatformMessage> message) {
+  fxl::RefPtr<blink::PlatformMessageResponse> response = message->response();
+  TraceExporter::Get().HandleMethodCall(
+      message->data(), settings_.trace_export_path,
+      [response](std::string reply) {
+        if (!response) {
+          return;
+        }
+        if (reply.empty()) {
+          response->CompleteEmpty();
+          return;
+        }
+        response->Complete(std::make_unique<fml::DataMapping>(
+            std::vector<uint8_t>(reply.begin(), reply.end())));
+      });
+}
+
+void Engine::DispatchPointerDataPacket(
+    std::unique_ptr<blink::PointerDataPacket> packet) {
+  // Without a running animator there is no frame to deliver the data with.
+  if (!settings_.resample_pointer_events || !activity_running_ ||
+      !have_surface_) {
+    runtime_controller_->DispatchPointerDataPacket(std::move(packet));
+    return;
+  }
+
+  pointer_data_resampler_.Enqueue(*packet);
+  ScheduleFrame();
+}
+
+void Engine::DispatchPendingPointerData(fxl::TimePoint frame_time) {
+  if (!pointer_data_resampler_.HasPendingData())
+    return;
+
+  TRACE_EVENT0("flutter", "Engine::DispatchPendingPointerData");
+  auto packet = pointer_data_resampler_.TakeForFrame(
+      frame_time.ToEpochDelta().ToMicroseconds());
+  if (packet)
+    runtime_controller_->DispatchPointerDataPacket(std::move(packet));
+
+  // Moves after the frame time are delivered with the next frame.
+  if (pointer_data_resampler_.HasPendingData())
+    ScheduleFrame();
 }
 
 void Engine::DispatchSemanticsAction(int id,
@@ -333,6 +454,9 @@ void Engine::SetSemanticsEnabled(bool enabled) {
 
 void Engine::StopAnimator() {
   animator_->Stop();
+  // No frame will deliver the pending pointer data.
+  if (auto packet = pointer_data_resampler_.TakeAll())
+    runtime_controller_->DispatchPointerDataPacket(std::move(packet));
 }
 
 void Engine::StartAnimatorIfPossible() {
@@ -347,6 +471,14 @@ std::string Engine::DefaultRouteName() {
   return "/";
 }
 
+void Engine::SetVsyncRefreshRate(double refresh_rate) {
+  animator_->SetRefreshRate(refresh_rate);
+}
+
+void Engine::OnFrameRasterized(fxl::TimeDelta raster_time) {
+  animator_->OnFrameRasterized(raster_time);
+}
+
 void Engine::ScheduleFrame(bool regenerate_layer_tree) {
   animator_->RequestFrame(regenerate_layer_tree);
 }
@@ -372,6 +504,8 @@ void Engine::HandlePlatformMessage(
     fxl::RefPtr<blink::PlatformMessage> message) {
   if (message->channel() == kAssetChannel) {
     HandleAssetPlatformMessage(std::move(message));
+  } else if (message->channel() == kFrameTimingsChannel) {
+    HandleFrameTimingsPlatformMessage(std::move(message));
   } else {
     delegate_.OnEngineHandlePlatformMessage(*this, std::move(message));
   }
@@ -403,4 +537,20 @@ void Engine::HandleAssetPlatformMessage(
   response->CompleteEmpty();
 }
 
+void Engine::HandleFrameTimingsPlatformMessage(
+    fxl::RefPtr<blink::PlatformMessage> message) {
+  fxl::RefPtr<blink::PlatformMessageResponse> response = message->response();
+  if (!response) {
+    return;
+  }
+  std::string reply =
+      animator_->GetFrameTimings().HandleMethodCall(message->data());
+  if (reply.empty()) {
+    response->CompleteEmpty();
+    return;
+  }
+  response->Complete(std::make_unique<fml::DataMapping>(
+      std::vector<uint8_t>(reply.begin(), reply.end())));
+}
+
 }  // namespace shell
@@ -18,6 +18,7 @@
 #include "flutter/runtime/runtime_controller.h"
 #include "flutter/runtime/runtime_delegate.h"
 #include "flutter/shell/common/animator.h"
+#include "flutter/shell/common/pointer_data_resampler.h"
 #include "flutter/shell/common/rasterizer.h"
 #include "flutter/shell/common/run_configuration.h"
 #include "lib/fxl/macros.h"
@@ -89,7 +90,13 @@ class Engine final : public blink::RuntimeDelegate {
 
   void DispatchPlatformMessage(fxl::RefPtr<blink::PlatformMessage> message);
 
-  void DispatchPointerDataPacket(const blink::PointerDataPacket& packet);
+  // Dispatches the messages in order. Consecutive messages for the isolate are
+  // delivered with a single entry into it.
+  void DispatchPlatformMessages(
+      std::vector<fxl::RefPtr<blink::PlatformMessage>> messages);
+
+  void DispatchPointerDataPacket(
+      std::unique_ptr<blink::PointerDataPacket> packet);
 
   void DispatchSemanticsAction(int id,
                                blink::SemanticsAction action,
@@ -97,6 +104,12 @@ class Engine final : public blink::RuntimeDelegate {
 
   void SetSemanticsEnabled(bool enabled);
 
+  // Changes the refresh rate of vsync waiters that pace frames with a timer.
+  // A rate of zero or less renders frames as fast as possible.
+  void SetVsyncRefreshRate(double refresh_rate);
+
+  void OnFrameRasterized(fxl::TimeDelta raster_time);
+
   void ScheduleFrame(bool regenerate_layer_tree = true) override;
 
   // |blink::RuntimeDelegate|
@@ -105,6 +118,8 @@ class Engine final : public blink::RuntimeDelegate {
  private:
   Engine::Delegate& delegate_;
   const blink::Settings settings_;
+  // Flushes the font metadata cache off the UI thread.
+  const fxl::RefPtr<fxl::TaskRunner> io_task_runner_;
   std::unique_ptr<Animator> animator_;
   std::unique_ptr<blink::RuntimeController> runtime_controller_;
   tonic::DartErrorHandleType load_script_error_;
@@ -114,6 +129,7 @@ class Engine final : public blink::RuntimeDelegate {
   bool activity_running_;
   bool have_surface_;
   blink::FontCollection font_collection_;
+  PointerDataResampler pointer_data_resampler_;
   fml::WeakPtrFactory<Engine> weak_factory_;
 
   // |blink::RuntimeDelegate|
@@ -133,6 +149,13 @@ class Engine final : public blink::RuntimeDelegate {
 
   void StartAnimatorIfPossible();
 
+  void DispatchPendingPointerData(fxl::TimePoint frame_time);
+
+  bool IsEnginePlatformChannel(const std::string& channel) const;
+
+  void DispatchPlatformMessagesToRuntime(
+      std::vector<fxl::RefPtr<blink::PlatformMessage>> messages);
+
   bool HandleLifecyclePlatformMessage(blink::PlatformMessage* message);
 
   bool HandleNavigationPlatformMessage(
@@ -142,8 +165,14 @@ class Engine final : public blink::RuntimeDelegate {
 
   void HandleSettingsPlatformMessage(blink::PlatformMessage* message);
 
+  void HandleTracingPlatformMessage(
+      fxl::RefPtr<blink::PlatformMessage> message);
+
   void HandleAssetPlatformMessage(fxl::RefPtr<blink::PlatformMessage> message);
 
+  void HandleFrameTimingsPlatformMessage(
+      fxl::RefPtr<blink::PlatformMessage> message);
+
   bool GetAssetAsBuffer(const std::string& name, std::vector<uint8_t>* data);
 
   bool PrepareAndLaunchIsolate(RunConfiguration configuration);
@@ -0,0 +1,180 @@
+// Copyright 2018 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/shell/common/frame_timings.h"
+
+#include <algorithm>
+
+#include "third_party/rapidjson/rapidjson/document.h"
+#include "third_party/rapidjson/rapidjson/stringbuffer.h"
+#include "third_party/rapidjson/rapidjson/writer.h"
+
+namespace shell {
+
+FrameTimings::Histogram::Histogram() {
+  Reset();
+}
+
+FrameTimings::Histogram::~Histogram() = default;
+
+void FrameTimings::Histogram::Add(fxl::TimeDelta duration) {
+  const int64_t micros = std::max<int64_t>(duration.ToMicroseconds(), 0);
+  const size_t bucket = std::min<size_t>(micros / kBucketMicros,  //
+                                         kBucketCount - 1);
+  buckets_[bucket].fetch_add(1, std::memory_order_relaxed);
+
+  int64_t max = max_micros_.load(std::memory_order_relaxed);
+  while (micros > max &&
+         !max_micros_.compare_exchange_weak(max, micros,
+                                            std::memory_order_relaxed)) {
+  }
+}
+
+FrameTimings::Histogram::Percentiles
+FrameTimings::Histogram::GetPercentiles() const {
+  // Work on a snapshot so that the percentiles agree with the count.
+  std::array<uint64_t, kBucketCount> buckets;
+  uint64_t count = 0;
+  for (size_t i = 0; i < kBucketCount; i++) {
+    buckets[i] = buckets_[i].load(std::memory_order_relaxed);
+    count += buckets[i];
+  }
+
+  Percentiles percentiles;
+  if (count == 0) {
+    return percentiles;
+  }
+  percentiles.count = count;
+  const int64_t max_micros = max_micros_.load(std::memory_order_relaxed);
+  percentiles.max = fxl::TimeDelta::FromMicroseconds(max_micros);
+
+  auto percentile = [&](uint64_t percent) {
+    const uint64_t rank = std::max<uint64_t>((count * percent + 99) / 100, 1);
+    uint64_t seen = 0;
+    for (size_t i = 0; i < kBucketCount - 1; i++) {
+      seen += buckets[i];
+      if (seen >= rank) {
+        return fxl::TimeDelta::FromMicroseconds(
+            std::min<int64_t>((i + 1) * kBucketMicros, max_micros));
+      }
+    }
+    return percentiles.max;
+  };
+  percentiles.p50 = percentile(50);
+  percentiles.p90 = percentile(90);
+  percentiles.p99 = percentile(99);
+  return percentiles;
+}
+
+void FrameTimings::Histogram::Reset() {
+  for (auto& bucket : buckets_) {
+    bucket.store(0, std::memory_order_relaxed);
+  }
+  max_micros_.store(0, std::memory_order_relaxed);
+}
+
+FrameTimings::FrameTimings() : missed_frame_count_(0) {}
+
+FrameTimings::~FrameTimings() = default;
+
+void FrameTimings::RecordVsyncLatency(fxl::TimeDelta latency) {
+  vsync_latency_.Add(latency);
+}
+
+void FrameTimings::RecordBuildTime(fxl::TimeDelta build_time) {
+  build_time_.Add(build_time);
+}
+
+void FrameTimings::RecordRasterTime(fxl::TimeDelta raster_time, bool missed) {
+  if (missed) {
+    missed_frame_count_.fetch_add(1, std::memory_order_relaxed);
+  }
+  raster_time_.Add(raster_time);
+}
+
+FrameTimings::Summary FrameTimings::GetSummary() const {
+  Summary summary;
+  summary.missed_frame_count =
+      missed_frame_count_.load(std::memory_order_relaxed);
+  summary.build_time = build_time_.GetPercentiles();
+  summary.raster_time = raster_time_.GetPercentiles();
+  summary.vsync_latency = vsync_latency_.GetPercentiles();
+  summary.frame_count = summary.raster_time.count;
+  return summary;
+}
+
+void FrameTimings::Reset() {
+  build_time_.Reset();
+  raster_time_.Reset();
+  vsync_latency_.Reset();
+  missed_frame_count_.store(0, std::memory_order_relaxed);
+}
+
+static void WritePercentiles(
+    rapidjson::Writer<rapidjson::StringBuffer>& writer,
+    const char* name,
+    const FrameTimings::Histogram::Percentiles& percentiles) {
+  writer.Key(name);
+  writer.StartObject();
+  writer.Key("count");
+  writer.Uint64(percentiles.count);
+  writer.Key("p50Micros");
+  writer.Int64(percentiles.p50.ToMicroseconds());
+  writer.Key("p90Micros");
+  writer.Int64(percentiles.p90.ToMicroseconds());
+  writer.Key("p99Micros");
+  writer.Int64(percentiles.p99.ToMicroseconds());
+  writer.Key("maxMicros");
+  writer.Int64(percentiles.max.ToMicroseconds());
+  writer.EndObject();
+}
+
+static std::string ErrorEnvelope(const char* message) {
+  rapidjson::StringBuffer buffer;
+  rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+  writer.StartArray();
+  writer.String("error");
+  writer.String(message);
+  writer.Null();
+  writer.EndArray();
+  return std::string(buffer.GetString(), buffer.GetSize());
+}
+
+std::string FrameTimings::HandleMethodCall(const std::vector<uint8_t>& call) {
+  rapidjson::Document document;
+  document.Parse(reinterpret_cast<const char*>(call.data()), call.size());
+  if (document.HasParseError() || !document.IsObject()) {
+    return ErrorEnvelope("The method call is not a JSON object.");
+  }
+  auto root = document.GetObject();
+  auto method = root.FindMember("method");
+  if (method == root.MemberEnd() || !method->value.IsString()) {
+    return ErrorEnvelope("The method call has no method name.");
+  }
+
+  if (method->value == "get") {
+    const auto summary = GetSummary();
+    rapidjson::StringBuffer buffer;
+    rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+    writer.StartArray();
+    writer.StartObject();
+    writer.Key("frameCount");
+    writer.Uint64(summary.frame_count);
+    writer.Key("missedFrameCount");
+    writer.Uint64(summary.missed_frame_count);
+    WritePercentiles(writer, "buildTime", summary.build_time);
+    WritePercentiles(writer, "rasterTime", summary.raster_time);
+    WritePercentiles(writer, "vsyncLatency", summary.vsync_latency);
+    writer.EndObject();
+    writer.EndArray();
+    return std::string(buffer.GetString(), buffer.GetSize());
+  }
+  if (method->value == "reset") {
+    Reset();
+    return "[null]";
+  }
+  return std::string();
+}
+
+}  // namespace shell
@@ -0,0 +1,114 @@
+// Copyright 2018 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_SHELL_COMMON_FRAME_TIMINGS_H_
+#define FLUTTER_SHELL_COMMON_FRAME_TIMINGS_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <array>
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include "lib/fxl/macros.h"
+#include "lib/fxl/time/time_delta.h"
+
+namespace shell {
+
+// Histograms of how long the frames of a shell took to build and raster, and
+// of how late the UI thread began to build them. Frames are recorded on the UI
+// and GPU threads and the histograms are read on any thread, typically the
+// platform thread, without taking a lock.
+class FrameTimings {
+ public:
+  // A histogram of durations in buckets of |kBucketMicros|. Percentiles are
+  // reported as the upper bound of the bucket they fall in, so they are
+  // accurate to a bucket.
+  class Histogram {
+   public:
+    static constexpr int64_t kBucketMicros = 100;
+    // Durations of 50ms and more share the last bucket, for which the maximum
+    // duration is reported.
+    static constexpr size_t kBucketCount = 501;
+
+    struct Percentiles {
+      uint64_t count = 0;
+      fxl::TimeDelta p50;
+      fxl::TimeDelta p90;
+      fxl::TimeDelta p99;
+      fxl::TimeDelta max;
+    };
+
+    Histogram();
+
+    ~Histogram();
+
+    void Add(fxl::TimeDelta duration);
+
+    // Samples added while the percentiles are being computed may or may not
+    // be accounted for.
+    Percentiles GetPercentiles() const;
+
+    void Reset();
+
+   private:
+    std::array<std::atomic<uint64_t>, kBucketCount> buckets_;
+    std::atomic<int64_t> max_micros_;
+
+    FXL_DISALLOW_COPY_AND_ASSIGN(Histogram);
+  };
+
+  struct Summary {
+    // The number of frames rasterized.
+    uint64_t frame_count = 0;
+    // The number of frames rasterized after the time they were to be
+    // presented at.
+    uint64_t missed_frame_count = 0;
+    Histogram::Percentiles build_time;
+    Histogram::Percentiles raster_time;
+    Histogram::Percentiles vsync_latency;
+  };
+
+  FrameTimings();
+
+  ~FrameTimings();
+
+  // The time from the vsync pulse to the UI thread beginning to build the
+  // frame. Called on the UI thread.
+  void RecordVsyncLatency(fxl::TimeDelta latency);
+
+  // The time the UI thread took to build the frame. Called on the UI thread.
+  void RecordBuildTime(fxl::TimeDelta build_time);
+
+  // Called on the GPU thread.
+  void RecordRasterTime(fxl::TimeDelta raster_time, bool missed);
+
+  // May be called on any thread.
+  Summary GetSummary() const;
+
+  // May be called on any thread. Frames recorded concurrently may be kept in
+  // part.
+  void Reset();
+
+  // Handles a call encoded with the JSON method codec of the framework, on the
+  // "flutter/frametimings" channel. The methods are "get", whose result is the
+  // summary as a JSON object, and "reset", whose result is null. Returns the
+  // encoded reply envelope, which is empty for methods that are not
+  // implemented.
+  std::string HandleMethodCall(const std::vector<uint8_t>& call);
+
+ private:
+  Histogram build_time_;
+  Histogram raster_time_;
+  Histogram vsync_latency_;
+  std::atomic<uint64_t> missed_frame_count_;
+
+  FXL_DISALLOW_COPY_AND_ASSIGN(FrameTimings);
+};
+
+}  // namespace shell
+
+#endif  // FLUTTER_SHELL_COMMON_FRAME_TIMINGS_H_
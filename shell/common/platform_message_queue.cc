@@ -0,0 +1,65 @@
+// Copyright 2018 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/shell/common/platform_message_queue.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace shell {
+
+PlatformMessageQueue::PlatformMessageQueue(
+    const std::vector<std::string>& latest_value_channels)
+    : latest_value_channels_(latest_value_channels.begin(),
+                             latest_value_channels.end()) {}
+
+PlatformMessageQueue::~PlatformMessageQueue() = default;
+
+bool PlatformMessageQueue::Push(fxl::RefPtr<blink::PlatformMessage> message) {
+  fxl::RefPtr<blink::PlatformMessage> superseded;
+  bool was_empty = false;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    was_empty = messages_.empty();
+    const std::string& channel = message->channel();
+    if (latest_value_channels_.count(channel) == 0) {
+      messages_.push_back(std::move(message));
+    } else {
+      auto found = latest_value_indices_.find(channel);
+      if (found == latest_value_indices_.end()) {
+        latest_value_indices_[channel] = messages_.size();
+        messages_.push_back(std::move(message));
+      } else {
+        // Leave a hole in the slot of the superseded message so that the new
+        // one is dispatched after the messages pushed before it.
+        superseded = std::move(messages_[found->second]);
+        found->second = messages_.size();
+        messages_.push_back(std::move(message));
+      }
+    }
+  }
+
+  // Complete outside of the lock as responses may post tasks.
+  if (superseded && superseded->response()) {
+    superseded->response()->CompleteEmpty();
+  }
+  return was_empty;
+}
+
+std::vector<fxl::RefPtr<blink::PlatformMessage>>
+PlatformMessageQueue::TakeAll() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::vector<fxl::RefPtr<blink::PlatformMessage>> messages;
+  messages.swap(messages_);
+  latest_value_indices_.clear();
+  messages.erase(
+      std::remove_if(messages.begin(), messages.end(),
+                     [](const fxl::RefPtr<blink::PlatformMessage>& message) {
+                       return !message;
+                     }),
+      messages.end());
+  return messages;
+}
+
+}  // namespace shell
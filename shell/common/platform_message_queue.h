@@ -0,0 +1,51 @@
+// Copyright 2018 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_SHELL_COMMON_PLATFORM_MESSAGE_QUEUE_H_
+#define FLUTTER_SHELL_COMMON_PLATFORM_MESSAGE_QUEUE_H_
+
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "flutter/lib/ui/window/platform_message.h"
+#include "lib/fxl/macros.h"
+#include "lib/fxl/memory/ref_ptr.h"
+
+namespace shell {
+
+// Collects the platform messages sent from the platform thread so that the UI
+// thread can dispatch all the messages that arrived since its last turn with a
+// single entry into the isolate. On the given latest value channels, a message
+// drops the pending message of the same channel and is queued after the
+// messages pushed before it, so that the order of all channels is kept.
+class PlatformMessageQueue {
+ public:
+  explicit PlatformMessageQueue(
+      const std::vector<std::string>& latest_value_channels);
+
+  ~PlatformMessageQueue();
+
+  // Returns true if the queue was empty, in which case the caller is
+  // responsible for scheduling a call to |TakeAll|.
+  bool Push(fxl::RefPtr<blink::PlatformMessage> message);
+
+  // Returns the pending messages in the order in which they were pushed.
+  std::vector<fxl::RefPtr<blink::PlatformMessage>> TakeAll();
+
+ private:
+  const std::unordered_set<std::string> latest_value_channels_;
+  std::mutex mutex_;
+  std::vector<fxl::RefPtr<blink::PlatformMessage>> messages_;
+  // Index in |messages_| of the pending message of each latest value channel.
+  std::unordered_map<std::string, size_t> latest_value_indices_;
+
+  FXL_DISALLOW_COPY_AND_ASSIGN(PlatformMessageQueue);
+};
+
+}  // namespace shell
+
+#endif  // FLUTTER_SHELL_COMMON_PLATFORM_MESSAGE_QUEUE_H_
@@ -0,0 +1,121 @@
+// Copyright 2018 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/shell/common/pointer_data_resampler.h"
+
+#include <string.h>
+
+#include <unordered_map>
+#include <unordered_set>
+
+namespace shell {
+namespace {
+
+// Pointer data further ahead of the frame than this is assumed to use a
+// different clock than the frame, and is never held back.
+constexpr int64_t kMaxHoldTimeMicros = 100000;
+
+bool IsMove(const blink::PointerData& data) {
+  return data.change == blink::PointerData::Change::kMove ||
+         data.change == blink::PointerData::Change::kHover;
+}
+
+double Lerp(double from, double to, double t) {
+  return from + (to - from) * t;
+}
+
+std::unique_ptr<blink::PointerDataPacket> MakePacket(
+    const std::vector<blink::PointerData>& data) {
+  if (data.empty()) {
+    return nullptr;
+  }
+  auto packet = std::make_unique<blink::PointerDataPacket>(data.size());
+  for (size_t i = 0; i < data.size(); ++i) {
+    packet->SetPointerData(i, data[i]);
+  }
+  return packet;
+}
+
+}  // namespace
+
+PointerDataResampler::PointerDataResampler() = default;
+
+PointerDataResampler::~PointerDataResampler() = default;
+
+void PointerDataResampler::Enqueue(const blink::PointerDataPacket& packet) {
+  const std::vector<uint8_t>& bytes = packet.data();
+  const size_t count = bytes.size() / sizeof(blink::PointerData);
+  const size_t offset = pending_.size();
+  pending_.resize(offset + count);
+  memcpy(&pending_[offset], bytes.data(), count * sizeof(blink::PointerData));
+}
+
+std::unique_ptr<blink::PointerDataPacket> PointerDataResampler::TakeForFrame(
+    int64_t sample_time) {
+  bool can_hold = true;
+  for (const auto& data : pending_) {
+    if (data.time_stamp > sample_time + kMaxHoldTimeMicros) {
+      can_hold = false;
+      break;
+    }
+  }
+
+  std::vector<blink::PointerData> delivered;
+  std::vector<blink::PointerData> held;
+  // Index in |delivered| of the move each device is currently merging into.
+  std::unordered_map<int64_t, size_t> merged_moves;
+  // Devices whose remaining data is held back to keep it in order.
+  std::unordered_set<int64_t> held_devices;
+
+  for (const auto& data : pending_) {
+    if (held_devices.count(data.device) != 0) {
+      held.push_back(data);
+      continue;
+    }
+
+    auto merged = merged_moves.find(data.device);
+    if (can_hold && IsMove(data) && data.time_stamp > sample_time) {
+      // Move the merged move to where the pointer was at the frame.
+      if (merged != merged_moves.end()) {
+        blink::PointerData& move = delivered[merged->second];
+        if (move.change == data.change && move.time_stamp < sample_time) {
+          const double t =
+              static_cast<double>(sample_time - move.time_stamp) /
+              static_cast<double>(data.time_stamp - move.time_stamp);
+          move.physical_x = Lerp(move.physical_x, data.physical_x, t);
+          move.physical_y = Lerp(move.physical_y, data.physical_y, t);
+          move.time_stamp = sample_time;
+        }
+      }
+      held_devices.insert(data.device);
+      held.push_back(data);
+      continue;
+    }
+
+    if (!IsMove(data)) {
+      merged_moves.erase(data.device);
+      delivered.push_back(data);
+      continue;
+    }
+
+    if (merged != merged_moves.end() &&
+        delivered[merged->second].change == data.change) {
+      delivered[merged->second] = data;
+    } else {
+      merged_moves[data.device] = delivered.size();
+      delivered.push_back(data);
+    }
+  }
+
+  pending_.swap(held);
+  return MakePacket(delivered);
+}
+
+std::unique_ptr<blink::PointerDataPacket> PointerDataResampler::TakeAll() {
+  auto packet = MakePacket(pending_);
+  pending_.clear();
+  return packet;
+}
+
+}  // namespace shell
@@ -0,0 +1,50 @@
+// Copyright 2018 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_SHELL_COMMON_POINTER_DATA_RESAMPLER_H_
+#define FLUTTER_SHELL_COMMON_POINTER_DATA_RESAMPLER_H_
+
+#include <stdint.h>
+
+#include <memory>
+#include <vector>
+
+#include "flutter/lib/ui/window/pointer_data.h"
+#include "flutter/lib/ui/window/pointer_data_packet.h"
+#include "lib/fxl/macros.h"
+
+namespace shell {
+
+// Holds the pointer data received between two frames so that it can be
+// delivered as a single packet right before the frame. The moves of a device
+// are merged into one move whose position is resampled to the frame time.
+// Other changes are delivered as they are and in order.
+class PointerDataResampler {
+ public:
+  PointerDataResampler();
+
+  ~PointerDataResampler();
+
+  void Enqueue(const blink::PointerDataPacket& packet);
+
+  bool HasPendingData() const { return !pending_.empty(); }
+
+  // Returns the pointer data to deliver with a frame at |sample_time|, in the
+  // timebase of |PointerData::time_stamp|, or null if there is none. Moves
+  // that happened after |sample_time| are kept to resample the next frame.
+  std::unique_ptr<blink::PointerDataPacket> TakeForFrame(int64_t sample_time);
+
+  // Returns all the pending pointer data as it was received, or null if there
+  // is none.
+  std::unique_ptr<blink::PointerDataPacket> TakeAll();
+
+ private:
+  std::vector<blink::PointerData> pending_;
+
+  FXL_DISALLOW_COPY_AND_ASSIGN(PointerDataResampler);
+};
+
+}  // namespace shell
+
+#endif  // FLUTTER_SHELL_COMMON_POINTER_DATA_RESAMPLER_H_
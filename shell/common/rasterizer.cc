@@ -4,8 +4,13 @@
 
 #include "flutter/shell/common/rasterizer.h"
 
+#include <sstream>
 #include <utility>
 
+#include "flutter/fml/trace_event.h"
+#include "flutter/shell/common/picture_serializer.h"
+#include "flutter/shell/common/trace_exporter.h"
+#include "lib/fxl/files/file.h"
 #include "third_party/skia/include/core/SkEncodedImageFormat.h"
 #include "third_party/skia/include/core/SkImageEncoder.h"
 #include "third_party/skia/include/core/SkPictureRecorder.h"
@@ -94,9 +99,21 @@ void Rasterizer::DoDraw(std::unique_ptr<flow::LayerTree> layer_tree) {
   }
 }
 
+// The interval of the frame the layer tree was built for. Layer trees that were
+// not built for a vsync pulse, or were built for an unpaced one, are measured
+// against a 60Hz frame.
+static double FrameIntervalMS(const flow::LayerTree& layer_tree) {
+  const fxl::TimeDelta frame_interval = layer_tree.frame_interval();
+  return frame_interval > fxl::TimeDelta::Zero()
+             ? frame_interval.ToMillisecondsF()
+             : flow::kOneFrameMS;
+}
+
 bool Rasterizer::DrawToSurface(flow::LayerTree& layer_tree) {
   FXL_DCHECK(surface_);
 
+  const auto draw_start = fxl::TimePoint::Now();
+
   auto frame = surface_->AcquireFrame(layer_tree.frame_size());
 
   if (frame == nullptr) {
@@ -117,8 +134,49 @@ bool Rasterizer::DrawToSurface(flow::LayerTree& layer_tree) {
     canvas->clear(SK_ColorBLACK);
   }
 
-  if (compositor_frame && compositor_frame->Raster(layer_tree, false)) {
+  if (!compositor_frame) {
+    return false;
+  }
+
+  // Frames that are to be captured if slow have their layers timed so that
+  // the capture tells which of them were expensive. So do all frames while
+  // layers are being profiled.
+  const bool capture_if_slow =
+      layer_tree.rasterizer_tracing_threshold() != 0 &&
+      !slow_frame_capture_directory_.empty();
+  std::unique_ptr<flow::LayerTimings> layer_timings;
+  if (capture_if_slow || layer_profiling_enabled_) {
+    layer_timings = std::make_unique<flow::LayerTimings>();
+    compositor_frame->set_layer_timings(layer_timings.get());
+  }
+
+  const auto raster_start = fxl::TimePoint::Now();
+
+  if (compositor_frame->Raster(layer_tree, false)) {
     frame->Submit();
+    const auto raster_end = fxl::TimePoint::Now();
+    const auto raster_time = raster_end - raster_start;
+    if (frame_timings_ && layer_tree.target_time() != fxl::TimePoint()) {
+      frame_timings_->RecordRasterTime(
+          raster_end - draw_start, raster_end > layer_tree.target_time());
+      // The layer tree may be drawn again, but only its first draw is a frame.
+      layer_tree.set_target_time(fxl::TimePoint());
+    }
+    // The frame ends before a slow frame is captured so that the capture does
+    // not count toward the frame time shown by the performance overlay.
+    compositor_frame.reset();
+    if (capture_if_slow &&
+        raster_time.ToMillisecondsF() >
+            layer_tree.rasterizer_tracing_threshold() *
+                FrameIntervalMS(layer_tree)) {
+      CaptureSlowFrame(layer_tree, raster_time, *layer_timings);
+    }
+    if (layer_profiling_enabled_) {
+      layer_profile_.AddFrame(*layer_timings);
+    }
+    // Only timings that match the last layer tree are kept.
+    last_layer_timings_ =
+        layer_profiling_enabled_ ? std::move(layer_timings) : nullptr;
     FireNextFrameCallbackIfPresent();
     return true;
   }
@@ -126,9 +184,19 @@ bool Rasterizer::DrawToSurface(flow::LayerTree& layer_tree) {
   return false;
 }
 
+// Tools that inspect the picture show the timings as an annotation that covers
+// the frame.
+static void DrawLayerTimingsAnnotation(SkCanvas* canvas,
+                                       const SkRect& frame_rect,
+                                       const std::string& timings) {
+  canvas->drawAnnotation(frame_rect, "flutter.layer_timings",
+                         SkData::MakeWithCopy(timings.data(), timings.size()));
+}
+
 static sk_sp<SkPicture> ScreenshotLayerTreeAsPicture(
     flow::LayerTree* tree,
-    flow::CompositorContext& compositor_context) {
+    flow::CompositorContext& compositor_context,
+    const flow::LayerTimings* layer_timings) {
   FXL_DCHECK(tree != nullptr);
   SkPictureRecorder recorder;
   recorder.beginRecording(
@@ -139,9 +207,76 @@ static sk_sp<SkPicture> ScreenshotLayerTreeAsPicture(
 
   frame->Raster(*tree, true);
 
+  if (layer_timings) {
+    DrawLayerTimingsAnnotation(recorder.getRecordingCanvas(),
+                               SkRect::MakeWH(tree->frame_size().width(),
+                                              tree->frame_size().height()),
+                               layer_timings->ToString());
+  }
+
   return recorder.finishRecordingAsPicture();
 }
 
+void Rasterizer::CaptureSlowFrame(
+    flow::LayerTree& layer_tree,
+    fxl::TimeDelta raster_time,
+    const flow::LayerTimings& layer_timings) {
+  TRACE_EVENT0("flutter", "Rasterizer::CaptureSlowFrame");
+
+  // The layer tree is only valid on this thread, so its picture is recorded
+  // here, but everything else is done on the IO thread. The tree is flattened
+  // rather than rastered in a frame of the compositor context, as such a frame
+  // would sweep the raster cache that the next frames need. Flattening does
+  // not consult the raster cache either, so the picture refers to no texture
+  // of the GPU context.
+  const SkRect frame_rect = SkRect::MakeWH(layer_tree.frame_size().width(),
+                                           layer_tree.frame_size().height());
+  sk_sp<SkPicture> frame_picture = layer_tree.Flatten(frame_rect);
+  if (frame_picture == nullptr) {
+    return;
+  }
+
+  std::stringstream name;
+  name << slow_frame_capture_directory_ << "/slow_frame_"
+       << fxl::TimePoint::Now().ToEpochDelta().ToMicroseconds();
+  const std::string path = name.str();
+
+  std::stringstream timings;
+  timings << "Raster time: " << raster_time.ToMillisecondsF() << "ms"
+          << std::endl
+          << "Threshold: " << layer_tree.rasterizer_tracing_threshold()
+          << " frame intervals" << std::endl
+          << layer_timings.ToString();
+
+  task_runners_.GetIOTaskRunner()->PostTask(
+      [path, frame_picture, frame_rect, timings_text = timings.str(),
+       layer_timings_text = layer_timings.ToString()]() {
+        TRACE_EVENT0("flutter", "Rasterizer::WriteSlowFrame");
+        SkPictureRecorder recorder;
+        recorder.beginRecording(frame_rect);
+        recorder.getRecordingCanvas()->drawPicture(frame_picture);
+        DrawLayerTimingsAnnotation(recorder.getRecordingCanvas(), frame_rect,
+                                   layer_timings_text);
+        SerializePicture(path + ".skp",
+                         recorder.finishRecordingAsPicture().get());
+        if (!files::WriteFile(path + ".txt", timings_text.data(),
+                              timings_text.size())) {
+          FXL_LOG(ERROR) << "Could not write the layer timings of a slow "
+                            "frame to "
+                         << path << ".txt";
+          return;
+        }
+        FXL_LOG(INFO) << "Captured a slow frame to " << path << ".skp";
+      });
+
+  // When trace events are being recorded, the ones that led up to the frame
+  // are written next to it. They are kept for the next trace written on
+  // request.
+  if (fml::tracing::IsRecording()) {
+    TraceExporter::Get().WriteCopy(path + ".json", nullptr);
+  }
+}
+
 static sk_sp<SkSurface> CreateSnapshotSurface(GrContext* surface_context,
                                               const SkISize& size) {
   const auto image_info = SkImageInfo::MakeN32Premul(size);
@@ -221,7 +356,8 @@ Rasterizer::Screenshot Rasterizer::ScreenshotLastLayerTree(
 
   switch (type) {
     case ScreenshotType::SkiaPicture:
-      data = ScreenshotLayerTreeAsPicture(layer_tree, *compositor_context_)
+      data = ScreenshotLayerTreeAsPicture(layer_tree, *compositor_context_,
+                                          last_layer_timings_.get())
                  ->serialize();
       break;
     case ScreenshotType::UncompressedImage:
@@ -253,6 +389,33 @@ void Rasterizer::SetNextFrameCallback(fxl::Closure callback) {
   next_frame_callback_ = callback;
 }
 
+void Rasterizer::SetSlowFrameCaptureDirectory(std::string directory) {
+  slow_frame_capture_directory_ = std::move(directory);
+}
+
+void Rasterizer::SetLayerProfilingEnabled(bool enabled) {
+  if (enabled && !layer_profiling_enabled_) {
+    layer_profile_.Reset();
+  }
+  layer_profiling_enabled_ = enabled;
+}
+
+bool Rasterizer::IsLayerProfilingEnabled() const {
+  return layer_profiling_enabled_;
+}
+
+const flow::LayerProfile& Rasterizer::GetLayerProfile() const {
+  return layer_profile_;
+}
+
+const flow::LayerTimings* Rasterizer::GetLastLayerTimings() const {
+  return last_layer_timings_.get();
+}
+
+void Rasterizer::SetFrameTimings(std::shared_ptr<FrameTimings> frame_timings) {
+  frame_timings_ = std::move(frame_timings);
+}
+
 void Rasterizer::FireNextFrameCallbackIfPresent() {
   if (!next_frame_callback_) {
     return;
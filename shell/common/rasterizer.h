@@ -6,11 +6,15 @@
 #define SHELL_COMMON_RASTERIZER_H_
 
 #include <memory>
+#include <string>
 
 #include "flutter/common/task_runners.h"
 #include "flutter/flow/compositor_context.h"
+#include "flutter/flow/layer_profile.h"
+#include "flutter/flow/layer_timings.h"
 #include "flutter/flow/layers/layer_tree.h"
 #include "flutter/fml/memory/weak_ptr.h"
+#include "flutter/shell/common/frame_timings.h"
 #include "flutter/shell/common/surface.h"
 #include "flutter/synchronization/pipeline.h"
 #include "lib/fxl/functional/closure.h"
@@ -41,6 +45,10 @@ class Rasterizer final {
 
   void Draw(fxl::RefPtr<flutter::Pipeline<flow::LayerTree>> pipeline);
 
+  flow::CompositorContext* compositor_context() {
+    return compositor_context_.get();
+  }
+
   enum class ScreenshotType {
     SkiaPicture,
     UncompressedImage,  // In kN32_SkColorType format
@@ -63,12 +71,39 @@ class Rasterizer final {
   // the surface on the GPU task runner.
   void SetNextFrameCallback(fxl::Closure callback);
 
+  // Sets the directory to which frames whose raster time exceeds the
+  // rasterizer tracing threshold of their layer tree are written. Each such
+  // frame is written as an SKP, next to a text file with the time each of its
+  // layers took to preroll and paint. Slow frames are not captured if empty.
+  void SetSlowFrameCaptureDirectory(std::string directory);
+
+  // Times the layers of the frames drawn while enabled and sums their times
+  // into the layer profile. Enabling profiling resets the profile.
+  void SetLayerProfilingEnabled(bool enabled);
+
+  bool IsLayerProfilingEnabled() const;
+
+  const flow::LayerProfile& GetLayerProfile() const;
+
+  // The layer timings of the last layer tree, if it was drawn while
+  // profiling. SKP screenshots of the tree carry these as an annotation.
+  const flow::LayerTimings* GetLastLayerTimings() const;
+
+  // Sets the timings in which the raster time of each frame built for a vsync
+  // pulse is recorded. Redraws of the last layer tree are not recorded.
+  void SetFrameTimings(std::shared_ptr<FrameTimings> frame_timings);
+
  private:
   blink::TaskRunners task_runners_;
   std::unique_ptr<Surface> surface_;
   std::unique_ptr<flow::CompositorContext> compositor_context_;
   std::unique_ptr<flow::LayerTree> last_layer_tree_;
   fxl::Closure next_frame_callback_;
+  std::string slow_frame_capture_directory_;
+  bool layer_profiling_enabled_ = false;
+  flow::LayerProfile layer_profile_;
+  std::unique_ptr<flow::LayerTimings> last_layer_timings_;
+  std::shared_ptr<FrameTimings> frame_timings_;
   fml::WeakPtrFactory<Rasterizer> weak_factory_;
 
   void DoDraw(std::unique_ptr<flow::LayerTree> layer_tree);
@@ -77,6 +112,10 @@ class Rasterizer final {
 
   void FireNextFrameCallbackIfPresent();
 
+  void CaptureSlowFrame(flow::LayerTree& layer_tree,
+                        fxl::TimeDelta raster_time,
+                        const flow::LayerTimings& layer_timings);
+
   FXL_DISALLOW_COPY_AND_ASSIGN(Rasterizer);
 };
 
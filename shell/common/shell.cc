@@ -6,8 +6,11 @@
 
 #include "flutter/shell/common/shell.h"
 
+#include <algorithm>
+#include <map>
 #include <memory>
 #include <sstream>
+#include <thread>
 #include <vector>
 
 #include "flutter/assets/directory_asset_bundle.h"
@@ -16,12 +19,14 @@
 #include "flutter/fml/log_settings.h"
 #include "flutter/fml/logging.h"
 #include "flutter/fml/message_loop.h"
-#include "flutter/glue/trace_event.h"
+#include "flutter/fml/trace_event.h"
+#include "flutter/lib/ui/text/font_collection.h"
 #include "flutter/runtime/dart_vm.h"
 #include "flutter/runtime/start_up.h"
 #include "flutter/shell/common/engine.h"
 #include "flutter/shell/common/skia_event_tracer_impl.h"
 #include "flutter/shell/common/switches.h"
+#include "flutter/shell/common/trace_exporter.h"
 #include "flutter/shell/common/vsync_waiter.h"
 #include "lib/fxl/files/path.h"
 #include "lib/fxl/files/unique_fd.h"
@@ -43,66 +48,141 @@ std::unique_ptr<Shell> Shell::CreateShellOnPlatformThread(
     fxl::RefPtr<blink::DartSnapshot> isolate_snapshot,
     fxl::RefPtr<blink::DartSnapshot> shared_snapshot,
     Shell::CreateCallback<PlatformView> on_create_platform_view,
-    Shell::CreateCallback<Rasterizer> on_create_rasterizer) {
+    Shell::CreateCallback<Rasterizer> on_create_rasterizer,
+    std::shared_ptr<IOManager> shared_io_manager) {
   if (!task_runners.IsValid()) {
     return nullptr;
   }
 
   auto shell = std::unique_ptr<Shell>(new Shell(task_runners, settings));
 
+  // The subsystems are created as a dependency graph so that the phases that
+  // don't depend on each other overlap on their threads:
+  //
+  //   platform view -> vsync waiter -----------------+
+  //   platform view -> IO manager (resource context) -+-> engine -> fonts
+  //   Dart VM & ICU data ------------------------------+
+  //   rasterizer
+  //
+  // Every task below captures locals by reference, so this function must wait
+  // for all of them before returning, even when a phase fails.
+
+  // Create the rasterizer on the GPU thread. It depends on nothing else.
+  fxl::AutoResetWaitableEvent gpu_latch;
+  std::unique_ptr<Rasterizer> rasterizer;
+  fml::TaskRunner::RunNowOrPostTask(
+      task_runners.GetGPUTaskRunner(), [&gpu_latch,            //
+                                        &rasterizer,           //
+                                        on_create_rasterizer,  //
+                                        shell = shell.get()    //
+  ]() {
+        StartupTimeline::ScopedPhase phase(shell->startup_timeline_,
+                                           "Rasterizer");
+        if (auto new_rasterizer = on_create_rasterizer(*shell)) {
+          new_rasterizer->SetSlowFrameCaptureDirectory(
+              shell->GetSettings().temp_directory_path);
+          new_rasterizer->SetFrameTimings(shell->frame_timings_);
+          rasterizer = std::move(new_rasterizer);
+        }
+        gpu_latch.Signal();
+      });
+
+  // Initialize the Dart VM, mapping its snapshots, on the UI thread while the
+  // platform view is being created on this one. The ICU data is being loaded
+  // in the background since the process was initialized and is waited for
+  // here as the engine is the first to need it.
+  fxl::AutoResetWaitableEvent vm_latch;
+  fxl::RefPtr<blink::DartVM> vm;
+  fml::TaskRunner::RunNowOrPostTask(
+      task_runners.GetUITaskRunner(),
+      [&vm_latch, &vm, shell = shell.get()]() {
+        {
+          StartupTimeline::ScopedPhase phase(shell->startup_timeline_,
+                                             "DartVM");
+          vm = blink::DartVM::ForProcess(shell->GetSettings());
+        }
+        const auto& icu_data_path = shell->GetSettings().icu_data_path;
+        if (icu_data_path.size() != 0) {
+          StartupTimeline::ScopedPhase phase(shell->startup_timeline_, "ICU");
+          fml::icu::InitializeICU(icu_data_path);
+        }
+        vm_latch.Signal();
+      });
+
+  auto wait_for_pending_phases = [&gpu_latch, &vm_latch]() {
+    gpu_latch.Wait();
+    vm_latch.Wait();
+  };
+
   // Create the platform view on the platform thread (this thread).
-  auto platform_view = on_create_platform_view(*shell.get());
+  std::unique_ptr<PlatformView> platform_view;
+  {
+    StartupTimeline::ScopedPhase phase(shell->startup_timeline_,
+                                       "PlatformView");
+    platform_view = on_create_platform_view(*shell.get());
+  }
   if (!platform_view || !platform_view->GetWeakPtr()) {
+    wait_for_pending_phases();
     return nullptr;
   }
 
   // Ask the platform view for the vsync waiter. This will be used by the engine
   // to create the animator.
-  auto vsync_waiter = platform_view->CreateVSyncWaiter();
+  std::unique_ptr<VsyncWaiter> vsync_waiter;
+  {
+    StartupTimeline::ScopedPhase phase(shell->startup_timeline_,
+                                       "VsyncWaiter");
+    vsync_waiter = platform_view->CreateVSyncWaiter();
+  }
   if (!vsync_waiter) {
+    wait_for_pending_phases();
     return nullptr;
   }
 
-  // Create the IO manager on the IO thread. The IO manager must be initialized
-  // first because it has state that the other subsystems depend on. It must
-  // first be booted and the necessary references obtained to initialize the
-  // other subsystems.
+  // Create the IO manager on the IO thread. The engine needs the resource
+  // context and the unref queue it holds.
+  // A shared IO manager already holds the resource context, so the platform
+  // view is not asked for another one.
   fxl::AutoResetWaitableEvent io_latch;
-  std::unique_ptr<IOManager> io_manager;
+  std::shared_ptr<IOManager> io_manager = std::move(shared_io_manager);
   fml::WeakPtr<GrContext> resource_context;
   fxl::RefPtr<flow::SkiaUnrefQueue> unref_queue;
   auto io_task_runner = shell->GetTaskRunners().GetIOTaskRunner();
   fml::TaskRunner::RunNowOrPostTask(
       io_task_runner,
-      [&io_latch,          //
-       &io_manager,        //
-       &resource_context,  //
-       &unref_queue,       //
-       &platform_view,     //
-       io_task_runner      //
+      [&io_latch,           //
+       &io_manager,         //
+       &resource_context,   //
+       &unref_queue,        //
+       &platform_view,      //
+       io_task_runner,      //
+       shell = shell.get()  //
   ]() {
-        io_manager = std::make_unique<IOManager>(
-            platform_view->CreateResourceContext(), io_task_runner);
+        StartupTimeline::ScopedPhase phase(shell->startup_timeline_,
+                                           "IOManager");
+        if (!io_manager) {
+          io_manager = std::make_shared<IOManager>(
+              platform_view->CreateResourceContext(), io_task_runner);
+        }
         resource_context = io_manager->GetResourceContext();
         unref_queue = io_manager->GetSkiaUnrefQueue();
         io_latch.Signal();
       });
   io_latch.Wait();
 
-  // Create the rasterizer on the GPU thread.
-  fxl::AutoResetWaitableEvent gpu_latch;
-  std::unique_ptr<Rasterizer> rasterizer;
-  fml::TaskRunner::RunNowOrPostTask(
-      task_runners.GetGPUTaskRunner(), [&gpu_latch,            //
-                                        &rasterizer,           //
-                                        on_create_rasterizer,  //
-                                        shell = shell.get()    //
-  ]() {
-        if (auto new_rasterizer = on_create_rasterizer(*shell)) {
-          rasterizer = std::move(new_rasterizer);
-        }
-        gpu_latch.Signal();
-      });
+  vm_latch.Wait();
+  if (!vm) {
+    FXL_LOG(ERROR) << "Could not initialize the Dart VM.";
+    gpu_latch.Wait();
+    return nullptr;
+  }
+  shell->vm_ = vm;
+
+  // Without an explicit isolate snapshot, the one of the VM is shared with the
+  // service isolate.
+  if (!isolate_snapshot) {
+    isolate_snapshot = vm->GetIsolateSnapshot();
+  }
 
   // Create the engine on the UI thread.
   fxl::AutoResetWaitableEvent ui_latch;
@@ -118,12 +198,18 @@ std::unique_ptr<Shell> Shell::CreateShellOnPlatformThread(
                          resource_context = std::move(resource_context),  //
                          unref_queue = std::move(unref_queue)             //
   ]() mutable {
+        StartupTimeline::ScopedPhase phase(shell->startup_timeline_, "Engine");
         const auto& task_runners = shell->GetTaskRunners();
 
+        // The vsync waiter is only configured on the UI thread, which drives
+        // it from here on.
+        vsync_waiter->SetRefreshRate(shell->GetSettings().vsync_refresh_rate);
+
         // The animator is owned by the UI thread but it gets its vsync pulses
         // from the platform.
         auto animator = std::make_unique<Animator>(*shell, task_runners,
-                                                   std::move(vsync_waiter));
+                                                   std::move(vsync_waiter),
+                                                   shell->frame_timings_);
 
         engine = std::make_unique<Engine>(*shell,                       //
                                           shell->GetDartVM(),           //
@@ -135,6 +221,9 @@ std::unique_ptr<Shell> Shell::CreateShellOnPlatformThread(
                                           std::move(resource_context),  //
                                           std::move(unref_queue)        //
         );
+        // Load the configured fonts into the font collection of the engine
+        // while the rest of the shell is set up and the isolate is launched.
+        shell->PrewarmFonts(engine->GetFontCollection().GetFontCollection());
         ui_latch.Signal();
       }));
 
@@ -151,6 +240,11 @@ std::unique_ptr<Shell> Shell::CreateShellOnPlatformThread(
     return nullptr;
   }
 
+  if (shell->settings_.trace_startup) {
+    FXL_LOG(INFO) << "Shell startup phases:" << std::endl
+                  << shell->startup_timeline_.ToString();
+  }
+
   return shell;
 }
 
@@ -187,6 +281,13 @@ static void PerformInitializationTasks(const blink::Settings& settings) {
       fml::SetLogSettings(log_settings);
     }
 
+    fml::tracing::SetEnabledCategories(settings.trace_categories);
+
+    if (settings.trace_export_path.size() != 0) {
+      TraceExporter::Get().Start();
+      TraceExporter::Get().WriteOnSignal(settings.trace_export_path);
+    }
+
     if (settings.trace_skia) {
       InitSkiaEventTracer(settings.trace_skia);
     }
@@ -198,26 +299,28 @@ static void PerformInitializationTasks(const blink::Settings& settings) {
     }
 
     if (settings.icu_data_path.size() != 0) {
-      fml::icu::InitializeICU(settings.icu_data_path);
+      // Map the ICU data in the background. Everything that uses ICU in a
+      // shell, the font warm-up and the engine, waits for it first.
+      std::thread([icu_data_path = settings.icu_data_path]() {
+        TRACE_EVENT0("flutter", "InitializeICU");
+        fml::icu::InitializeICU(icu_data_path);
+      }).detach();
     } else {
       FXL_DLOG(WARNING) << "Skipping ICU initialization in the shell.";
     }
   });
 }
 
-
-  std::unique_ptr<Shell> Shell::Create(
+std::unique_ptr<Shell> Shell::Create(
     blink::TaskRunners task_runners,
     blink::Settings settings,
     Shell::CreateCallback<PlatformView> on_create_platform_view,
     Shell::CreateCallback<Rasterizer> on_create_rasterizer) {
   PerformInitializationTasks(settings);
 
-  auto vm = blink::DartVM::ForProcess(settings);
-  FXL_CHECK(vm) << "Must be able to initialize the VM.";
   return Shell::Create(std::move(task_runners),             //
                        std::move(settings),                 //
-                       vm->GetIsolateSnapshot(),            //
+                       nullptr,                             // from the VM
                        blink::DartSnapshot::Empty(),        //
                        std::move(on_create_platform_view),  //
                        std::move(on_create_rasterizer)      //
@@ -231,6 +334,59 @@ std::unique_ptr<Shell> Shell::Create(
     fxl::RefPtr<blink::DartSnapshot> shared_snapshot,
     Shell::CreateCallback<PlatformView> on_create_platform_view,
     Shell::CreateCallback<Rasterizer> on_create_rasterizer) {
+  return CreateShell(std::move(task_runners),             //
+                     std::move(settings),                 //
+                     std::move(isolate_snapshot),         //
+                     std::move(shared_snapshot),          //
+                     std::move(on_create_platform_view),  //
+                     std::move(on_create_rasterizer),     //
+                     nullptr                              // io manager
+  );
+}
+
+std::unique_ptr<Shell> Shell::CreateSharingResources(
+    Shell& resource_shell,
+    blink::TaskRunners task_runners,
+    blink::Settings settings,
+    Shell::CreateCallback<PlatformView> on_create_platform_view,
+    Shell::CreateCallback<Rasterizer> on_create_rasterizer) {
+  if (!resource_shell.IsSetup() || !task_runners.IsValid() ||
+      task_runners.GetIOTaskRunner().get() !=
+          resource_shell.GetTaskRunners().GetIOTaskRunner().get()) {
+    FXL_LOG(ERROR) << "Shells sharing resources must be set up and use the "
+                      "same IO task runner.";
+    return nullptr;
+  }
+
+  PerformInitializationTasks(settings);
+
+  auto shell = CreateShell(std::move(task_runners),             //
+                           std::move(settings),                 //
+                           nullptr,                             // from the VM
+                           blink::DartSnapshot::Empty(),        //
+                           std::move(on_create_platform_view),  //
+                           std::move(on_create_rasterizer),     //
+                           resource_shell.io_manager_           // io manager
+  );
+  if (shell) {
+    // The resources a sharing shell passes on belong to its resource shell.
+    Shell* owner = resource_shell.resource_shell_ != nullptr
+                       ? resource_shell.resource_shell_
+                       : &resource_shell;
+    owner->sharing_shell_count_.fetch_add(1);
+    shell->resource_shell_ = owner;
+  }
+  return shell;
+}
+
+std::unique_ptr<Shell> Shell::CreateShell(
+    blink::TaskRunners task_runners,
+    blink::Settings settings,
+    fxl::RefPtr<blink::DartSnapshot> isolate_snapshot,
+    fxl::RefPtr<blink::DartSnapshot> shared_snapshot,
+    Shell::CreateCallback<PlatformView> on_create_platform_view,
+    Shell::CreateCallback<Rasterizer> on_create_rasterizer,
+    std::shared_ptr<IOManager> shared_io_manager) {
   PerformInitializationTasks(settings);
 
   if (!task_runners.IsValid() || !on_create_platform_view ||
@@ -242,21 +398,23 @@ std::unique_ptr<Shell> Shell::Create(
   std::unique_ptr<Shell> shell;
   fml::TaskRunner::RunNowOrPostTask(
       task_runners.GetPlatformTaskRunner(),
-      [&latch,                                          //
-       &shell,                                          //
-       task_runners = std::move(task_runners),          //
-       settings,                                        //
-       isolate_snapshot = std::move(isolate_snapshot),  //
-       shared_snapshot = std::move(shared_snapshot),    //
-       on_create_platform_view,                         //
-       on_create_rasterizer                             //
+      [&latch,                                            //
+       &shell,                                            //
+       task_runners = std::move(task_runners),            //
+       settings,                                          //
+       isolate_snapshot = std::move(isolate_snapshot),    //
+       shared_snapshot = std::move(shared_snapshot),      //
+       on_create_platform_view,                           //
+       on_create_rasterizer,                              //
+       shared_io_manager = std::move(shared_io_manager)  //
   ]() {
         shell = CreateShellOnPlatformThread(std::move(task_runners),      //
                                             settings,                     //
                                             std::move(isolate_snapshot),  //
                                             std::move(shared_snapshot),   //
                                             on_create_platform_view,      //
-                                            on_create_rasterizer          //
+                                            on_create_rasterizer,         //
+                                            shared_io_manager             //
         );
         latch.Signal();
       });
@@ -267,7 +425,9 @@ std::unique_ptr<Shell> Shell::Create(
 Shell::Shell(blink::TaskRunners task_runners, blink::Settings settings)
     : task_runners_(std::move(task_runners)),
       settings_(std::move(settings)),
-      vm_(blink::DartVM::ForProcess(settings_)) {
+      frame_timings_(std::make_shared<FrameTimings>()),
+      platform_message_queue_(std::make_shared<PlatformMessageQueue>(
+          settings_.latest_value_platform_channels)) {
   FXL_DCHECK(task_runners_.IsValid());
   FXL_DCHECK(task_runners_.GetPlatformTaskRunner()->RunsTasksOnCurrentThread());
 
@@ -298,13 +458,33 @@ Shell::Shell(blink::TaskRunners task_runners, blink::Settings settings)
           task_runners_.GetUITaskRunner(),
           std::bind(&Shell::OnServiceProtocolSetAssetBundlePath, this,
                     std::placeholders::_1, std::placeholders::_2)};
+  service_protocol_handlers_
+      [blink::ServiceProtocol::kSetLayerProfilingEnabledExtensionName
+           .ToString()] = {
+          task_runners_.GetGPUTaskRunner(),
+          std::bind(&Shell::OnServiceProtocolSetLayerProfilingEnabled, this,
+                    std::placeholders::_1, std::placeholders::_2)};
+  service_protocol_handlers_
+      [blink::ServiceProtocol::kGetLayerProfileExtensionName.ToString()] = {
+          task_runners_.GetGPUTaskRunner(),
+          std::bind(&Shell::OnServiceProtocolGetLayerProfile, this,
+                    std::placeholders::_1, std::placeholders::_2)};
 }
 
 Shell::~Shell() {
+  FXL_CHECK(sharing_shell_count_.load() == 0)
+      << "A shell was destroyed before the shells sharing its resources.";
+  if (resource_shell_ != nullptr) {
+    resource_shell_->sharing_shell_count_.fetch_sub(1);
+  }
+
   if (auto vm = blink::DartVM::ForProcessIfInitialized()) {
     vm->GetServiceProtocol().RemoveHandler(this);
   }
 
+  // Wait for any font warm-up still in progress.
+  font_prewarm_thread_.reset();
+
   fxl::AutoResetWaitableEvent ui_latch, gpu_latch, platform_latch, io_latch;
 
   fml::TaskRunner::RunNowOrPostTask(
@@ -328,6 +508,7 @@ Shell::~Shell() {
       task_runners_.GetIOTaskRunner(),
       fxl::MakeCopyable(
           [io_manager = std::move(io_manager_), &io_latch]() mutable {
+            // Only the last of the shells sharing the IO manager collects it.
             io_manager.reset();
             io_latch.Signal();
           }));
@@ -351,10 +532,32 @@ bool Shell::IsSetup() const {
   return is_setup_;
 }
 
+void Shell::PrewarmFonts(std::shared_ptr<txt::FontCollection> collection) {
+  if (settings_.prewarm_font_families.empty()) {
+    return;
+  }
+
+  font_prewarm_thread_ = std::make_unique<fml::Thread>("io.flutter.fonts");
+  font_prewarm_thread_->GetTaskRunner()->PostTask(
+      [this,  // joined in the destructor
+       collection = std::move(collection),
+       families = settings_.prewarm_font_families,
+       locales = settings_.prewarm_font_locales,
+       icu_data_path = settings_.icu_data_path]() {
+        // Laying out the warm-up paragraphs uses ICU, whose data may still be
+        // being mapped in the background. This waits for it.
+        if (icu_data_path.size() != 0) {
+          fml::icu::InitializeICU(icu_data_path);
+        }
+        StartupTimeline::ScopedPhase phase(startup_timeline_, "FontPrewarm");
+        blink::FontCollection::Prewarm(collection, families, locales);
+      });
+}
+
 bool Shell::Setup(std::unique_ptr<PlatformView> platform_view,
                   std::unique_ptr<Engine> engine,
                   std::unique_ptr<Rasterizer> rasterizer,
-                  std::unique_ptr<IOManager> io_manager) {
+                  std::shared_ptr<IOManager> io_manager) {
   if (is_setup_) {
     return false;
   }
@@ -400,6 +603,14 @@ fml::WeakPtr<PlatformView> Shell::GetPlatformView() {
   return platform_view_->GetWeakPtr();
 }
 
+const StartupTimeline& Shell::GetStartupTimeline() const {
+  return startup_timeline_;
+}
+
+FrameTimings& Shell::GetFrameTimings() const {
+  return *frame_timings_;
+}
+
 blink::DartVM& Shell::GetDartVM() const {
   return *vm_;
 }
@@ -519,10 +730,17 @@ void Shell::OnPlatformViewDispatchPlatformMessage(
   FXL_DCHECK(&view == platform_view_.get());
   FXL_DCHECK(task_runners_.GetPlatformTaskRunner()->RunsTasksOnCurrentThread());
 
+  // Messages that arrive before the UI thread gets to the pending ones are
+  // dispatched along with them.
+  if (!platform_message_queue_->Push(std::move(message))) {
+    return;
+  }
+
   task_runners_.GetUITaskRunner()->PostTask(
-      [engine = engine_->GetWeakPtr(), message = std::move(message)] {
+      [engine = engine_->GetWeakPtr(), queue = platform_message_queue_] {
+        auto messages = queue->TakeAll();
         if (engine) {
-          engine->DispatchPlatformMessage(std::move(message));
+          engine->DispatchPlatformMessages(std::move(messages));
         }
       });
 }
@@ -535,9 +753,9 @@ void Shell::OnPlatformViewDispatchPointerDataPacket(
   FXL_DCHECK(&view == platform_view_.get());
   FXL_DCHECK(task_runners_.GetPlatformTaskRunner()->RunsTasksOnCurrentThread());
   task_runners_.GetUITaskRunner()->PostTask(fxl::MakeCopyable(
-      [engine = engine_->GetWeakPtr(), packet = std::move(packet)] {
+      [engine = engine_->GetWeakPtr(), packet = std::move(packet)]() mutable {
         if (engine) {
-          engine->DispatchPointerDataPacket(*packet);
+          engine->DispatchPointerDataPacket(std::move(packet));
         }
       }));
 }
@@ -686,9 +904,19 @@ void Shell::OnAnimatorDraw(
 
   task_runners_.GetGPUTaskRunner()->PostTask(
       [rasterizer = rasterizer_->GetWeakPtr(),
-       pipeline = std::move(pipeline)]() {
+       pipeline = std::move(pipeline), engine = engine_->GetWeakPtr(),
+       ui_task_runner = task_runners_.GetUITaskRunner()]() {
         if (rasterizer) {
+          const auto raster_start = fxl::TimePoint::Now();
           rasterizer->Draw(pipeline);
+          const auto raster_time = fxl::TimePoint::Now() - raster_start;
+          // Lets the vsync waiter pace frames to what the rasterizer can
+          // keep up with.
+          ui_task_runner->PostTask([engine, raster_time]() {
+            if (engine) {
+              engine->OnFrameRasterized(raster_time);
+            }
+          });
         }
       });
 }
@@ -953,6 +1181,130 @@ bool Shell::OnServiceProtocolSetAssetBundlePath(
   return false;
 }
 
+// Service protocol handler
+bool Shell::OnServiceProtocolSetLayerProfilingEnabled(
+    const blink::ServiceProtocol::Handler::ServiceProtocolMap& params,
+    rapidjson::Document& response) {
+  FXL_DCHECK(task_runners_.GetGPUTaskRunner()->RunsTasksOnCurrentThread());
+
+  if (params.count("enabled") == 0) {
+    ServiceProtocolParameterError(response, "'enabled' parameter is missing.");
+    return false;
+  }
+
+  const bool enabled = params.at("enabled") == "true";
+  rasterizer_->SetLayerProfilingEnabled(enabled);
+
+  auto& allocator = response.GetAllocator();
+  response.SetObject();
+  response.AddMember("type", "Success", allocator);
+  response.AddMember("enabled", enabled, allocator);
+  return true;
+}
+
+static void AddLayerProfileTotals(rapidjson::Value& value,
+                                  const flow::LayerProfile::Totals& totals,
+                                  rapidjson::MemoryPoolAllocator<>& allocator) {
+  value.AddMember("count", static_cast<uint64_t>(totals.count), allocator);
+  value.AddMember("prerollMicros", totals.preroll_time.ToMicroseconds(),
+                  allocator);
+  value.AddMember("paintMicros", totals.paint_time.ToMicroseconds(),
+                  allocator);
+  value.AddMember("rasterCacheMicros",
+                  totals.raster_cache_time.ToMicroseconds(), allocator);
+}
+
+template <class Key>
+static std::vector<std::pair<Key, flow::LayerProfile::Totals>>
+SortByDescendingTime(const std::map<Key, flow::LayerProfile::Totals>& totals) {
+  std::vector<std::pair<Key, flow::LayerProfile::Totals>> sorted(
+      totals.begin(), totals.end());
+  std::sort(sorted.begin(), sorted.end(), [](const auto& a, const auto& b) {
+    return a.second.preroll_time + a.second.paint_time +
+               a.second.raster_cache_time >
+           b.second.preroll_time + b.second.paint_time +
+               b.second.raster_cache_time;
+  });
+  return sorted;
+}
+
+// Service protocol handler
+bool Shell::OnServiceProtocolGetLayerProfile(
+    const blink::ServiceProtocol::Handler::ServiceProtocolMap& params,
+    rapidjson::Document& response) {
+  FXL_DCHECK(task_runners_.GetGPUTaskRunner()->RunsTasksOnCurrentThread());
+
+  const flow::LayerProfile& profile = rasterizer_->GetLayerProfile();
+
+  auto& allocator = response.GetAllocator();
+  response.SetObject();
+  response.AddMember("type", "LayerProfile", allocator);
+  response.AddMember("enabled", rasterizer_->IsLayerProfilingEnabled(),
+                     allocator);
+  response.AddMember("frameCount", static_cast<uint64_t>(profile.frame_count()),
+                     allocator);
+
+  // The time layers spent themselves, summed by type and by picture, most
+  // expensive first.
+  rapidjson::Value layer_types(rapidjson::kArrayType);
+  for (const auto& totals : SortByDescendingTime(profile.totals_by_type())) {
+    rapidjson::Value layer_type(rapidjson::kObjectType);
+    rapidjson::Value name(totals.first.c_str(), allocator);
+    layer_type.AddMember("layerType", name, allocator);
+    AddLayerProfileTotals(layer_type, totals.second, allocator);
+    layer_types.PushBack(layer_type, allocator);
+  }
+  response.AddMember("layerTypes", layer_types, allocator);
+
+  rapidjson::Value pictures(rapidjson::kArrayType);
+  for (const auto& totals :
+       SortByDescendingTime(profile.totals_by_picture())) {
+    rapidjson::Value picture(rapidjson::kObjectType);
+    picture.AddMember("pictureId", totals.first, allocator);
+    AddLayerProfileTotals(picture, totals.second, allocator);
+    pictures.PushBack(picture, allocator);
+  }
+  response.AddMember("pictures", pictures, allocator);
+
+  // The layers of the last frame in tree order. Their times include those of
+  // their children, which points at the expensive subtrees.
+  rapidjson::Value last_frame(rapidjson::kArrayType);
+  if (auto layer_timings = rasterizer_->GetLastLayerTimings()) {
+    for (const auto& entry : layer_timings->entries()) {
+      rapidjson::Value layer(rapidjson::kObjectType);
+      layer.AddMember("layerType", rapidjson::StringRef(entry.type_name),
+                      allocator);
+      layer.AddMember("depth", static_cast<uint64_t>(entry.depth), allocator);
+      if (entry.picture_id != 0) {
+        layer.AddMember("pictureId", entry.picture_id, allocator);
+      }
+      layer.AddMember("prerollMicros", entry.preroll_time.ToMicroseconds(),
+                      allocator);
+      layer.AddMember("paintMicros", entry.paint_time.ToMicroseconds(),
+                      allocator);
+      layer.AddMember("selfPrerollMicros",
+                      entry.self_preroll_time.ToMicroseconds(), allocator);
+      layer.AddMember("selfPaintMicros",
+                      entry.self_paint_time.ToMicroseconds(), allocator);
+      layer.AddMember("rasterCacheMicros",
+                      entry.raster_cache_time.ToMicroseconds(), allocator);
+      rapidjson::Value bounds(rapidjson::kArrayType);
+      bounds.PushBack(static_cast<double>(entry.paint_bounds.left()),
+                      allocator);
+      bounds.PushBack(static_cast<double>(entry.paint_bounds.top()),
+                      allocator);
+      bounds.PushBack(static_cast<double>(entry.paint_bounds.right()),
+                      allocator);
+      bounds.PushBack(static_cast<double>(entry.paint_bounds.bottom()),
+                      allocator);
+      layer.AddMember("paintBounds", bounds, allocator);
+      last_frame.PushBack(layer, allocator);
+    }
+  }
+  response.AddMember("lastFrame", last_frame, allocator);
+  return true;
+}
+
 Rasterizer::Screenshot Shell::Screenshot(
     Rasterizer::ScreenshotType screenshot_type,
     bool base64_encode) {
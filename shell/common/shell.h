@@ -5,7 +5,9 @@
 #ifndef SHELL_COMMON_SHELL_H_
 #define SHELL_COMMON_SHELL_H_
 
+#include <atomic>
 #include <functional>
+#include <memory>
 #include <unordered_map>
 
 #include "flutter/common/settings.h"
@@ -19,9 +21,12 @@
 #include "flutter/runtime/service_protocol.h"
 #include "flutter/shell/common/animator.h"
 #include "flutter/shell/common/engine.h"
+#include "flutter/shell/common/frame_timings.h"
 #include "flutter/shell/common/io_manager.h"
+#include "flutter/shell/common/platform_message_queue.h"
 #include "flutter/shell/common/platform_view.h"
 #include "flutter/shell/common/rasterizer.h"
+#include "flutter/shell/common/startup_timeline.h"
 #include "flutter/shell/common/surface.h"
 #include "lib/fxl/functional/closure.h"
 #include "lib/fxl/macros.h"
@@ -60,6 +65,24 @@ class Shell final : public PlatformView::Delegate,
       CreateCallback<PlatformView> on_create_platform_view,
       CreateCallback<Rasterizer> on_create_rasterizer);
 
+  // Creates a shell that shares the IO manager, and with it the resource
+  // context and the Skia unref queue, of a shell that is set up. Both shells
+  // must use the same IO task runner and usually share the GPU task runner as
+  // well, so that many shells in one process need only one GPU and one IO
+  // thread. The onscreen contexts of both platform views must be able to use
+  // the textures of the shared resource context.
+  //
+  // The resource context is made by the platform view of |resource_shell|,
+  // which owns the native context it draws with, so |resource_shell| must be
+  // destroyed after every shell that shares its resources. Destroying it
+  // first is a fatal error.
+  static std::unique_ptr<Shell> CreateSharingResources(
+      Shell& resource_shell,
+      blink::TaskRunners task_runners,
+      blink::Settings settings,
+      CreateCallback<PlatformView> on_create_platform_view,
+      CreateCallback<Rasterizer> on_create_rasterizer);
+
   ~Shell();
 
   const blink::Settings& GetSettings() const;
@@ -74,6 +97,14 @@ class Shell final : public PlatformView::Delegate,
 
   blink::DartVM& GetDartVM() const;
 
+  // The phases of the creation of this shell. Phases that ran concurrently
+  // overlap.
+  const StartupTimeline& GetStartupTimeline() const;
+
+  // The histograms of the times the frames of this shell took. They may be
+  // read and reset on any thread.
+  FrameTimings& GetFrameTimings() const;
+
   bool IsSetup() const;
 
   Rasterizer::Screenshot Screenshot(Rasterizer::ScreenshotType type,
@@ -86,11 +117,21 @@ class Shell final : public PlatformView::Delegate,
 
   const blink::TaskRunners task_runners_;
   const blink::Settings settings_;
-  fxl::RefPtr<blink::DartVM> vm_;
+  StartupTimeline startup_timeline_;
+  // Shared with the animator and the rasterizer that record frames in it.
+  const std::shared_ptr<FrameTimings> frame_timings_;
+  fxl::RefPtr<blink::DartVM> vm_;  // set once the VM is initialized
   std::unique_ptr<PlatformView> platform_view_;  // on platform task runner
   std::unique_ptr<Engine> engine_;               // on UI task runner
   std::unique_ptr<Rasterizer> rasterizer_;       // on GPU task runner
-  std::unique_ptr<IOManager> io_manager_;        // on IO task runner
+  std::shared_ptr<IOManager> io_manager_;        // on IO task runner
+  // The shell whose platform view made the resource context of a shared IO
+  // manager, and the number of shells sharing the resources of this one.
+  Shell* resource_shell_ = nullptr;
+  std::atomic<size_t> sharing_shell_count_ = {0};
+  std::unique_ptr<fml::Thread> font_prewarm_thread_;
+  // Shared with the UI tasks that drain it.
+  std::shared_ptr<PlatformMessageQueue> platform_message_queue_;
 
   std::unordered_map<std::string,  // method
                      std::pair<fxl::RefPtr<fxl::TaskRunner>,
@@ -102,18 +143,30 @@ class Shell final : public PlatformView::Delegate,
 
   Shell(blink::TaskRunners task_runners, blink::Settings settings);
 
+  static std::unique_ptr<Shell> CreateShell(
+      blink::TaskRunners task_runners,
+      blink::Settings settings,
+      fxl::RefPtr<blink::DartSnapshot> isolate_snapshot,
+      fxl::RefPtr<blink::DartSnapshot> shared_snapshot,
+      CreateCallback<PlatformView> on_create_platform_view,
+      CreateCallback<Rasterizer> on_create_rasterizer,
+      std::shared_ptr<IOManager> shared_io_manager);
+
   static std::unique_ptr<Shell> CreateShellOnPlatformThread(
       blink::TaskRunners task_runners,
       blink::Settings settings,
       fxl::RefPtr<blink::DartSnapshot> isolate_snapshot,
       fxl::RefPtr<blink::DartSnapshot> shared_snapshot,
       Shell::CreateCallback<PlatformView> on_create_platform_view,
-      Shell::CreateCallback<Rasterizer> on_create_rasterizer);
+      Shell::CreateCallback<Rasterizer> on_create_rasterizer,
+      std::shared_ptr<IOManager> shared_io_manager);
+
+  void PrewarmFonts(std::shared_ptr<txt::FontCollection> collection);
 
   bool Setup(std::unique_ptr<PlatformView> platform_view,
              std::unique_ptr<Engine> engine,
              std::unique_ptr<Rasterizer> rasterizer,
-             std::unique_ptr<IOManager> io_manager);
+             std::shared_ptr<IOManager> io_manager);
 
   // |shell::PlatformView::Delegate|
   void OnPlatformViewCreated(const PlatformView& view,
@@ -229,6 +282,16 @@ class Shell final : public PlatformView::Delegate,
       const blink::ServiceProtocol::Handler::ServiceProtocolMap& params,
       rapidjson::Document& response);
 
+  // Service protocol handler
+  bool OnServiceProtocolSetLayerProfilingEnabled(
+      const blink::ServiceProtocol::Handler::ServiceProtocolMap& params,
+      rapidjson::Document& response);
+
+  // Service protocol handler
+  bool OnServiceProtocolGetLayerProfile(
+      const blink::ServiceProtocol::Handler::ServiceProtocolMap& params,
+      rapidjson::Document& response);
+
   FXL_DISALLOW_COPY_AND_ASSIGN(Shell);
 };
 
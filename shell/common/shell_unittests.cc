@@ -7,14 +7,26 @@
 #include <functional>
 #include <future>
 #include <memory>
+#include <set>
+#include <string>
+#include <vector>
 
 #include "flutter/fml/message_loop.h"
+#include "flutter/fml/trace_event.h"
+#include "flutter/shell/common/frame_timings.h"
+#include "flutter/shell/common/platform_message_queue.h"
 #include "flutter/shell/common/platform_view.h"
+#include "flutter/shell/common/pointer_data_resampler.h"
 #include "flutter/shell/common/rasterizer.h"
 #include "flutter/shell/common/shell.h"
 #include "flutter/shell/common/thread_host.h"
+#include "flutter/shell/common/trace_exporter.h"
+#include "flutter/shell/common/vsync_waiter_fallback.h"
 #include "gtest/gtest.h"
+#include "lib/fxl/files/file.h"
+#include "lib/fxl/files/scoped_temp_dir.h"
 #include "lib/fxl/synchronization/waitable_event.h"
+#include "third_party/rapidjson/rapidjson/document.h"
 
 #define CURRENT_TEST_NAME                                           \
   std::string {                                                     \
@@ -125,4 +137,417 @@ TEST(ShellTest, InitializeWithMultipleThreadButCallingThreadAsPlatformThread) {
   ASSERT_TRUE(shell);
 }
 
+TEST(ShellTest, StartupTimelineRecordsEachPhase) {
+  blink::Settings settings = {};
+  settings.task_observer_add = [](intptr_t, fxl::Closure) {};
+  settings.task_observer_remove = [](intptr_t) {};
+  ThreadHost thread_host("io.flutter.test." + CURRENT_TEST_NAME + ".",
+                         ThreadHost::Type::Platform | ThreadHost::Type::GPU |
+                             ThreadHost::Type::IO | ThreadHost::Type::UI);
+  blink::TaskRunners task_runners("test",
+                                  thread_host.platform_thread->GetTaskRunner(),
+                                  thread_host.gpu_thread->GetTaskRunner(),
+                                  thread_host.ui_thread->GetTaskRunner(),
+                                  thread_host.io_thread->GetTaskRunner());
+  auto shell = Shell::Create(
+      std::move(task_runners), settings,
+      [](Shell& shell) {
+        return std::make_unique<PlatformView>(shell, shell.GetTaskRunners());
+      },
+      [](Shell& shell) {
+        return std::make_unique<Rasterizer>(shell.GetTaskRunners());
+      });
+  ASSERT_TRUE(shell);
+
+  std::set<std::string> phase_names;
+  for (const auto& phase : shell->GetStartupTimeline().GetPhases()) {
+    ASSERT_LE(phase.start, phase.end);
+    phase_names.insert(phase.name);
+  }
+  ASSERT_EQ(phase_names,
+            std::set<std::string>({"DartVM", "Engine", "IOManager",
+                                   "PlatformView", "Rasterizer",
+                                   "VsyncWaiter"}));
+}
+
+TEST(ShellTest, ShellsCanShareGPUAndIOThreads) {
+  blink::Settings settings = {};
+  settings.task_observer_add = [](intptr_t, fxl::Closure) {};
+  settings.task_observer_remove = [](intptr_t) {};
+  ThreadHost thread_host("io.flutter.test." + CURRENT_TEST_NAME + ".",
+                         ThreadHost::Type::Platform | ThreadHost::Type::GPU |
+                             ThreadHost::Type::IO);
+  ThreadHost first_ui_thread_host(
+      "io.flutter.test." + CURRENT_TEST_NAME + ".first.", ThreadHost::Type::UI);
+  ThreadHost second_ui_thread_host(
+      "io.flutter.test." + CURRENT_TEST_NAME + ".second.",
+      ThreadHost::Type::UI);
+  auto create_platform_view = [](Shell& shell) {
+    return std::make_unique<PlatformView>(shell, shell.GetTaskRunners());
+  };
+  auto create_rasterizer = [](Shell& shell) {
+    return std::make_unique<Rasterizer>(shell.GetTaskRunners());
+  };
+
+  auto first_shell = Shell::Create(
+      blink::TaskRunners("test", thread_host.platform_thread->GetTaskRunner(),
+                         thread_host.gpu_thread->GetTaskRunner(),
+                         first_ui_thread_host.ui_thread->GetTaskRunner(),
+                         thread_host.io_thread->GetTaskRunner()),
+      settings, create_platform_view, create_rasterizer);
+  ASSERT_TRUE(first_shell);
+
+  auto second_shell = Shell::CreateSharingResources(
+      *first_shell,
+      blink::TaskRunners("test", thread_host.platform_thread->GetTaskRunner(),
+                         thread_host.gpu_thread->GetTaskRunner(),
+                         second_ui_thread_host.ui_thread->GetTaskRunner(),
+                         thread_host.io_thread->GetTaskRunner()),
+      settings, create_platform_view, create_rasterizer);
+  ASSERT_TRUE(second_shell);
+
+  // The shell whose platform view created the resources goes last.
+  second_shell.reset();
+  first_shell.reset();
+}
+
+TEST(ShellTest, ShellsSharingResourcesMustShareTheIOThread) {
+  blink::Settings settings = {};
+  settings.task_observer_add = [](intptr_t, fxl::Closure) {};
+  settings.task_observer_remove = [](intptr_t) {};
+  ThreadHost thread_host("io.flutter.test." + CURRENT_TEST_NAME + ".",
+                         ThreadHost::Type::Platform | ThreadHost::Type::GPU |
+                             ThreadHost::Type::IO | ThreadHost::Type::UI);
+  ThreadHost other_io_thread_host(
+      "io.flutter.test." + CURRENT_TEST_NAME + ".other.", ThreadHost::Type::IO);
+  auto create_platform_view = [](Shell& shell) {
+    return std::make_unique<PlatformView>(shell, shell.GetTaskRunners());
+  };
+  auto create_rasterizer = [](Shell& shell) {
+    return std::make_unique<Rasterizer>(shell.GetTaskRunners());
+  };
+
+  auto first_shell = Shell::Create(
+      blink::TaskRunners("test", thread_host.platform_thread->GetTaskRunner(),
+                         thread_host.gpu_thread->GetTaskRunner(),
+                         thread_host.ui_thread->GetTaskRunner(),
+                         thread_host.io_thread->GetTaskRunner()),
+      settings, create_platform_view, create_rasterizer);
+  ASSERT_TRUE(first_shell);
+
+  auto second_shell = Shell::CreateSharingResources(
+      *first_shell,
+      blink::TaskRunners("test", thread_host.platform_thread->GetTaskRunner(),
+                         thread_host.gpu_thread->GetTaskRunner(),
+                         thread_host.ui_thread->GetTaskRunner(),
+                         other_io_thread_host.io_thread->GetTaskRunner()),
+      settings, create_platform_view, create_rasterizer);
+  ASSERT_FALSE(second_shell);
+}
+
+TEST(TraceExporterTest, WritesChromeTraceWithThreadNames) {
+  auto& exporter = TraceExporter::Get();
+  exporter.Start();
+  {
+    fml::Thread thread("io.flutter.test.trace_exporter");
+    fxl::AutoResetWaitableEvent latch;
+    thread.GetTaskRunner()->PostTask([&latch]() {
+      TRACE_EVENT0("flutter", "TraceExporterTestEvent");
+      latch.Signal();
+    });
+    latch.Wait();
+  }
+  exporter.Stop();
+
+  files::ScopedTempDir temp_dir;
+  std::string path;
+  ASSERT_TRUE(temp_dir.NewTempFile(&path));
+  fxl::AutoResetWaitableEvent latch;
+  bool written = false;
+  exporter.Write(path, [&](bool success) {
+    written = success;
+    latch.Signal();
+  });
+  latch.Wait();
+  ASSERT_TRUE(written);
+
+  std::string trace;
+  ASSERT_TRUE(files::ReadFileToString(path, &trace));
+  ASSERT_NE(trace.find("\"traceEvents\""), std::string::npos);
+  ASSERT_NE(trace.find("TraceExporterTestEvent"), std::string::npos);
+  ASSERT_NE(trace.find("io.flutter.test.trace_exporter"), std::string::npos);
+}
+
+TEST(TraceExporterTest, KeepsEventsWrittenAsACopy) {
+  auto& exporter = TraceExporter::Get();
+  exporter.Start();
+  {
+    fml::Thread thread("io.flutter.test.trace_exporter_copy");
+    fxl::AutoResetWaitableEvent latch;
+    thread.GetTaskRunner()->PostTask([&latch]() {
+      TRACE_EVENT0("flutter", "TraceExporterCopiedEvent");
+      latch.Signal();
+    });
+    latch.Wait();
+  }
+  exporter.Stop();
+
+  files::ScopedTempDir temp_dir;
+  auto write = [&](bool copy) {
+    std::string path;
+    EXPECT_TRUE(temp_dir.NewTempFile(&path));
+    fxl::AutoResetWaitableEvent latch;
+    auto callback = [&latch](bool success) {
+      EXPECT_TRUE(success);
+      latch.Signal();
+    };
+    if (copy) {
+      exporter.WriteCopy(path, callback);
+    } else {
+      exporter.Write(path, callback);
+    }
+    latch.Wait();
+    std::string trace;
+    EXPECT_TRUE(files::ReadFileToString(path, &trace));
+    return trace;
+  };
+
+  ASSERT_NE(write(true).find("TraceExporterCopiedEvent"), std::string::npos);
+  ASSERT_NE(write(false).find("TraceExporterCopiedEvent"), std::string::npos);
+  ASSERT_EQ(write(false).find("TraceExporterCopiedEvent"), std::string::npos);
+}
+
+TEST(TraceExporterTest, RepliesToMethodCallsInJSONEnvelopes) {
+  auto& exporter = TraceExporter::Get();
+  auto call = [&exporter](const std::string& json,
+                          const std::string& default_path) {
+    fxl::AutoResetWaitableEvent latch;
+    std::string reply;
+    exporter.HandleMethodCall(std::vector<uint8_t>(json.begin(), json.end()),
+                              default_path, [&](std::string envelope) {
+                                reply = std::move(envelope);
+                                latch.Signal();
+                              });
+    latch.Wait();
+    return reply;
+  };
+  auto decode = [](const std::string& reply) {
+    rapidjson::Document document;
+    document.Parse(reply.c_str(), reply.size());
+    EXPECT_FALSE(document.HasParseError());
+    EXPECT_TRUE(document.IsArray());
+    return document;
+  };
+
+  auto started = decode(call(R"({"method":"startRecording"})", ""));
+  ASSERT_EQ(started.Size(), 1u);
+  ASSERT_TRUE(started[0u].IsTrue());
+  auto stopped = decode(call(R"({"method":"stopRecording"})", ""));
+  ASSERT_EQ(stopped.Size(), 1u);
+  ASSERT_TRUE(stopped[0u].IsTrue());
+
+  files::ScopedTempDir temp_dir;
+  std::string path;
+  ASSERT_TRUE(temp_dir.NewTempFile(&path));
+  auto written = decode(call(R"({"method":"writeTrace"})", path));
+  ASSERT_EQ(written.Size(), 1u);
+  ASSERT_TRUE(written[0u].IsTrue());
+  std::string trace;
+  ASSERT_TRUE(files::ReadFileToString(path, &trace));
+  ASSERT_NE(trace.find("\"traceEvents\""), std::string::npos);
+
+  // Errors are [code, message, details].
+  auto no_path = decode(call(R"({"method":"writeTrace"})", ""));
+  ASSERT_EQ(no_path.Size(), 3u);
+  ASSERT_STREQ(no_path[0u].GetString(), "error");
+  ASSERT_TRUE(no_path[2u].IsNull());
+  auto malformed = decode(call("[1, 2]", ""));
+  ASSERT_EQ(malformed.Size(), 3u);
+  ASSERT_STREQ(malformed[0u].GetString(), "error");
+
+  // Methods that are not implemented get an empty reply.
+  ASSERT_TRUE(call(R"({"method":"unknown"})", "").empty());
+}
+
+TEST(FrameTimingsTest, ReportsPercentilesToTheBucket) {
+  FrameTimings timings;
+  for (int64_t i = 0; i < 100; i++) {
+    timings.RecordRasterTime(fxl::TimeDelta::FromMicroseconds(i * 100 + 50),
+                             i >= 95);
+  }
+  // Durations past the last bucket are reported as the maximum.
+  timings.RecordBuildTime(fxl::TimeDelta::FromMilliseconds(1));
+  timings.RecordBuildTime(fxl::TimeDelta::FromMilliseconds(60));
+
+  auto summary = timings.GetSummary();
+  ASSERT_EQ(summary.frame_count, 100u);
+  ASSERT_EQ(summary.missed_frame_count, 5u);
+  ASSERT_EQ(summary.raster_time.count, 100u);
+  ASSERT_EQ(summary.raster_time.p50.ToMicroseconds(), 5000);
+  ASSERT_EQ(summary.raster_time.p90.ToMicroseconds(), 9000);
+  ASSERT_EQ(summary.raster_time.p99.ToMicroseconds(), 9900);
+  ASSERT_EQ(summary.raster_time.max.ToMicroseconds(), 9950);
+  ASSERT_EQ(summary.build_time.count, 2u);
+  ASSERT_EQ(summary.build_time.p50.ToMicroseconds(), 1100);
+  ASSERT_EQ(summary.build_time.p99.ToMicroseconds(), 60000);
+  ASSERT_EQ(summary.vsync_latency.count, 0u);
+
+  timings.Reset();
+  summary = timings.GetSummary();
+  ASSERT_EQ(summary.frame_count, 0u);
+  ASSERT_EQ(summary.missed_frame_count, 0u);
+  ASSERT_EQ(summary.build_time.max.ToMicroseconds(), 0);
+}
+
+TEST(FrameTimingsTest, RepliesToMethodCallsInJSONEnvelopes) {
+  FrameTimings timings;
+  timings.RecordRasterTime(fxl::TimeDelta::FromMilliseconds(2), true);
+  auto call = [&timings](std::string json) {
+    std::string reply = timings.HandleMethodCall(
+        std::vector<uint8_t>(json.begin(), json.end()));
+    auto document = std::make_unique<rapidjson::Document>();
+    if (!reply.empty()) {
+      document->Parse(reply.c_str(), reply.size());
+    }
+    return document;
+  };
+
+  auto reply = call("{\"method\":\"get\",\"args\":null}");
+  ASSERT_TRUE(reply->IsArray());
+  ASSERT_EQ(reply->Size(), 1u);
+  const auto& summary = (*reply)[0u];
+  ASSERT_TRUE(summary.IsObject());
+  ASSERT_EQ(summary["frameCount"].GetUint64(), 1u);
+  ASSERT_EQ(summary["missedFrameCount"].GetUint64(), 1u);
+  ASSERT_EQ(summary["rasterTime"]["maxMicros"].GetInt64(), 2000);
+  ASSERT_EQ(summary["buildTime"]["count"].GetUint64(), 0u);
+
+  reply = call("{\"method\":\"reset\"}");
+  ASSERT_TRUE(reply->IsArray());
+  ASSERT_TRUE((*reply)[0u].IsNull());
+  ASSERT_EQ(timings.GetSummary().frame_count, 0u);
+
+  // Methods that are not implemented get an empty reply.
+  std::string unknown = "{\"method\":\"unknown\"}";
+  ASSERT_TRUE(
+      timings
+          .HandleMethodCall(std::vector<uint8_t>(unknown.begin(), unknown.end()))
+          .empty());
+
+  // Malformed calls get an error envelope.
+  reply = call("not json");
+  ASSERT_TRUE(reply->IsArray());
+  ASSERT_EQ(reply->Size(), 3u);
+  ASSERT_STREQ((*reply)[0u].GetString(), "error");
+  ASSERT_TRUE((*reply)[2u].IsNull());
+}
+
+TEST(PlatformMessageQueueTest, KeepsOnlyLatestValueOnCoalescedChannels) {
+  PlatformMessageQueue queue({"sensor"});
+  auto message = [](std::string channel, uint8_t value) {
+    return fxl::MakeRefCounted<blink::PlatformMessage>(
+        std::move(channel), std::vector<uint8_t>{value}, nullptr);
+  };
+
+  ASSERT_TRUE(queue.Push(message("sensor", 1)));
+  ASSERT_FALSE(queue.Push(message("events", 2)));
+  ASSERT_FALSE(queue.Push(message("sensor", 3)));
+  ASSERT_FALSE(queue.Push(message("events", 4)));
+
+  // The latest sensor value keeps its place after the first event.
+  auto messages = queue.TakeAll();
+  ASSERT_EQ(messages.size(), 3u);
+  ASSERT_EQ(messages[0]->data()[0], 2);
+  ASSERT_EQ(messages[1]->channel(), "sensor");
+  ASSERT_EQ(messages[1]->data()[0], 3);
+  ASSERT_EQ(messages[2]->data()[0], 4);
+
+  // The queue is empty again, so the next push schedules another drain.
+  ASSERT_TRUE(queue.TakeAll().empty());
+  ASSERT_TRUE(queue.Push(message("sensor", 5)));
+}
+
+TEST(PointerDataResamplerTest, MergesMovesResampledToFrameTime) {
+  using Change = blink::PointerData::Change;
+  const std::vector<std::pair<Change, int64_t>> events = {
+      {Change::kDown, 0}, {Change::kMove, 8},  {Change::kMove, 16},
+      {Change::kMove, 24}, {Change::kUp, 32},
+  };
+  blink::PointerDataPacket packet(events.size());
+  for (size_t i = 0; i < events.size(); ++i) {
+    blink::PointerData data;
+    data.Clear();
+    data.change = events[i].first;
+    data.time_stamp = events[i].second;
+    data.physical_x = events[i].second;
+    packet.SetPointerData(i, data);
+  }
+
+  PointerDataResampler resampler;
+  resampler.Enqueue(packet);
+  auto delivered = resampler.TakeForFrame(20);
+  ASSERT_TRUE(delivered);
+  ASSERT_EQ(delivered->data().size(), 2 * sizeof(blink::PointerData));
+  const auto* first =
+      reinterpret_cast<const blink::PointerData*>(delivered->data().data());
+  ASSERT_EQ(first[0].change, Change::kDown);
+  ASSERT_EQ(first[1].change, Change::kMove);
+  ASSERT_EQ(first[1].time_stamp, 20);
+  ASSERT_DOUBLE_EQ(first[1].physical_x, 20.0);
+
+  // The move after the frame time and the up that follows it are kept.
+  ASSERT_TRUE(resampler.HasPendingData());
+  delivered = resampler.TakeForFrame(40);
+  ASSERT_EQ(delivered->data().size(), 2 * sizeof(blink::PointerData));
+  ASSERT_FALSE(resampler.HasPendingData());
+}
+
+TEST(VsyncWaiterFallbackTest, PacesFramesToRasterTime) {
+  ThreadHost thread_host("io.flutter.test." + CURRENT_TEST_NAME + ".",
+                         ThreadHost::Type::UI);
+  auto ui_task_runner = thread_host.ui_thread->GetTaskRunner();
+  blink::TaskRunners task_runners("test", ui_task_runner, ui_task_runner,
+                                  ui_task_runner, ui_task_runner);
+  VsyncWaiterFallback waiter(task_runners);
+
+  auto await_frame_interval = [&]() {
+    fxl::AutoResetWaitableEvent latch;
+    fxl::TimeDelta frame_interval;
+    ui_task_runner->PostTask([&]() {
+      waiter.AsyncWaitForVsync(
+          [&](fxl::TimePoint start_time, fxl::TimePoint target_time) {
+            frame_interval = target_time - start_time;
+            latch.Signal();
+          });
+    });
+    latch.Wait();
+    return frame_interval;
+  };
+
+  auto on_ui_thread = [&](fxl::Closure closure) {
+    fxl::AutoResetWaitableEvent latch;
+    ui_task_runner->PostTask([&]() {
+      closure();
+      latch.Signal();
+    });
+    latch.Wait();
+  };
+
+  const auto refresh_interval = fxl::TimeDelta::FromSecondsF(1.0 / 120.0);
+  on_ui_thread([&]() { waiter.SetRefreshRate(120.0); });
+  ASSERT_EQ(await_frame_interval(), refresh_interval);
+
+  // Rasterizing takes more than one but less than two refresh intervals.
+  on_ui_thread([&]() {
+    for (size_t i = 0; i < 10; i++) {
+      waiter.OnFrameRasterized(fxl::TimeDelta::FromMilliseconds(12));
+    }
+  });
+  ASSERT_EQ(await_frame_interval().ToNanoseconds(),
+            refresh_interval.ToNanoseconds() * 2);
+
+  on_ui_thread([&]() { waiter.SetRefreshRate(0.0); });
+  ASSERT_EQ(await_frame_interval(), fxl::TimeDelta::Zero());
+}
+
 }  // namespace shell
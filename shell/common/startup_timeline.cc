@@ -0,0 +1,52 @@
+// Copyright 2018 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/shell/common/startup_timeline.h"
+
+#include <iomanip>
+#include <sstream>
+
+namespace shell {
+
+StartupTimeline::ScopedPhase::ScopedPhase(StartupTimeline& timeline,
+                                          const char* name)
+    : timeline_(timeline),
+      name_(name),
+      start_(fxl::TimePoint::Now()),
+      trace_event_(fml::tracing::GetCategoryEnabledFlag("flutter"),
+                   "flutter",
+                   name) {}
+
+StartupTimeline::ScopedPhase::~ScopedPhase() {
+  timeline_.AddPhase(name_, start_, fxl::TimePoint::Now());
+}
+
+StartupTimeline::StartupTimeline() : origin_(fxl::TimePoint::Now()) {}
+
+StartupTimeline::~StartupTimeline() = default;
+
+void StartupTimeline::AddPhase(std::string name,
+                               fxl::TimePoint start,
+                               fxl::TimePoint end) {
+  std::lock_guard<std::mutex> lock(phases_mutex_);
+  phases_.push_back({std::move(name), start, end});
+}
+
+std::vector<StartupTimeline::Phase> StartupTimeline::GetPhases() const {
+  std::lock_guard<std::mutex> lock(phases_mutex_);
+  return phases_;
+}
+
+std::string StartupTimeline::ToString() const {
+  std::stringstream stream;
+  stream << std::fixed << std::setprecision(2);
+  for (const auto& phase : GetPhases()) {
+    stream << phase.name << ": " << (phase.start - origin_).ToMillisecondsF()
+           << " ms to " << (phase.end - origin_).ToMillisecondsF() << " ms"
+           << std::endl;
+  }
+  return stream.str();
+}
+
+}  // namespace shell
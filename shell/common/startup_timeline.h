@@ -0,0 +1,68 @@
+// Copyright 2018 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_SHELL_COMMON_STARTUP_TIMELINE_H_
+#define FLUTTER_SHELL_COMMON_STARTUP_TIMELINE_H_
+
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "flutter/fml/trace_event.h"
+#include "lib/fxl/macros.h"
+#include "lib/fxl/time/time_point.h"
+
+namespace shell {
+
+// Records when each phase of shell startup ran. Phases run concurrently on
+// different threads, so they are recorded from any thread.
+class StartupTimeline {
+ public:
+  struct Phase {
+    std::string name;
+    fxl::TimePoint start;
+    fxl::TimePoint end;
+  };
+
+  // Records the lifetime of the scope as a phase and as a trace event. The
+  // name must be a string literal.
+  class ScopedPhase {
+   public:
+    ScopedPhase(StartupTimeline& timeline, const char* name);
+
+    ~ScopedPhase();
+
+   private:
+    StartupTimeline& timeline_;
+    const char* name_;
+    const fxl::TimePoint start_;
+    fml::tracing::ScopedTraceEvent trace_event_;
+
+    FXL_DISALLOW_COPY_AND_ASSIGN(ScopedPhase);
+  };
+
+  StartupTimeline();
+
+  ~StartupTimeline();
+
+  void AddPhase(std::string name, fxl::TimePoint start, fxl::TimePoint end);
+
+  // The phases in the order they ended.
+  std::vector<Phase> GetPhases() const;
+
+  // One line per phase with its start and end relative to the creation of the
+  // timeline.
+  std::string ToString() const;
+
+ private:
+  const fxl::TimePoint origin_;
+  mutable std::mutex phases_mutex_;
+  std::vector<Phase> phases_;
+
+  FXL_DISALLOW_COPY_AND_ASSIGN(StartupTimeline);
+};
+
+}  // namespace shell
+
+#endif  // FLUTTER_SHELL_COMMON_STARTUP_TIMELINE_H_
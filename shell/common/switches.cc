@@ -8,6 +8,7 @@
 #include <iterator>
 #include <sstream>
 #include <string>
+#include <vector>
 
 #include "flutter/fml/paths.h"
 #include "lib/fxl/strings/string_view.h"
@@ -112,6 +113,19 @@ static bool GetSwitchValue(const fxl::CommandLine& command_line,
   return false;
 }
 
+static std::vector<std::string> SplitCommaSeparatedList(
+    const std::string& list) {
+  std::vector<std::string> result;
+  std::stringstream stream(list);
+  std::string item;
+  while (std::getline(stream, item, ',')) {
+    if (!item.empty()) {
+      result.push_back(item);
+    }
+  }
+  return result;
+}
+
 blink::Settings SettingsFromCommandLine(const fxl::CommandLine& command_line) {
   blink::Settings settings = {};
 
@@ -144,12 +158,33 @@ blink::Settings SettingsFromCommandLine(const fxl::CommandLine& command_line) {
   settings.enable_software_rendering =
       command_line.HasOption(FlagForSwitch(Switch::EnableSoftwareRendering));
 
+  settings.resample_pointer_events =
+      command_line.HasOption(FlagForSwitch(Switch::ResamplePointerEvents));
+
+  if (command_line.HasOption(FlagForSwitch(Switch::VsyncRefreshRate))) {
+    if (!GetSwitchValue(command_line, Switch::VsyncRefreshRate,
+                        &settings.vsync_refresh_rate)) {
+      FXL_LOG(INFO) << "Vsync refresh rate specified was malformed. Will "
+                       "default to "
+                    << settings.vsync_refresh_rate;
+    }
+  }
+
   settings.endless_trace_buffer =
       command_line.HasOption(FlagForSwitch(Switch::EndlessTraceBuffer));
 
   settings.trace_startup =
       command_line.HasOption(FlagForSwitch(Switch::TraceStartup));
 
+  command_line.GetOptionValue(FlagForSwitch(Switch::TraceExportPath),
+                              &settings.trace_export_path);
+
+  std::string trace_categories;
+  if (command_line.GetOptionValue(FlagForSwitch(Switch::TraceCategories),
+                                  &trace_categories)) {
+    settings.trace_categories = SplitCommaSeparatedList(trace_categories);
+  }
+
   settings.skia_deterministic_rendering_on_cpu =
       command_line.HasOption(FlagForSwitch(Switch::SkiaDeterministicRendering));
 
@@ -217,6 +252,28 @@ blink::Settings SettingsFromCommandLine(const fxl::CommandLine& command_line) {
   settings.use_test_fonts =
       command_line.HasOption(FlagForSwitch(Switch::UseTestFonts));
 
+  std::string prewarm_font_families;
+  if (command_line.GetOptionValue(FlagForSwitch(Switch::PrewarmFontFamilies),
+                                  &prewarm_font_families)) {
+    settings.prewarm_font_families =
+        SplitCommaSeparatedList(prewarm_font_families);
+  }
+
+  std::string prewarm_font_locales;
+  if (command_line.GetOptionValue(FlagForSwitch(Switch::PrewarmFontLocales),
+                                  &prewarm_font_locales)) {
+    settings.prewarm_font_locales =
+        SplitCommaSeparatedList(prewarm_font_locales);
+  }
+
+  std::string latest_value_platform_channels;
+  if (command_line.GetOptionValue(
+          FlagForSwitch(Switch::LatestValuePlatformChannels),
+          &latest_value_platform_channels)) {
+    settings.latest_value_platform_channels =
+        SplitCommaSeparatedList(latest_value_platform_channels);
+  }
+
   command_line.GetOptionValue(FlagForSwitch(Switch::LogTag), &settings.log_tag);
   std::string all_dart_flags;
   if (command_line.GetOptionValue(FlagForSwitch(Switch::DartFlags),
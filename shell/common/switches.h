@@ -47,6 +47,19 @@ DEF_SWITCH(AotIsolateSnapshotInstructions,
            "The isolate instructions snapshot that will be memory mapped as "
            "read and executable. AotSnapshotPath must be present.")
 DEF_SWITCH(CacheDirPath, "cache-dir-path", "Path to the cache directory.")
+DEF_SWITCH(CaptureFrames,
+           "capture-frames",
+           "Comma separated list of the numbers, starting at 1, of the frames "
+           "the tester captures with --capture-frames-directory. All frames "
+           "are captured by default.")
+DEF_SWITCH(CaptureFramesDirectory,
+           "capture-frames-directory",
+           "Directory to which the tester writes the frames rendered into its "
+           "offscreen surface. Requires --offscreen-surface-size.")
+DEF_SWITCH(CaptureFramesFormat,
+           "capture-frames-format",
+           "Either png (the default) or raw. Raw frames are tightly packed "
+           "32-bit premultiplied pixels in the native color order of Skia.")
 DEF_SWITCH(ICUDataFilePath, "icu-data-file-path", "Path to the ICU data file.")
 DEF_SWITCH(DartFlags,
            "dart-flags",
@@ -90,13 +103,49 @@ DEF_SWITCH(FlutterAssetsDir,
            "flutter-assets-dir",
            "Path to the Flutter assets directory.")
 DEF_SWITCH(Help, "help", "Display this help text.")
+DEF_SWITCH(LatestValuePlatformChannels,
+           "latest-value-platform-channels",
+           "Comma separated list of platform channels on which messages "
+           "superseded by a newer message before being dispatched are "
+           "dropped.")
 DEF_SWITCH(LogTag, "log-tag", "Tag associated with log messages.")
 DEF_SWITCH(MainDartFile, "dart-main", "The path to the main Dart file.")
+DEF_SWITCH(OffscreenSurfaceSize,
+           "offscreen-surface-size",
+           "Size in physical pixels, as <width>x<height>, of the software "
+           "surface the tester renders frames into. Without it, the tester "
+           "builds frames but does not render them.")
 DEF_SWITCH(Packages, "packages", "Specify the path to the packages.")
+DEF_SWITCH(PrewarmFontFamilies,
+           "prewarm-font-families",
+           "Comma separated list of font families to load on a background "
+           "thread while the shell starts up.")
+DEF_SWITCH(PrewarmFontLocales,
+           "prewarm-font-locales",
+           "Comma separated list of locales for which the families given with "
+           "--prewarm-font-families are loaded.")
+DEF_SWITCH(ReportFrameTimings,
+           "report-frame-timings",
+           "Print the build and raster times of the frames the tester "
+           "rendered when it exits. Requires --offscreen-surface-size.")
+DEF_SWITCH(ResamplePointerEvents,
+           "resample-pointer-events",
+           "Deliver pointer events once per frame, merging the moves of each "
+           "pointer into one move resampled to the frame time.")
 DEF_SWITCH(Snapshot, "snapshot-blob", "Specify the path to the snapshot blob")
 DEF_SWITCH(StartPaused,
            "start-paused",
            "Start the application paused in the Dart debugger.")
+DEF_SWITCH(TraceCategories,
+           "trace-categories",
+           "Comma separated list of the categories of the trace events that "
+           "are recorded. Events of other categories cost next to nothing. "
+           "Events of all categories are recorded by default.")
+DEF_SWITCH(TraceExportPath,
+           "trace-export-path",
+           "Record trace events without the Dart VM service and write the most "
+           "recent ones to this file, in the Chrome trace event format, each "
+           "time the process receives SIGUSR2.")
 DEF_SWITCH(TraceStartup,
            "trace-startup",
            "Trace early application lifecycle. Automatically switches to an "
@@ -118,6 +167,11 @@ DEF_SWITCH(VerboseLogging,
            "By default, only errors are logged. This flag enabled logging at "
            "all severity levels. This is NOT a per shell flag and affect log "
            "levels for all shells in the process.")
+DEF_SWITCH(VsyncRefreshRate,
+           "vsync-refresh-rate",
+           "The refresh rate in Hz at which frames are paced on platforms "
+           "without a vsync source. The default is 60. A rate of 0 renders "
+           "frames as fast as possible.")
 DEF_SWITCH(RunForever,
            "run-forever",
            "In non-interactive mode, keep the shell running after the Dart "
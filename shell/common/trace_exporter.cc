@@ -0,0 +1,321 @@
+// Copyright 2018 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/shell/common/trace_exporter.h"
+
+#include <mutex>
+#include <thread>
+
+#include "flutter/fml/build_config.h"
+#include "flutter/fml/eintr_wrapper.h"
+#include "lib/fxl/files/file.h"
+#include "lib/fxl/logging.h"
+#include "third_party/rapidjson/rapidjson/document.h"
+#include "third_party/rapidjson/rapidjson/stringbuffer.h"
+#include "third_party/rapidjson/rapidjson/writer.h"
+
+#if !defined(OS_WIN)
+#include <signal.h>
+#include <unistd.h>
+#endif
+
+namespace shell {
+
+static constexpr int64_t kCollectionIntervalMillis = 100;
+
+TraceExporter& TraceExporter::Get() {
+  static TraceExporter* exporter = new TraceExporter();
+  return *exporter;
+}
+
+TraceExporter::TraceExporter() : thread_("io.flutter.trace_exporter") {}
+
+TraceExporter::~TraceExporter() = default;
+
+void TraceExporter::Start() {
+  fml::tracing::StartRecording();
+  thread_.GetTaskRunner()->PostTask([this]() {
+    if (!collecting_) {
+      collecting_ = true;
+      CollectPeriodically();
+    }
+  });
+}
+
+void TraceExporter::Stop() {
+  fml::tracing::StopRecording();
+  thread_.GetTaskRunner()->PostTask([this]() {
+    Collect();
+    collecting_ = false;
+  });
+}
+
+void TraceExporter::Write(std::string path, WriteCallback callback) {
+  thread_.GetTaskRunner()->PostTask([this, path, callback]() {
+    Collect();
+    bool success = WriteCollectedEvents(path, true);
+    if (callback) {
+      callback(success);
+    }
+  });
+}
+
+void TraceExporter::WriteCopy(std::string path, WriteCallback callback) {
+  thread_.GetTaskRunner()->PostTask([this, path, callback]() {
+    Collect();
+    bool success = WriteCollectedEvents(path, false);
+    if (callback) {
+      callback(success);
+    }
+  });
+}
+
+static std::string ErrorEnvelope(const char* message) {
+  rapidjson::StringBuffer buffer;
+  rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+  writer.StartArray();
+  writer.String("error");
+  writer.String(message);
+  writer.Null();
+  writer.EndArray();
+  return std::string(buffer.GetString(), buffer.GetSize());
+}
+
+void TraceExporter::HandleMethodCall(const std::vector<uint8_t>& call,
+                                     const std::string& default_path,
+                                     ReplyCallback reply) {
+  rapidjson::Document document;
+  document.Parse(reinterpret_cast<const char*>(call.data()), call.size());
+  if (document.HasParseError() || !document.IsObject()) {
+    reply(ErrorEnvelope("The method call is not a JSON object."));
+    return;
+  }
+  auto root = document.GetObject();
+  auto method = root.FindMember("method");
+  if (method == root.MemberEnd() || !method->value.IsString()) {
+    reply(ErrorEnvelope("The method call has no method name."));
+    return;
+  }
+
+  if (method->value == "startRecording") {
+    Start();
+    reply("[true]");
+  } else if (method->value == "stopRecording") {
+    Stop();
+    reply("[true]");
+  } else if (method->value == "writeTrace") {
+    std::string path = default_path;
+    auto args = root.FindMember("args");
+    if (args != root.MemberEnd() && args->value.IsString()) {
+      path = args->value.GetString();
+    }
+    if (path.empty()) {
+      reply(ErrorEnvelope("No path to write the trace to."));
+      return;
+    }
+    Write(std::move(path), [reply](bool success) {
+      reply(success ? "[true]" : ErrorEnvelope("Could not write the trace."));
+    });
+  } else {
+    reply(std::string());
+  }
+}
+
+#if !defined(OS_WIN)
+
+static int gTraceSignalWriteFD = -1;
+
+static void OnTraceSignal(int signal) {
+  // Only async signal safe calls here. The watcher thread does the work.
+  char byte = 0;
+  ssize_t ignored = write(gTraceSignalWriteFD, &byte, 1);
+  (void)ignored;
+}
+
+void TraceExporter::WriteOnSignal(std::string path) {
+  // Only the path of the first call is used.
+  static std::once_flag once;
+  std::call_once(once, [this, &path]() {
+    int fds[2] = {};
+    if (pipe(fds) != 0) {
+      FXL_LOG(ERROR) << "Could not create the pipe for the trace signal.";
+      return;
+    }
+    gTraceSignalWriteFD = fds[1];
+    std::thread([this, read_fd = fds[0], path]() {
+      char byte = 0;
+      while (FML_HANDLE_EINTR(read(read_fd, &byte, 1)) == 1) {
+        Write(path, [path](bool success) {
+          FXL_LOG(INFO) << (success ? "Wrote the trace to "
+                                    : "Could not write the trace to ")
+                        << path;
+        });
+      }
+    })
+        .detach();
+
+    struct sigaction action = {};
+    action.sa_handler = &OnTraceSignal;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_RESTART;
+    if (sigaction(SIGUSR2, &action, nullptr) != 0) {
+      FXL_LOG(ERROR) << "Could not install the trace signal handler.";
+    }
+  });
+}
+
+#else  // !defined(OS_WIN)
+
+void TraceExporter::WriteOnSignal(std::string path) {
+  FXL_LOG(ERROR) << "Writing traces on a signal is not supported on Windows.";
+}
+
+#endif  // !defined(OS_WIN)
+
+void TraceExporter::CollectPeriodically() {
+  if (!collecting_) {
+    return;
+  }
+  Collect();
+  thread_.GetTaskRunner()->PostDelayedTask(
+      [this]() { CollectPeriodically(); },
+      fxl::TimeDelta::FromMilliseconds(kCollectionIntervalMillis));
+}
+
+void TraceExporter::Collect() {
+  dropped_events_ += fml::tracing::FlushRecordedEvents(
+      [this](const fml::tracing::TraceEventRecord& event) {
+        events_.push_back(event);
+        if (events_.size() > kMaxEvents) {
+          events_.pop_front();
+          dropped_events_++;
+        }
+      });
+}
+
+static const char* PhaseForEventType(fml::tracing::TraceEventType type) {
+  switch (type) {
+    case fml::tracing::TraceEventType::kBegin:
+      return "B";
+    case fml::tracing::TraceEventType::kEnd:
+      return "E";
+    case fml::tracing::TraceEventType::kInstant:
+      return "i";
+    case fml::tracing::TraceEventType::kAsyncBegin:
+      return "b";
+    case fml::tracing::TraceEventType::kAsyncEnd:
+      return "e";
+    case fml::tracing::TraceEventType::kFlowBegin:
+      return "s";
+    case fml::tracing::TraceEventType::kFlowStep:
+      return "t";
+    case fml::tracing::TraceEventType::kFlowEnd:
+      return "f";
+  }
+  return "i";
+}
+
+static bool HasID(fml::tracing::TraceEventType type) {
+  switch (type) {
+    case fml::tracing::TraceEventType::kAsyncBegin:
+    case fml::tracing::TraceEventType::kAsyncEnd:
+    case fml::tracing::TraceEventType::kFlowBegin:
+    case fml::tracing::TraceEventType::kFlowStep:
+    case fml::tracing::TraceEventType::kFlowEnd:
+      return true;
+    default:
+      return false;
+  }
+}
+
+bool TraceExporter::WriteCollectedEvents(const std::string& path,
+                                         bool forget_events) {
+  rapidjson::StringBuffer buffer;
+  rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+
+  writer.StartObject();
+  writer.Key("traceEvents");
+  writer.StartArray();
+
+  for (const auto& event : events_) {
+    writer.StartObject();
+    writer.Key("name");
+    writer.String(event.name);
+    if (event.category[0] != '\0') {
+      writer.Key("cat");
+      writer.String(event.category);
+    }
+    writer.Key("ph");
+    writer.String(PhaseForEventType(event.type));
+    writer.Key("ts");
+    writer.Int64(event.timestamp_micros);
+    writer.Key("pid");
+    writer.Int(0);
+    writer.Key("tid");
+    writer.Int64(event.thread_id);
+    if (HasID(event.type)) {
+      writer.Key("id");
+      writer.Int64(event.id);
+    }
+    if (event.type == fml::tracing::TraceEventType::kInstant) {
+      // Scoped to the thread.
+      writer.Key("s");
+      writer.String("t");
+    }
+    if (event.type == fml::tracing::TraceEventType::kFlowEnd) {
+      // Bind the arrow to the enclosing slice.
+      writer.Key("bp");
+      writer.String("e");
+    }
+    if (event.argument_count > 0) {
+      writer.Key("args");
+      writer.StartObject();
+      for (size_t i = 0; i < event.argument_count; i++) {
+        writer.Key(event.argument_names[i]);
+        writer.String(event.argument_values[i]);
+      }
+      writer.EndObject();
+    }
+    writer.EndObject();
+  }
+
+  // Metadata events name the threads.
+  for (const auto& thread_name : fml::tracing::GetThreadNames()) {
+    writer.StartObject();
+    writer.Key("name");
+    writer.String("thread_name");
+    writer.Key("ph");
+    writer.String("M");
+    writer.Key("pid");
+    writer.Int(0);
+    writer.Key("tid");
+    writer.Int64(thread_name.first);
+    writer.Key("args");
+    writer.StartObject();
+    writer.Key("name");
+    writer.String(thread_name.second.c_str());
+    writer.EndObject();
+    writer.EndObject();
+  }
+
+  writer.EndArray();
+  writer.Key("displayTimeUnit");
+  writer.String("ms");
+  writer.Key("droppedEvents");
+  writer.Uint64(dropped_events_);
+  writer.EndObject();
+
+  if (!files::WriteFile(path, buffer.GetString(), buffer.GetSize())) {
+    FXL_LOG(ERROR) << "Could not write the trace to " << path;
+    return false;
+  }
+
+  if (forget_events) {
+    events_.clear();
+    dropped_events_ = 0;
+  }
+  return true;
+}
+
+}  // namespace shell
@@ -0,0 +1,90 @@
+// Copyright 2018 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_SHELL_COMMON_TRACE_EXPORTER_H_
+#define FLUTTER_SHELL_COMMON_TRACE_EXPORTER_H_
+
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "flutter/fml/thread.h"
+#include "flutter/fml/trace_event.h"
+#include "lib/fxl/macros.h"
+
+namespace shell {
+
+// Collects the trace events recorded by fml::tracing and writes them to files
+// in the Chrome trace event format, which chrome://tracing and Perfetto load.
+// The Dart VM service is not involved, so this works in release mode. Only the
+// most recent events are kept, so that recording can stay on and the last
+// moments before a request are written out.
+//
+// Recording is process wide and so is the exporter. All the work happens on a
+// background thread.
+class TraceExporter {
+ public:
+  using WriteCallback = std::function<void(bool /* success */)>;
+  using ReplyCallback = std::function<void(std::string /* envelope */)>;
+
+  static TraceExporter& Get();
+
+  // Starts recording the events of the enabled categories and collecting them
+  // periodically.
+  void Start();
+
+  // Stops recording. The events collected so far are kept until written.
+  void Stop();
+
+  // Writes the events collected so far to the file and forgets them. The
+  // callback, if any, is made on the background thread.
+  void Write(std::string path, WriteCallback callback);
+
+  // Like |Write|, but keeps the events so that the next write includes them
+  // too. Used for the traces written alongside other captures.
+  void WriteCopy(std::string path, WriteCallback callback);
+
+  // Handles a call encoded with the JSON method codec of the framework, on the
+  // "flutter/tracing" channel. The methods are "startRecording" and
+  // "stopRecording", and "writeTrace", whose optional argument is the path of
+  // the file and defaults to |default_path|. Their result is true. The reply is
+  // the encoded envelope, which is empty for methods that are not implemented.
+  // It is made before this returns, except for "writeTrace", whose reply is
+  // made on the background thread once the file is written.
+  void HandleMethodCall(const std::vector<uint8_t>& call,
+                        const std::string& default_path,
+                        ReplyCallback reply);
+
+  // Writes the trace to the file each time the process receives SIGUSR2. Does
+  // nothing on Windows.
+  void WriteOnSignal(std::string path);
+
+ private:
+  // About 1MB of events.
+  static constexpr size_t kMaxEvents = 1 << 13;
+
+  fml::Thread thread_;
+  // Accessed on the thread only.
+  bool collecting_ = false;
+  std::deque<fml::tracing::TraceEventRecord> events_;
+  size_t dropped_events_ = 0;
+
+  TraceExporter();
+
+  ~TraceExporter();
+
+  void CollectPeriodically();
+
+  void Collect();
+
+  bool WriteCollectedEvents(const std::string& path, bool forget_events);
+
+  FXL_DISALLOW_COPY_AND_ASSIGN(TraceExporter);
+};
+
+}  // namespace shell
+
+#endif  // FLUTTER_SHELL_COMMON_TRACE_EXPORTER_H_
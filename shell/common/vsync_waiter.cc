@@ -22,6 +22,10 @@ void VsyncWaiter::AsyncWaitForVsync(Callback callback) {
   AwaitVSync();
 }
 
+void VsyncWaiter::SetRefreshRate(double refresh_rate) {}
+
+void VsyncWaiter::OnFrameRasterized(fxl::TimeDelta raster_time) {}
+
 void VsyncWaiter::FireCallback(fxl::TimePoint frame_start_time,
                                fxl::TimePoint frame_target_time) {
   Callback callback;
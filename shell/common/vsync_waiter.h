@@ -23,6 +23,15 @@ class VsyncWaiter {
 
   void AsyncWaitForVsync(Callback callback);
 
+  // Changes the refresh rate of waiters that pace frames with a timer. A rate
+  // of zero or less fires as soon as a frame is requested. Waiters driven by
+  // the display ignore this. Called on the UI task runner.
+  virtual void SetRefreshRate(double refresh_rate);
+
+  // Called on the UI task runner with the time the GPU task runner took to
+  // rasterize a frame.
+  virtual void OnFrameRasterized(fxl::TimeDelta raster_time);
+
  protected:
   const blink::TaskRunners task_runners_;
   std::mutex callback_mutex_;
@@ -9,6 +9,11 @@
 namespace shell {
 namespace {
 
+constexpr double kDefaultRefreshRate = 60.0;
+
+// Frames are never paced slower than this many refresh intervals.
+constexpr int64_t kMaxFrameIntervalCount = 4;
+
 fxl::TimePoint SnapToNextTick(fxl::TimePoint value,
                               fxl::TimePoint tick_phase,
                               fxl::TimeDelta tick_interval) {
@@ -23,19 +28,69 @@ fxl::TimePoint SnapToNextTick(fxl::TimePoint value,
 VsyncWaiterFallback::VsyncWaiterFallback(blink::TaskRunners task_runners)
     : VsyncWaiter(std::move(task_runners)),
       phase_(fxl::TimePoint::Now()),
+      refresh_interval_(
+          fxl::TimeDelta::FromSecondsF(1.0 / kDefaultRefreshRate)),
+      frame_interval_count_(1),
+      average_raster_time_nanos_(0),
       weak_factory_(this) {}
 
 VsyncWaiterFallback::~VsyncWaiterFallback() = default;
 
-constexpr fxl::TimeDelta interval = fxl::TimeDelta::FromSecondsF(1.0 / 60.0);
+// |shell::VsyncWaiter|
+void VsyncWaiterFallback::SetRefreshRate(double refresh_rate) {
+  refresh_interval_ = refresh_rate > 0.0
+                          ? fxl::TimeDelta::FromSecondsF(1.0 / refresh_rate)
+                          : fxl::TimeDelta::Zero();
+  phase_ = fxl::TimePoint::Now();
+  frame_interval_count_ = 1;
+}
+
+// |shell::VsyncWaiter|
+void VsyncWaiterFallback::OnFrameRasterized(fxl::TimeDelta raster_time) {
+  // Average over a few frames so that a single slow frame does not change the
+  // cadence.
+  average_raster_time_nanos_ =
+      (average_raster_time_nanos_ * 3 + raster_time.ToNanoseconds()) / 4;
+
+  const int64_t refresh_interval_nanos = refresh_interval_.ToNanoseconds();
+  if (refresh_interval_nanos == 0) {
+    return;
+  }
+
+  if (average_raster_time_nanos_ >
+          refresh_interval_nanos * frame_interval_count_ &&
+      frame_interval_count_ < kMaxFrameIntervalCount) {
+    frame_interval_count_++;
+  } else if (frame_interval_count_ > 1 &&
+             average_raster_time_nanos_ * 4 <
+                 refresh_interval_nanos * (frame_interval_count_ - 1) * 3) {
+    // Only go back to a faster cadence once the rasterizer keeps up with it
+    // with some headroom so that the cadence does not flip every frame.
+    frame_interval_count_--;
+  }
+}
 
 // |shell::VsyncWaiter|
 void VsyncWaiterFallback::AwaitVSync() {
+  if (refresh_interval_ == fxl::TimeDelta::Zero()) {
+    task_runners_.GetUITaskRunner()->PostTask(
+        [self = weak_factory_.GetWeakPtr()] {
+          if (self) {
+            const auto frame_time = fxl::TimePoint::Now();
+            self->FireCallback(frame_time, frame_time);
+          }
+        });
+    return;
+  }
+
+  const fxl::TimeDelta interval = fxl::TimeDelta::FromNanoseconds(
+      refresh_interval_.ToNanoseconds() * frame_interval_count_);
+
   fxl::TimePoint now = fxl::TimePoint::Now();
   fxl::TimePoint next = SnapToNextTick(now, phase_, interval);
 
   task_runners_.GetUITaskRunner()->PostDelayedTask(
-      [self = weak_factory_.GetWeakPtr()] {
+      [self = weak_factory_.GetWeakPtr(), interval] {
         if (self) {
           const auto frame_time = fxl::TimePoint::Now();
           self->FireCallback(frame_time, frame_time + interval);
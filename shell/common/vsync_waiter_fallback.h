@@ -12,14 +12,29 @@
 
 namespace shell {
 
+// Paces frames with a timer at the refresh rate. When rasterizing takes longer
+// than a refresh interval, frames are paced at a multiple of the interval the
+// rasterizer can keep up with instead of alternating between hitting and
+// missing the interval.
 class VsyncWaiterFallback final : public VsyncWaiter {
  public:
   VsyncWaiterFallback(blink::TaskRunners task_runners);
 
   ~VsyncWaiterFallback() override;
 
+  // |shell::VsyncWaiter|
+  void SetRefreshRate(double refresh_rate) override;
+
+  // |shell::VsyncWaiter|
+  void OnFrameRasterized(fxl::TimeDelta raster_time) override;
+
  private:
   fxl::TimePoint phase_;
+  // Zero if frames are not throttled.
+  fxl::TimeDelta refresh_interval_;
+  // The number of refresh intervals per frame.
+  int64_t frame_interval_count_;
+  int64_t average_raster_time_nanos_;
   fxl::WeakPtrFactory<VsyncWaiterFallback> weak_factory_;
 
   // |shell::VsyncWaiter|
@@ -160,9 +160,9 @@ void AndroidShellHolder::DispatchPointerDataPacket(
   }
 
   shell_->GetTaskRunners().GetUITaskRunner()->PostTask(fxl::MakeCopyable(
-      [engine = shell_->GetEngine(), packet = std::move(packet)] {
+      [engine = shell_->GetEngine(), packet = std::move(packet)]() mutable {
         if (engine) {
-          engine->DispatchPointerDataPacket(*packet);
+          engine->DispatchPointerDataPacket(std::move(packet));
         }
       }));
 }
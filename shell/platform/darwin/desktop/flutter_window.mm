@@ -234,9 +234,9 @@ static std::string CreateThreadLabel() {
   _shell->GetTaskRunners().GetUITaskRunner()->PostTask(
       [engine = _shell->GetEngine(), pointer_data] {
         if (engine) {
-          blink::PointerDataPacket packet(1);
-          packet.SetPointerData(0, pointer_data);
-          engine->DispatchPointerDataPacket(packet);
+          auto packet = std::make_unique<blink::PointerDataPacket>(1);
+          packet->SetPointerData(0, pointer_data);
+          engine->DispatchPointerDataPacket(std::move(packet));
         }
       });
 }
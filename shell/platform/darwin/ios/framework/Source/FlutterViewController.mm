@@ -609,9 +609,9 @@ static inline blink::PointerData::DeviceKind DeviceKindFromTouchType(UITouch* to
   }
 
   _shell->GetTaskRunners().GetUITaskRunner()->PostTask(
-      fxl::MakeCopyable([engine = _shell->GetEngine(), packet = std::move(packet)] {
+      fxl::MakeCopyable([engine = _shell->GetEngine(), packet = std::move(packet)]() mutable {
         if (engine) {
-          engine->DispatchPointerDataPacket(*packet);
+          engine->DispatchPointerDataPacket(std::move(packet));
         }
       }));
 }
@@ -14,6 +14,7 @@
 
 #include "flutter/shell/platform/embedder/embedder.h"
 
+#include <map>
 #include <type_traits>
 
 #include "flutter/assets/directory_asset_bundle.h"
@@ -25,7 +26,9 @@
 #include "flutter/shell/common/switches.h"
 #include "flutter/shell/platform/embedder/embedder.h"
 #include "flutter/shell/platform/embedder/embedder_engine.h"
+#include "flutter/shell/platform/embedder/embedder_task_runner.h"
 #include "flutter/shell/platform/embedder/platform_view_embedder.h"
+#include "flutter/shell/platform/embedder/vsync_waiter_embedder.h"
 #include "lib/fxl/command_line.h"
 #include "lib/fxl/files/file.h"
 #include "lib/fxl/functional/make_copyable.h"
@@ -40,8 +43,17 @@
     return static_cast<decltype(pointer->member)>((default_value));      \
   })()
 
-bool IsRendererValid(const FlutterRendererConfig* config) {
-  if (config == nullptr || config->type != kOpenGL) {
+#define SAFE_ASSIGN(pointer, member, value)                              \
+  do {                                                                   \
+    if (offsetof(std::remove_pointer<decltype(pointer)>::type, member) + \
+            sizeof(pointer->member) <=                                   \
+        pointer->struct_size) {                                          \
+      pointer->member = (value);                                         \
+    }                                                                    \
+  } while (0)
+
+static bool IsOpenGLRendererConfigValid(const FlutterRendererConfig* config) {
+  if (config->type != kOpenGL) {
     return false;
   }
 
@@ -57,6 +69,132 @@ bool IsRendererValid(const FlutterRendererConfig* config) {
   return true;
 }
 
+static bool IsSoftwareRendererConfigValid(
+    const FlutterRendererConfig* config) {
+  if (config->type != kSoftware) {
+    return false;
+  }
+
+  const FlutterSoftwareRendererConfig* software_config = &config->software;
+
+  if (SAFE_ACCESS(software_config, surface_present_callback, nullptr) ==
+      nullptr) {
+    return false;
+  }
+
+  return true;
+}
+
+bool IsRendererValid(const FlutterRendererConfig* config) {
+  if (config == nullptr) {
+    return false;
+  }
+
+  switch (config->type) {
+    case kOpenGL:
+      return IsOpenGLRendererConfigValid(config);
+    case kSoftware:
+      return IsSoftwareRendererConfigValid(config);
+    default:
+      return false;
+  }
+}
+
+static void PopulateOpenGLDispatchTable(
+    const FlutterRendererConfig* config,
+    void* user_data,
+    shell::PlatformViewEmbedder::DispatchTable* dispatch_table) {
+  dispatch_table->gl_make_current_callback =
+      [ptr = config->open_gl.make_current, user_data]() -> bool {
+    return ptr(user_data);
+  };
+
+  dispatch_table->gl_clear_current_callback =
+      [ptr = config->open_gl.clear_current, user_data]() -> bool {
+    return ptr(user_data);
+  };
+
+  dispatch_table->gl_present_callback = [ptr = config->open_gl.present,
+                                         user_data]() -> bool {
+    return ptr(user_data);
+  };
+
+  dispatch_table->gl_fbo_callback = [ptr = config->open_gl.fbo_callback,
+                                     user_data]() -> intptr_t {
+    return ptr(user_data);
+  };
+
+  const FlutterOpenGLRendererConfig* open_gl_config = &config->open_gl;
+  if (SAFE_ACCESS(open_gl_config, make_resource_current, nullptr) != nullptr) {
+    dispatch_table->gl_make_resource_current_callback =
+        [ptr = config->open_gl.make_resource_current, user_data]() {
+          return ptr(user_data);
+        };
+  }
+}
+
+static void PopulateSoftwareDispatchTable(
+    const FlutterRendererConfig* config,
+    void* user_data,
+    shell::PlatformViewEmbedder::DispatchTable* dispatch_table) {
+  dispatch_table->software_present_callback =
+      [ptr = config->software.surface_present_callback, user_data](
+          const void* allocation, size_t row_bytes, size_t height) -> bool {
+    return ptr(user_data, allocation, row_bytes, height);
+  };
+
+  const FlutterSoftwareRendererConfig* software_config = &config->software;
+  if (SAFE_ACCESS(software_config, surface_acquire_callback, nullptr) !=
+      nullptr) {
+    dispatch_table->software_acquire_callback =
+        [ptr = config->software.surface_acquire_callback, user_data](
+            size_t width, size_t height, size_t* row_bytes) -> void* {
+      return ptr(user_data, width, height, row_bytes);
+    };
+  }
+}
+
+static bool IsTaskRunnerDescriptionValid(
+    const FlutterTaskRunnerDescription* description) {
+  if (description == nullptr) {
+    return true;
+  }
+
+  if (SAFE_ACCESS(description, runs_task_on_current_thread_callback,
+                  nullptr) == nullptr ||
+      SAFE_ACCESS(description, post_task_callback, nullptr) == nullptr) {
+    return false;
+  }
+
+  return true;
+}
+
+static fxl::RefPtr<shell::EmbedderTaskRunner> CreateEmbedderTaskRunner(
+    const FlutterTaskRunnerDescription* description) {
+  shell::EmbedderTaskRunner::DispatchTable task_runner_dispatch_table;
+
+  task_runner_dispatch_table.post_task_callback =
+      [ptr = description->post_task_callback,
+       user_data = description->user_data](
+          shell::EmbedderTaskRunner* task_runner, uint64_t task_baton,
+          fxl::TimePoint target_time) {
+        FlutterTask task = {
+            reinterpret_cast<FlutterTaskRunner>(task_runner),  // runner
+            task_baton,                                        // task
+        };
+        ptr(task, target_time.ToEpochDelta().ToNanoseconds(), user_data);
+      };
+
+  task_runner_dispatch_table.runs_task_on_current_thread_callback =
+      [ptr = description->runs_task_on_current_thread_callback,
+       user_data = description->user_data]() -> bool {
+    return ptr(user_data);
+  };
+
+  return fxl::MakeRefCounted<shell::EmbedderTaskRunner>(
+      std::move(task_runner_dispatch_table));
+}
+
 struct _FlutterPlatformMessageResponseHandle {
   fxl::RefPtr<blink::PlatformMessage> message;
 };
@@ -89,18 +227,12 @@ FlutterResult FlutterEngineRun(size_t version,
     return kInvalidArguments;
   }
 
-  auto make_current = [ptr = config->open_gl.make_current,
-                       user_data]() -> bool { return ptr(user_data); };
-
-  auto clear_current = [ptr = config->open_gl.clear_current,
-                        user_data]() -> bool { return ptr(user_data); };
-
-  auto present = [ptr = config->open_gl.present, user_data]() -> bool {
-    return ptr(user_data);
-  };
-
-  auto fbo_callback = [ptr = config->open_gl.fbo_callback,
-                       user_data]() -> intptr_t { return ptr(user_data); };
+  shell::PlatformViewEmbedder::DispatchTable dispatch_table;
+  if (config->type == kSoftware) {
+    PopulateSoftwareDispatchTable(config, user_data, &dispatch_table);
+  } else {
+    PopulateOpenGLDispatchTable(config, user_data, &dispatch_table);
+  }
 
   shell::PlatformViewEmbedder::PlatformMessageResponseCallback
       platform_message_response_callback = nullptr;
@@ -121,14 +253,6 @@ FlutterResult FlutterEngineRun(size_t version,
         };
   }
 
-  const FlutterOpenGLRendererConfig* open_gl_config = &config->open_gl;
-  std::function<bool()> make_resource_current_callback = nullptr;
-  if (SAFE_ACCESS(open_gl_config, make_resource_current, nullptr) != nullptr) {
-    make_resource_current_callback = [ptr =
-                                          config->open_gl.make_resource_current,
-                                      user_data]() { return ptr(user_data); };
-  }
-
   std::string icu_data_path;
   if (SAFE_ACCESS(args, icu_data_path, nullptr) != nullptr) {
     icu_data_path = SAFE_ACCESS(args, icu_data_path, nullptr);
@@ -164,35 +288,126 @@ FlutterResult FlutterEngineRun(size_t version,
     settings.packages_file_path = args->packages_path;
   }
 
-  settings.task_observer_add = [](intptr_t key, fxl::Closure callback) {
+  const FlutterCustomTaskRunners* custom_task_runners =
+      SAFE_ACCESS(args, custom_task_runners, nullptr);
+  const FlutterTaskRunnerDescription* platform_task_runner_description =
+      nullptr;
+  const FlutterTaskRunnerDescription* ui_task_runner_description = nullptr;
+  const FlutterTaskRunnerDescription* gpu_task_runner_description = nullptr;
+  const FlutterTaskRunnerDescription* io_task_runner_description = nullptr;
+  if (custom_task_runners != nullptr) {
+    platform_task_runner_description =
+        SAFE_ACCESS(custom_task_runners, platform_task_runner, nullptr);
+    ui_task_runner_description =
+        SAFE_ACCESS(custom_task_runners, ui_task_runner, nullptr);
+    gpu_task_runner_description =
+        SAFE_ACCESS(custom_task_runners, gpu_task_runner, nullptr);
+    io_task_runner_description =
+        SAFE_ACCESS(custom_task_runners, io_task_runner, nullptr);
+  }
+
+  if (!IsTaskRunnerDescriptionValid(platform_task_runner_description) ||
+      !IsTaskRunnerDescriptionValid(ui_task_runner_description) ||
+      !IsTaskRunnerDescriptionValid(gpu_task_runner_description) ||
+      !IsTaskRunnerDescriptionValid(io_task_runner_description)) {
+    return kInvalidArguments;
+  }
+
+  // Runners described by the same description share one event loop.
+  std::map<const FlutterTaskRunnerDescription*,
+           fxl::RefPtr<shell::EmbedderTaskRunner>>
+      embedder_task_runners;
+  for (auto description :
+       {platform_task_runner_description, ui_task_runner_description,
+        gpu_task_runner_description, io_task_runner_description}) {
+    if (description != nullptr &&
+        embedder_task_runners.count(description) == 0) {
+      embedder_task_runners[description] =
+          CreateEmbedderTaskRunner(description);
+    }
+  }
+
+  std::vector<fxl::RefPtr<shell::EmbedderTaskRunner>> custom_runners;
+  for (const auto& entry : embedder_task_runners) {
+    custom_runners.push_back(entry.second);
+  }
+
+  // Tasks on the custom runners do not run on a message loop of the engine, so
+  // their observers are kept by the runner of the current thread. The runners
+  // are checked first as the thread of a custom runner may also have a message
+  // loop of the engine that does not run the tasks of the runner.
+  settings.task_observer_add = [custom_runners](intptr_t key,
+                                                fxl::Closure callback) {
+    for (const auto& runner : custom_runners) {
+      if (runner->RunsTasksOnCurrentThread()) {
+        runner->AddTaskObserver(key, std::move(callback));
+        return;
+      }
+    }
     fml::MessageLoop::GetCurrent().AddTaskObserver(key, std::move(callback));
   };
-  settings.task_observer_remove = [](intptr_t key) {
+  settings.task_observer_remove = [custom_runners](intptr_t key) {
+    for (const auto& runner : custom_runners) {
+      if (runner->RunsTasksOnCurrentThread()) {
+        runner->RemoveTaskObserver(key);
+        return;
+      }
+    }
     fml::MessageLoop::GetCurrent().RemoveTaskObserver(key);
   };
 
-  // Create a thread host with the current thread as the platform thread and all
-  // other threads managed.
-  shell::ThreadHost thread_host("io.flutter", shell::ThreadHost::Type::GPU |
-                                                  shell::ThreadHost::Type::IO |
-                                                  shell::ThreadHost::Type::UI);
-  fml::MessageLoop::EnsureInitializedForCurrentThread();
-  blink::TaskRunners task_runners(
-      "io.flutter",
-      fml::MessageLoop::GetCurrent().GetTaskRunner(),  // platform
-      thread_host.gpu_thread->GetTaskRunner(),         // gpu
-      thread_host.ui_thread->GetTaskRunner(),          // ui
-      thread_host.io_thread->GetTaskRunner()           // io
+  // Create a thread host for each runner that is not provided by the embedder.
+  // Unless provided, the current thread is the platform thread.
+  uint64_t thread_host_mask = 0;
+  if (ui_task_runner_description == nullptr) {
+    thread_host_mask |= shell::ThreadHost::Type::UI;
+  }
+  if (gpu_task_runner_description == nullptr) {
+    thread_host_mask |= shell::ThreadHost::Type::GPU;
+  }
+  if (io_task_runner_description == nullptr) {
+    thread_host_mask |= shell::ThreadHost::Type::IO;
+  }
+  shell::ThreadHost thread_host("io.flutter", thread_host_mask);
+
+  fxl::RefPtr<fxl::TaskRunner> platform_task_runner;
+  if (platform_task_runner_description != nullptr) {
+    platform_task_runner =
+        embedder_task_runners[platform_task_runner_description];
+  } else {
+    fml::MessageLoop::EnsureInitializedForCurrentThread();
+    platform_task_runner = fml::MessageLoop::GetCurrent().GetTaskRunner();
+  }
+
+  fxl::RefPtr<fxl::TaskRunner> ui_task_runner =
+      ui_task_runner_description != nullptr
+          ? embedder_task_runners[ui_task_runner_description]
+          : thread_host.ui_thread->GetTaskRunner();
+  fxl::RefPtr<fxl::TaskRunner> gpu_task_runner =
+      gpu_task_runner_description != nullptr
+          ? embedder_task_runners[gpu_task_runner_description]
+          : thread_host.gpu_thread->GetTaskRunner();
+  fxl::RefPtr<fxl::TaskRunner> io_task_runner =
+      io_task_runner_description != nullptr
+          ? embedder_task_runners[io_task_runner_description]
+          : thread_host.io_thread->GetTaskRunner();
+
+  blink::TaskRunners task_runners("io.flutter",
+                                  std::move(platform_task_runner),  // platform
+                                  std::move(gpu_task_runner),       // gpu
+                                  std::move(ui_task_runner),        // ui
+                                  std::move(io_task_runner)         // io
   );
 
-  shell::PlatformViewEmbedder::DispatchTable dispatch_table = {
-      make_current,                        // gl_make_current_callback
-      clear_current,                       // gl_clear_current_callback
-      present,                             // gl_present_callback
-      fbo_callback,                        // gl_fbo_callback
-      platform_message_response_callback,  // platform_message_response_callback
-      make_resource_current_callback,      // gl_make_resource_current_callback
-  };
+  if (SAFE_ACCESS(args, vsync_callback, nullptr) != nullptr) {
+    dispatch_table.vsync_callback = [ptr = args->vsync_callback,
+                                     user_data](intptr_t baton) {
+      return ptr(user_data, baton);
+    };
+  }
+
+  dispatch_table.platform_message_response_callback =
+      platform_message_response_callback;
 
   shell::Shell::CreateCallback<shell::PlatformView> on_create_platform_view =
       [dispatch_table](shell::Shell& shell) {
@@ -302,15 +517,14 @@ FlutterResult FlutterEngineSendPointerEvent(FlutterEngine engine,
   const FlutterPointerEvent* current = pointers;
 
   for (size_t i = 0; i < events_count; ++i) {
-    blink::PointerData pointer_data;
-    pointer_data.Clear();
+    // Filled in place; the packet starts out zeroed.
+    blink::PointerData& pointer_data = packet->GetPointerData(i);
     pointer_data.time_stamp = SAFE_ACCESS(current, timestamp, 0);
     pointer_data.change = ToPointerDataChange(
         SAFE_ACCESS(current, phase, FlutterPointerPhase::kCancel));
     pointer_data.kind = blink::PointerData::DeviceKind::kMouse;
     pointer_data.physical_x = SAFE_ACCESS(current, x, 0.0);
     pointer_data.physical_y = SAFE_ACCESS(current, y, 0.0);
-    packet->SetPointerData(i, pointer_data);
     current = reinterpret_cast<const FlutterPointerEvent*>(
         reinterpret_cast<const uint8_t*>(current) + current->struct_size);
   }
@@ -369,6 +583,90 @@ FlutterResult FlutterEngineSendPlatformMessageResponse(
   return kSuccess;
 }
 
+FlutterResult FlutterEngineOnVsync(FlutterEngine engine,
+                                   intptr_t baton,
+                                   uint64_t frame_start_time_nanos,
+                                   uint64_t frame_target_time_nanos) {
+  if (engine == nullptr) {
+    return kInvalidArguments;
+  }
+
+  auto start_time = fxl::TimePoint::FromEpochDelta(
+      fxl::TimeDelta::FromNanoseconds(frame_start_time_nanos));
+  auto target_time = fxl::TimePoint::FromEpochDelta(
+      fxl::TimeDelta::FromNanoseconds(frame_target_time_nanos));
+
+  return shell::VsyncWaiterEmbedder::OnEmbedderVsync(baton, start_time,
+                                                     target_time)
+             ? kSuccess
+             : kInvalidArguments;
+}
+
+FlutterResult FlutterEngineSetRefreshRate(FlutterEngine engine,
+                                          double refresh_rate) {
+  if (engine == nullptr) {
+    return kInvalidArguments;
+  }
+
+  return reinterpret_cast<shell::EmbedderEngine*>(engine)->SetVsyncRefreshRate(
+             refresh_rate)
+             ? kSuccess
+             : kInvalidArguments;
+}
+
+static FlutterFrameTimingPercentiles ToFlutterFrameTimingPercentiles(
+    const shell::FrameTimings::Histogram::Percentiles& percentiles) {
+  FlutterFrameTimingPercentiles result = {};
+  result.count = percentiles.count;
+  result.p50_micros = percentiles.p50.ToMicroseconds();
+  result.p90_micros = percentiles.p90.ToMicroseconds();
+  result.p99_micros = percentiles.p99.ToMicroseconds();
+  result.max_micros = percentiles.max.ToMicroseconds();
+  return result;
+}
+
+FlutterResult FlutterEngineGetFrameTimings(FlutterEngine engine,
+                                           bool reset,
+                                           FlutterFrameTimings* timings) {
+  if (engine == nullptr || timings == nullptr) {
+    return kInvalidArguments;
+  }
+
+  shell::FrameTimings::Summary summary;
+  if (!reinterpret_cast<shell::EmbedderEngine*>(engine)->GetFrameTimings(
+          reset, &summary)) {
+    return kInvalidArguments;
+  }
+
+  SAFE_ASSIGN(timings, frame_count, summary.frame_count);
+  SAFE_ASSIGN(timings, missed_frame_count, summary.missed_frame_count);
+  SAFE_ASSIGN(timings, build_time,
+              ToFlutterFrameTimingPercentiles(summary.build_time));
+  SAFE_ASSIGN(timings, raster_time,
+              ToFlutterFrameTimingPercentiles(summary.raster_time));
+  SAFE_ASSIGN(timings, vsync_latency,
+              ToFlutterFrameTimingPercentiles(summary.vsync_latency));
+  return kSuccess;
+}
+
+FlutterResult FlutterEngineRunTask(FlutterEngine engine,
+                                   const FlutterTask* task) {
+  // The engine is not known yet for the tasks posted while |FlutterEngineRun|
+  // creates the shell, so the task carries its runner.
+  if (task == nullptr || task->runner == nullptr) {
+    return kInvalidArguments;
+  }
+
+  return reinterpret_cast<shell::EmbedderTaskRunner*>(task->runner)
+                 ->RunTask(task->task)
+             ? kSuccess
+             : kInvalidArguments;
+}
+
+uint64_t FlutterEngineGetCurrentTime() {
+  return fxl::TimePoint::Now().ToEpochDelta().ToNanoseconds();
+}
+
 FlutterResult __FlutterEngineFlushPendingTasksNow() {
   fml::MessageLoop::GetCurrent().RunExpiredTasksNow();
   return kSuccess;
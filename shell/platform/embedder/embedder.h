@@ -27,6 +27,7 @@ typedef enum {
 
 typedef enum {
   kOpenGL,
+  kSoftware,
 } FlutterRendererType;
 
 typedef struct _FlutterEngine* FlutterEngine;
@@ -44,10 +45,37 @@ typedef struct {
   BoolCallback make_resource_current;
 } FlutterOpenGLRendererConfig;
 
+typedef bool (*SoftwareSurfacePresentCallback)(void* /* user data */,
+                                               const void* /* allocation */,
+                                               size_t /* row bytes */,
+                                               size_t /* height */);
+typedef void* (*SoftwareSurfaceAcquireCallback)(void* /* user data */,
+                                                size_t /* width */,
+                                                size_t /* height */,
+                                                size_t* /* row bytes */);
+
+typedef struct {
+  // The size of this struct. Must be sizeof(FlutterSoftwareRendererConfig).
+  size_t struct_size;
+  // The callback invoked to present a fully rendered frame. The pixels are in
+  // the native 32-bit premultiplied RGBA format of the platform. When the
+  // engine owns the allocation, it stays valid until the next call to this
+  // callback returns, so the embedder may keep reading it while the next frame
+  // is rendered.
+  SoftwareSurfacePresentCallback surface_present_callback;
+  // Optional. The callback invoked to get the memory into which the next frame
+  // of the given size is rendered. The embedder owns the memory and must set
+  // the row bytes, which may not be less than 4 bytes per pixel. The same
+  // allocation is then passed to |surface_present_callback|. If this callback
+  // is not provided or returns NULL, the engine renders into its own memory.
+  SoftwareSurfaceAcquireCallback surface_acquire_callback;
+} FlutterSoftwareRendererConfig;
+
 typedef struct {
   FlutterRendererType type;
   union {
     FlutterOpenGLRendererConfig open_gl;
+    FlutterSoftwareRendererConfig software;
   };
 } FlutterRendererConfig;
 
@@ -103,6 +131,51 @@ typedef void (*FlutterPlatformMessageCallback)(
     const FlutterPlatformMessage* /* message*/,
     void* /* user data */);
 
+typedef void (*VsyncCallback)(void* /* user data */,
+                              intptr_t /* baton */);
+
+typedef struct _FlutterTaskRunner* FlutterTaskRunner;
+
+typedef struct {
+  FlutterTaskRunner runner;
+  uint64_t task;
+} FlutterTask;
+
+typedef void (*FlutterTaskRunnerPostTaskCallback)(
+    FlutterTask /* task */,
+    uint64_t /* target time nanos */,
+    void* /* user data */);
+
+// An event loop of the embedder on which the engine may run the tasks of one
+// or more of its task runners.
+typedef struct {
+  // The size of this struct. Must be sizeof(FlutterTaskRunnerDescription).
+  size_t struct_size;
+  void* user_data;
+  // Called to check whether the calling thread is the thread of the event
+  // loop. May be called on any thread. Must be thread safe.
+  BoolCallback runs_task_on_current_thread_callback;
+  // Called to post a task to the event loop. May be called on any thread. Must
+  // be thread safe. Once the target time (as returned by
+  // |FlutterEngineGetCurrentTime|) has come, the embedder must call
+  // |FlutterEngineRunTask| with the task on the thread of the event loop.
+  FlutterTaskRunnerPostTaskCallback post_task_callback;
+} FlutterTaskRunnerDescription;
+
+typedef struct {
+  // The size of this struct. Must be sizeof(FlutterCustomTaskRunners).
+  size_t struct_size;
+  // Each runner is optional. The engine creates a thread for each of the UI,
+  // GPU and IO runners that is not given and uses the thread on which
+  // |FlutterEngineRun| is called for the platform runner if it is not given.
+  // Runners given the same description share one event loop, so a single
+  // threaded host may pass the same description for all four.
+  const FlutterTaskRunnerDescription* platform_task_runner;
+  const FlutterTaskRunnerDescription* ui_task_runner;
+  const FlutterTaskRunnerDescription* gpu_task_runner;
+  const FlutterTaskRunnerDescription* io_task_runner;
+} FlutterCustomTaskRunners;
+
 typedef struct {
   // The size of this struct. Must be sizeof(FlutterProjectArgs).
   size_t struct_size;
@@ -130,10 +203,49 @@ typedef struct {
   const char* const* command_line_argv;
   // The callback invoked by the engine in order to give the embedder the chance
   // to respond to platform messages from the Dart application. The callback
-  // will be invoked on the thread on which the |FlutterEngineRun| call is made.
+  // will be invoked on the platform task runner, which is the thread on which
+  // the |FlutterEngineRun| call is made unless a custom platform task runner is
+  // given.
   FlutterPlatformMessageCallback platform_message_callback;
+  // Optional. The callback invoked on the platform task runner when the engine
+  // wants to be notified of the next vsync pulse of the display. The embedder
+  // must then call |FlutterEngineOnVsync| with the given baton exactly once,
+  // on any thread, but not after |FlutterEngineShutdown| is called. If this
+  // callback is not provided, the engine paces frames with a 60 Hz timer.
+  VsyncCallback vsync_callback;
+  // Optional. The event loops of the embedder on which the engine runs its
+  // tasks.
+  const FlutterCustomTaskRunners* custom_task_runners;
 } FlutterProjectArgs;
 
+typedef struct {
+  // The number of samples the percentiles are computed from.
+  uint64_t count;
+  // Percentiles are accurate to 100 microseconds.
+  int64_t p50_micros;
+  int64_t p90_micros;
+  int64_t p99_micros;
+  int64_t max_micros;
+} FlutterFrameTimingPercentiles;
+
+typedef struct {
+  // The size of this struct. Must be sizeof(FlutterFrameTimings). Only the
+  // members that fit in this size are written.
+  size_t struct_size;
+  // The number of frames rasterized.
+  uint64_t frame_count;
+  // The number of frames rasterized after the vsync pulse they were to be
+  // presented at.
+  uint64_t missed_frame_count;
+  // The time the UI thread took to build each frame.
+  FlutterFrameTimingPercentiles build_time;
+  // The time the GPU thread took to rasterize each frame.
+  FlutterFrameTimingPercentiles raster_time;
+  // The time from each vsync pulse to the UI thread beginning to build the
+  // frame.
+  FlutterFrameTimingPercentiles vsync_latency;
+} FlutterFrameTimings;
+
 FLUTTER_EXPORT
 FlutterResult FlutterEngineRun(size_t version,
                                const FlutterRendererConfig* config,
@@ -166,6 +278,46 @@ FlutterResult FlutterEngineSendPlatformMessageResponse(
     const uint8_t* data,
     size_t data_length);
 
+// Notifies the engine of the vsync pulse requested with the baton passed to
+// the |vsync_callback|. The times are in nanoseconds on the clock of
+// |FlutterEngineGetCurrentTime|. The target time is when the frame must be
+// presented, usually the time of the next vsync pulse.
+FLUTTER_EXPORT
+FlutterResult FlutterEngineOnVsync(FlutterEngine engine,
+                                   intptr_t baton,
+                                   uint64_t frame_start_time_nanos,
+                                   uint64_t frame_target_time_nanos);
+
+// Changes the rate in Hz at which the engine paces frames when no
+// |vsync_callback| is provided. A rate of zero renders frames as fast as
+// possible, e.g. for offline capture.
+FLUTTER_EXPORT
+FlutterResult FlutterEngineSetRefreshRate(FlutterEngine engine,
+                                          double refresh_rate);
+
+// Reads the frame timings recorded since the engine was started or the
+// timings were last reset. May be called on any thread and does not wait for
+// the threads of the engine. If |reset| is true, the timings are reset once
+// read.
+FLUTTER_EXPORT
+FlutterResult FlutterEngineGetFrameTimings(FlutterEngine engine,
+                                           bool reset,
+                                           FlutterFrameTimings* timings);
+
+// Runs a task posted to one of the custom task runners of the engine. Must be
+// called on the thread of the event loop the task was posted to. The engine
+// may be NULL for tasks posted before |FlutterEngineRun| returns. Tasks still
+// pending once |FlutterEngineShutdown| returns must be dropped without being
+// run.
+FLUTTER_EXPORT
+FlutterResult FlutterEngineRunTask(FlutterEngine engine,
+                                   const FlutterTask* task);
+
+// The current time in nanoseconds on the clock used for task target times and
+// vsync timestamps.
+FLUTTER_EXPORT
+uint64_t FlutterEngineGetCurrentTime();
+
 // This API is only meant to be used by platforms that need to flush tasks on a
 // message loop not controlled by the Flutter engine. This API will be
 // deprecated soon.
@@ -91,9 +91,9 @@ bool EmbedderEngine::DispatchPointerDataPacket(
   }
 
   shell_->GetTaskRunners().GetUITaskRunner()->PostTask(fxl::MakeCopyable(
-      [engine = shell_->GetEngine(), packet = std::move(packet)] {
+      [engine = shell_->GetEngine(), packet = std::move(packet)]() mutable {
         if (engine) {
-          engine->DispatchPointerDataPacket(*packet);
+          engine->DispatchPointerDataPacket(std::move(packet));
         }
       }));
 
@@ -116,4 +116,35 @@ bool EmbedderEngine::SendPlatformMessage(
   return true;
 }
 
+bool EmbedderEngine::SetVsyncRefreshRate(double refresh_rate) {
+  if (!IsValid()) {
+    return false;
+  }
+
+  shell_->GetTaskRunners().GetUITaskRunner()->PostTask(
+      [engine = shell_->GetEngine(), refresh_rate] {
+        if (engine) {
+          engine->SetVsyncRefreshRate(refresh_rate);
+        }
+      });
+
+  return true;
+}
+
+bool EmbedderEngine::GetFrameTimings(bool reset,
+                                     FrameTimings::Summary* summary) {
+  if (!IsValid()) {
+    return false;
+  }
+
+  // The timings are read without a lock, so there is no need to hop to the
+  // threads that record them.
+  auto& frame_timings = shell_->GetFrameTimings();
+  *summary = frame_timings.GetSummary();
+  if (reset) {
+    frame_timings.Reset();
+  }
+  return true;
+}
+
 }  // namespace shell
@@ -40,6 +40,10 @@ class EmbedderEngine {
 
   bool SendPlatformMessage(fxl::RefPtr<blink::PlatformMessage> message);
 
+  bool SetVsyncRefreshRate(double refresh_rate);
+
+  bool GetFrameTimings(bool reset, FrameTimings::Summary* summary);
+
  private:
   const ThreadHost thread_host_;
   std::unique_ptr<Shell> shell_;
@@ -0,0 +1,73 @@
+// Copyright 2018 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/shell/platform/embedder/embedder_task_runner.h"
+
+#include <utility>
+
+namespace shell {
+
+EmbedderTaskRunner::EmbedderTaskRunner(DispatchTable table)
+    : dispatch_table_(std::move(table)) {}
+
+EmbedderTaskRunner::~EmbedderTaskRunner() = default;
+
+void EmbedderTaskRunner::PostTask(fxl::Closure task) {
+  PostTaskForTime(std::move(task), fxl::TimePoint::Now());
+}
+
+void EmbedderTaskRunner::PostTaskForTime(fxl::Closure task,
+                                         fxl::TimePoint target_time) {
+  if (!task) {
+    return;
+  }
+
+  uint64_t baton = 0;
+  {
+    std::lock_guard<std::mutex> lock(tasks_mutex_);
+    baton = ++last_baton_;
+    pending_tasks_[baton] = std::move(task);
+  }
+
+  dispatch_table_.post_task_callback(this, baton, target_time);
+}
+
+void EmbedderTaskRunner::PostDelayedTask(fxl::Closure task,
+                                         fxl::TimeDelta delay) {
+  PostTaskForTime(std::move(task), fxl::TimePoint::Now() + delay);
+}
+
+bool EmbedderTaskRunner::RunsTasksOnCurrentThread() {
+  return dispatch_table_.runs_task_on_current_thread_callback();
+}
+
+bool EmbedderTaskRunner::RunTask(uint64_t task_baton) {
+  fxl::Closure task;
+  {
+    std::lock_guard<std::mutex> lock(tasks_mutex_);
+    auto found = pending_tasks_.find(task_baton);
+    if (found == pending_tasks_.end()) {
+      return false;
+    }
+    task = std::move(found->second);
+    pending_tasks_.erase(found);
+  }
+
+  task();
+
+  for (const auto& observer : task_observers_) {
+    observer.second();
+  }
+  return true;
+}
+
+void EmbedderTaskRunner::AddTaskObserver(intptr_t key, fxl::Closure callback) {
+  task_observers_[key] = std::move(callback);
+}
+
+void EmbedderTaskRunner::RemoveTaskObserver(intptr_t key) {
+  task_observers_.erase(key);
+}
+
+}  // namespace shell
@@ -0,0 +1,72 @@
+// Copyright 2018 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_SHELL_PLATFORM_EMBEDDER_EMBEDDER_TASK_RUNNER_H_
+#define FLUTTER_SHELL_PLATFORM_EMBEDDER_EMBEDDER_TASK_RUNNER_H_
+
+#include <map>
+#include <mutex>
+#include <unordered_map>
+
+#include "lib/fxl/functional/closure.h"
+#include "lib/fxl/macros.h"
+#include "lib/fxl/memory/ref_counted.h"
+#include "lib/fxl/tasks/task_runner.h"
+
+namespace shell {
+
+// A task runner whose tasks are run by the event loop of the embedder. Tasks
+// are handed to the embedder as opaque batons that it passes back to
+// |RunTask| on the thread of the runner once their target time has come.
+class EmbedderTaskRunner final : public fxl::TaskRunner {
+ public:
+  struct DispatchTable {
+    std::function<void(EmbedderTaskRunner* task_runner,
+                       uint64_t task_baton,
+                       fxl::TimePoint target_time)>
+        post_task_callback;                                       // required
+    std::function<bool(void)> runs_task_on_current_thread_callback;  // required
+  };
+
+  // |fxl::TaskRunner|
+  void PostTask(fxl::Closure task) override;
+
+  // |fxl::TaskRunner|
+  void PostTaskForTime(fxl::Closure task, fxl::TimePoint target_time) override;
+
+  // |fxl::TaskRunner|
+  void PostDelayedTask(fxl::Closure task, fxl::TimeDelta delay) override;
+
+  // |fxl::TaskRunner|
+  bool RunsTasksOnCurrentThread() override;
+
+  // Runs the task with the given baton and then the task observers. Returns
+  // false if there is no such task, e.g. because it already ran.
+  bool RunTask(uint64_t task_baton);
+
+  // Observers that run after each task, like those of |fml::MessageLoop|.
+  void AddTaskObserver(intptr_t key, fxl::Closure callback);
+
+  void RemoveTaskObserver(intptr_t key);
+
+ private:
+  const DispatchTable dispatch_table_;
+  std::mutex tasks_mutex_;
+  uint64_t last_baton_ = 0;
+  std::unordered_map<uint64_t, fxl::Closure> pending_tasks_;
+  // Only accessed on the thread of the runner.
+  std::map<intptr_t, fxl::Closure> task_observers_;
+
+  explicit EmbedderTaskRunner(DispatchTable table);
+
+  ~EmbedderTaskRunner() override;
+
+  FRIEND_MAKE_REF_COUNTED(EmbedderTaskRunner);
+  FRIEND_REF_COUNTED_THREAD_SAFE(EmbedderTaskRunner);
+  FXL_DISALLOW_COPY_AND_ASSIGN(EmbedderTaskRunner);
+};
+
+}  // namespace shell
+
+#endif  // FLUTTER_SHELL_PLATFORM_EMBEDDER_EMBEDDER_TASK_RUNNER_H_
@@ -4,7 +4,9 @@
 
 #include "flutter/shell/platform/embedder/platform_view_embedder.h"
 
+#include "flutter/fml/trace_event.h"
 #include "flutter/shell/common/io_manager.h"
+#include "flutter/shell/platform/embedder/vsync_waiter_embedder.h"
 
 namespace shell {
 
@@ -32,6 +34,47 @@ intptr_t PlatformViewEmbedder::GLContextFBO() const {
   return dispatch_table_.gl_fbo_callback();
 }
 
+sk_sp<SkSurface> PlatformViewEmbedder::AcquireBackingStore(
+    const SkISize& size) {
+  TRACE_EVENT0("flutter", "PlatformViewEmbedder::AcquireBackingStore");
+  const SkImageInfo image_info = SkImageInfo::MakeN32Premul(size);
+
+  if (dispatch_table_.software_acquire_callback) {
+    size_t row_bytes = 0;
+    void* pixels = dispatch_table_.software_acquire_callback(
+        size.width(), size.height(), &row_bytes);
+    if (pixels != nullptr && row_bytes >= image_info.minRowBytes()) {
+      // Render directly into the memory of the embedder.
+      return SkSurface::MakeRasterDirect(image_info, pixels, row_bytes);
+    }
+  }
+
+  sk_sp<SkSurface>& backing_store =
+      software_backing_stores_[next_software_backing_store_];
+  next_software_backing_store_ = (next_software_backing_store_ + 1) % 2;
+  if (backing_store == nullptr ||
+      SkISize::Make(backing_store->width(), backing_store->height()) != size) {
+    backing_store = SkSurface::MakeRaster(image_info);
+  }
+  return backing_store;
+}
+
+bool PlatformViewEmbedder::PresentBackingStore(
+    sk_sp<SkSurface> backing_store) {
+  TRACE_EVENT0("flutter", "PlatformViewEmbedder::PresentBackingStore");
+  if (backing_store == nullptr) {
+    return false;
+  }
+
+  SkPixmap pixmap;
+  if (!backing_store->peekPixels(&pixmap)) {
+    return false;
+  }
+
+  return dispatch_table_.software_present_callback(
+      pixmap.addr(), pixmap.rowBytes(), pixmap.height());
+}
+
 void PlatformViewEmbedder::HandlePlatformMessage(
     fxl::RefPtr<blink::PlatformMessage> message) {
   if (!message) {
@@ -51,6 +94,9 @@ void PlatformViewEmbedder::HandlePlatformMessage(
 }
 
 std::unique_ptr<Surface> PlatformViewEmbedder::CreateRenderingSurface() {
+  if (dispatch_table_.software_present_callback) {
+    return std::make_unique<GPUSurfaceSoftware>(this);
+  }
   return std::make_unique<GPUSurfaceGL>(this);
 }
 
@@ -63,4 +109,13 @@ sk_sp<GrContext> PlatformViewEmbedder::CreateResourceContext() const {
   return nullptr;
 }
 
+// |shell::PlatformView|
+std::unique_ptr<VsyncWaiter> PlatformViewEmbedder::CreateVSyncWaiter() {
+  if (!dispatch_table_.vsync_callback) {
+    return PlatformView::CreateVSyncWaiter();
+  }
+  return std::make_unique<VsyncWaiterEmbedder>(dispatch_table_.vsync_callback,
+                                               task_runners_);
+}
+
 }  // namespace shell
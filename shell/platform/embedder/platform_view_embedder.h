@@ -7,24 +7,36 @@
 
 #include "flutter/shell/common/platform_view.h"
 #include "flutter/shell/gpu/gpu_surface_gl.h"
+#include "flutter/shell/gpu/gpu_surface_software.h"
 #include "flutter/shell/platform/embedder/embedder.h"
 #include "lib/fxl/macros.h"
 
 namespace shell {
 
 class PlatformViewEmbedder final : public PlatformView,
-                                   public GPUSurfaceGLDelegate {
+                                   public GPUSurfaceGLDelegate,
+                                   public GPUSurfaceSoftwareDelegate {
  public:
   using PlatformMessageResponseCallback =
       std::function<void(fxl::RefPtr<blink::PlatformMessage>)>;
+  using SoftwarePresentCallback = std::function<
+      bool(const void* allocation, size_t row_bytes, size_t height)>;
+  using SoftwareAcquireCallback =
+      std::function<void*(size_t width, size_t height, size_t* row_bytes)>;
+  using VsyncCallback = std::function<void(intptr_t baton)>;
+  // Either the GL or the software present callbacks are set. The software
+  // renderer is used if |software_present_callback| is set.
   struct DispatchTable {
-    std::function<bool(void)> gl_make_current_callback;   // required
-    std::function<bool(void)> gl_clear_current_callback;  // required
-    std::function<bool(void)> gl_present_callback;        // required
-    std::function<intptr_t(void)> gl_fbo_callback;        // required
+    std::function<bool(void)> gl_make_current_callback;   // required for GL
+    std::function<bool(void)> gl_clear_current_callback;  // required for GL
+    std::function<bool(void)> gl_present_callback;        // required for GL
+    std::function<intptr_t(void)> gl_fbo_callback;        // required for GL
     PlatformMessageResponseCallback
         platform_message_response_callback;                       // optional
     std::function<bool(void)> gl_make_resource_current_callback;  // optional
+    SoftwarePresentCallback software_present_callback;  // required for software
+    SoftwareAcquireCallback software_acquire_callback;  // optional
+    VsyncCallback vsync_callback;  // optional, defaults to a 60 Hz timer
   };
 
   PlatformViewEmbedder(PlatformView::Delegate& delegate,
@@ -45,12 +57,23 @@ class PlatformViewEmbedder final : public PlatformView,
   // |shell::GPUSurfaceGLDelegate|
   intptr_t GLContextFBO() const override;
 
+  // |shell::GPUSurfaceSoftwareDelegate|
+  sk_sp<SkSurface> AcquireBackingStore(const SkISize& size) override;
+
+  // |shell::GPUSurfaceSoftwareDelegate|
+  bool PresentBackingStore(sk_sp<SkSurface> backing_store) override;
+
   // |shell::PlatformView|
   void HandlePlatformMessage(
       fxl::RefPtr<blink::PlatformMessage> message) override;
 
  private:
   DispatchTable dispatch_table_;
+  // Backing stores of the software renderer when the embedder does not provide
+  // the memory. Frames alternate between them so that the last presented one
+  // is not drawn into while the embedder may still read it.
+  sk_sp<SkSurface> software_backing_stores_[2];
+  size_t next_software_backing_store_ = 0;
 
   // |shell::PlatformView|
   std::unique_ptr<Surface> CreateRenderingSurface() override;
@@ -58,6 +81,9 @@ class PlatformViewEmbedder final : public PlatformView,
   // |shell::PlatformView|
   sk_sp<GrContext> CreateResourceContext() const override;
 
+  // |shell::PlatformView|
+  std::unique_ptr<VsyncWaiter> CreateVSyncWaiter() override;
+
   FXL_DISALLOW_COPY_AND_ASSIGN(PlatformViewEmbedder);
 };
 
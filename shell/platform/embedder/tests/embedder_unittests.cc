@@ -3,6 +3,7 @@
 // found in the LICENSE file.
 
 #include <string>
+#include <vector>
 #include "embedder.h"
 #include "flutter/testing/testing.h"
 
@@ -44,3 +45,143 @@ TEST(EmbedderTest, CanLaunchAndShutdownWithValidProjectArgs) {
   result = FlutterEngineShutdown(engine);
   ASSERT_EQ(result, FlutterResult::kSuccess);
 }
+
+TEST(EmbedderTest, MustNotRunWithSoftwareRendererWithoutPresentCallback) {
+  FlutterSoftwareRendererConfig renderer = {};
+  renderer.struct_size = sizeof(FlutterSoftwareRendererConfig);
+
+  FlutterRendererConfig config = {};
+  config.type = FlutterRendererType::kSoftware;
+  config.software = renderer;
+
+  FlutterProjectArgs args = {};
+  args.struct_size = sizeof(FlutterProjectArgs);
+  args.assets_path = "";
+  args.main_path = "";
+  args.packages_path = "";
+
+  FlutterEngine engine = nullptr;
+  FlutterResult result = FlutterEngineRun(FLUTTER_ENGINE_VERSION, &config,
+                                          &args, nullptr, &engine);
+  ASSERT_EQ(result, FlutterResult::kInvalidArguments);
+}
+
+TEST(EmbedderTest, CanLaunchAndShutdownWithSoftwareRenderer) {
+  FlutterSoftwareRendererConfig renderer = {};
+  renderer.struct_size = sizeof(FlutterSoftwareRendererConfig);
+  renderer.surface_present_callback = [](void*, const void*, size_t, size_t) {
+    return true;
+  };
+
+  std::string main =
+      std::string(testing::GetFixturesPath()) + "/simple_main.dart";
+
+  FlutterRendererConfig config = {};
+  config.type = FlutterRendererType::kSoftware;
+  config.software = renderer;
+
+  FlutterProjectArgs args = {};
+  args.struct_size = sizeof(FlutterProjectArgs);
+  args.assets_path = "";
+  args.main_path = main.c_str();
+  args.packages_path = "";
+
+  FlutterEngine engine = nullptr;
+  FlutterResult result = FlutterEngineRun(FLUTTER_ENGINE_VERSION, &config,
+                                          &args, nullptr, &engine);
+  ASSERT_EQ(result, FlutterResult::kSuccess);
+
+  result = FlutterEngineShutdown(engine);
+  ASSERT_EQ(result, FlutterResult::kSuccess);
+}
+
+TEST(EmbedderTest, MustNotRunWithIncompleteCustomTaskRunner) {
+  FlutterSoftwareRendererConfig renderer = {};
+  renderer.struct_size = sizeof(FlutterSoftwareRendererConfig);
+  renderer.surface_present_callback = [](void*, const void*, size_t, size_t) {
+    return true;
+  };
+
+  FlutterRendererConfig config = {};
+  config.type = FlutterRendererType::kSoftware;
+  config.software = renderer;
+
+  FlutterTaskRunnerDescription ui_task_runner = {};
+  ui_task_runner.struct_size = sizeof(FlutterTaskRunnerDescription);
+  ui_task_runner.runs_task_on_current_thread_callback = [](void*) {
+    return true;
+  };
+
+  FlutterCustomTaskRunners custom_task_runners = {};
+  custom_task_runners.struct_size = sizeof(FlutterCustomTaskRunners);
+  custom_task_runners.ui_task_runner = &ui_task_runner;
+
+  FlutterProjectArgs args = {};
+  args.struct_size = sizeof(FlutterProjectArgs);
+  args.assets_path = "";
+  args.main_path = "";
+  args.packages_path = "";
+  args.custom_task_runners = &custom_task_runners;
+
+  FlutterEngine engine = nullptr;
+  FlutterResult result = FlutterEngineRun(FLUTTER_ENGINE_VERSION, &config,
+                                          &args, nullptr, &engine);
+  ASSERT_EQ(result, FlutterResult::kInvalidArguments);
+}
+
+TEST(EmbedderTest, CanLaunchAndShutdownOnSingleThreadedHost) {
+  FlutterSoftwareRendererConfig renderer = {};
+  renderer.struct_size = sizeof(FlutterSoftwareRendererConfig);
+  renderer.surface_present_callback = [](void*, const void*, size_t, size_t) {
+    return true;
+  };
+
+  std::string main =
+      std::string(testing::GetFixturesPath()) + "/simple_main.dart";
+
+  FlutterRendererConfig config = {};
+  config.type = FlutterRendererType::kSoftware;
+  config.software = renderer;
+
+  // Tasks are queued and run on this thread, so everything runs on this
+  // thread.
+  std::vector<FlutterTask> tasks;
+  FlutterTaskRunnerDescription task_runner = {};
+  task_runner.struct_size = sizeof(FlutterTaskRunnerDescription);
+  task_runner.user_data = &tasks;
+  task_runner.runs_task_on_current_thread_callback = [](void*) {
+    return true;
+  };
+  task_runner.post_task_callback = [](FlutterTask task, uint64_t,
+                                      void* user_data) {
+    reinterpret_cast<std::vector<FlutterTask>*>(user_data)->push_back(task);
+  };
+
+  FlutterCustomTaskRunners custom_task_runners = {};
+  custom_task_runners.struct_size = sizeof(FlutterCustomTaskRunners);
+  custom_task_runners.platform_task_runner = &task_runner;
+  custom_task_runners.ui_task_runner = &task_runner;
+  custom_task_runners.gpu_task_runner = &task_runner;
+  custom_task_runners.io_task_runner = &task_runner;
+
+  FlutterProjectArgs args = {};
+  args.struct_size = sizeof(FlutterProjectArgs);
+  args.assets_path = "";
+  args.main_path = main.c_str();
+  args.packages_path = "";
+  args.custom_task_runners = &custom_task_runners;
+
+  FlutterEngine engine = nullptr;
+  FlutterResult result = FlutterEngineRun(FLUTTER_ENGINE_VERSION, &config,
+                                          &args, nullptr, &engine);
+  ASSERT_EQ(result, FlutterResult::kSuccess);
+
+  while (!tasks.empty()) {
+    FlutterTask task = tasks.front();
+    tasks.erase(tasks.begin());
+    ASSERT_EQ(FlutterEngineRunTask(engine, &task), FlutterResult::kSuccess);
+  }
+
+  result = FlutterEngineShutdown(engine);
+  ASSERT_EQ(result, FlutterResult::kSuccess);
+}
@@ -0,0 +1,50 @@
+// Copyright 2018 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/shell/platform/embedder/vsync_waiter_embedder.h"
+
+#include <utility>
+
+#include "lib/fxl/logging.h"
+
+namespace shell {
+
+VsyncWaiterEmbedder::VsyncWaiterEmbedder(VsyncCallback vsync_callback,
+                                         blink::TaskRunners task_runners)
+    : VsyncWaiter(std::move(task_runners)),
+      vsync_callback_(std::move(vsync_callback)) {
+  FXL_DCHECK(vsync_callback_);
+}
+
+VsyncWaiterEmbedder::~VsyncWaiterEmbedder() = default;
+
+// |shell::VsyncWaiter|
+void VsyncWaiterEmbedder::AwaitVSync() {
+  // This new is balanced by the delete in |OnEmbedderVsync|.
+  auto baton = reinterpret_cast<intptr_t>(
+      new VsyncWaiter::Callback(std::bind(&VsyncWaiterEmbedder::FireCallback,
+                                          this,                   //
+                                          std::placeholders::_1,  //
+                                          std::placeholders::_2   //
+                                          )));
+
+  task_runners_.GetPlatformTaskRunner()->PostTask(
+      [callback = vsync_callback_, baton]() { callback(baton); });
+}
+
+// static
+bool VsyncWaiterEmbedder::OnEmbedderVsync(intptr_t baton,
+                                          fxl::TimePoint frame_start_time,
+                                          fxl::TimePoint frame_target_time) {
+  if (baton == 0) {
+    return false;
+  }
+
+  auto callback = reinterpret_cast<VsyncWaiter::Callback*>(baton);
+  (*callback)(frame_start_time, frame_target_time);
+  delete callback;
+  return true;
+}
+
+}  // namespace shell
@@ -0,0 +1,42 @@
+// Copyright 2018 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_SHELL_PLATFORM_EMBEDDER_VSYNC_WAITER_EMBEDDER_H_
+#define FLUTTER_SHELL_PLATFORM_EMBEDDER_VSYNC_WAITER_EMBEDDER_H_
+
+#include <functional>
+
+#include "flutter/shell/common/vsync_waiter.h"
+#include "lib/fxl/macros.h"
+
+namespace shell {
+
+// A vsync waiter that asks the embedder to call |FlutterEngineOnVsync| with
+// the baton it is handed once the next vsync pulse of its display arrives.
+class VsyncWaiterEmbedder final : public VsyncWaiter {
+ public:
+  using VsyncCallback = std::function<void(intptr_t baton)>;
+
+  VsyncWaiterEmbedder(VsyncCallback callback, blink::TaskRunners task_runners);
+
+  ~VsyncWaiterEmbedder() override;
+
+  // Consumes the baton of a pending vsync request. Returns false for a null
+  // baton.
+  static bool OnEmbedderVsync(intptr_t baton,
+                              fxl::TimePoint frame_start_time,
+                              fxl::TimePoint frame_target_time);
+
+ private:
+  const VsyncCallback vsync_callback_;
+
+  // |shell::VsyncWaiter|
+  void AwaitVSync() override;
+
+  FXL_DISALLOW_COPY_AND_ASSIGN(VsyncWaiterEmbedder);
+};
+
+}  // namespace shell
+
+#endif  // FLUTTER_SHELL_PLATFORM_EMBEDDER_VSYNC_WAITER_EMBEDDER_H_
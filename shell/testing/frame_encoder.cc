@@ -0,0 +1,82 @@
+// Copyright 2018 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/shell/testing/frame_encoder.h"
+
+#include <sstream>
+
+#include "flutter/fml/paths.h"
+#include "flutter/fml/trace_event.h"
+#include "lib/fxl/files/file.h"
+#include "lib/fxl/logging.h"
+#include "lib/fxl/synchronization/waitable_event.h"
+#include "third_party/skia/include/core/SkData.h"
+#include "third_party/skia/include/core/SkImage.h"
+
+namespace shell {
+
+FrameEncoder::FrameEncoder(std::string directory,
+                           Format format,
+                           std::set<size_t> frame_numbers)
+    : directory_(std::move(directory)),
+      format_(format),
+      frame_numbers_(std::move(frame_numbers)),
+      encoder_thread_("io.flutter.test.frame_encoder") {}
+
+FrameEncoder::~FrameEncoder() {
+  WaitForPendingFrames();
+}
+
+bool FrameEncoder::ShouldCapture(size_t frame_number) const {
+  return frame_numbers_.empty() || frame_numbers_.count(frame_number) != 0;
+}
+
+void FrameEncoder::Encode(size_t frame_number, SkSurface& surface) {
+  TRACE_EVENT0("flutter", "FrameEncoder::ReadPixels");
+  // Reading the pixels out leaves the surface untouched. A snapshot of the
+  // surface would instead be copied by the next frame that draws into it.
+  const SkImageInfo info =
+      SkImageInfo::MakeN32Premul(surface.width(), surface.height());
+  auto pixels = SkData::MakeUninitialized(info.minRowBytes() * info.height());
+  if (!surface.readPixels(info, pixels->writable_data(), info.minRowBytes(), 0,
+                          0)) {
+    FXL_LOG(ERROR) << "Could not read the pixels of frame " << frame_number;
+    return;
+  }
+
+  encoder_thread_.GetTaskRunner()->PostTask(
+      [directory = directory_, format = format_, frame_number, info, pixels]() {
+        TRACE_EVENT0("flutter", "FrameEncoder::Encode");
+        std::stringstream file_name;
+        file_name << "frame_" << frame_number;
+        sk_sp<SkData> data;
+        if (format == Format::kPNG) {
+          auto image =
+              SkImage::MakeRasterData(info, pixels, info.minRowBytes());
+          if (image) {
+            data = image->encodeToData(SkEncodedImageFormat::kPNG, 100);
+          }
+          file_name << ".png";
+        } else {
+          data = pixels;
+          file_name << "_" << info.width() << "x" << info.height() << ".raw";
+        }
+
+        const auto path = fml::paths::JoinPaths({directory, file_name.str()});
+        if (!data ||
+            !files::WriteFile(path, static_cast<const char*>(data->data()),
+                              data->size())) {
+          FXL_LOG(ERROR) << "Could not write frame " << frame_number << " to "
+                         << path;
+        }
+      });
+}
+
+void FrameEncoder::WaitForPendingFrames() {
+  fxl::AutoResetWaitableEvent latch;
+  encoder_thread_.GetTaskRunner()->PostTask([&latch]() { latch.Signal(); });
+  latch.Wait();
+}
+
+}  // namespace shell
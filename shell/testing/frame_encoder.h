@@ -0,0 +1,58 @@
+// Copyright 2018 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_SHELL_TESTING_FRAME_ENCODER_H_
+#define FLUTTER_SHELL_TESTING_FRAME_ENCODER_H_
+
+#include <memory>
+#include <set>
+#include <string>
+
+#include "flutter/fml/thread.h"
+#include "lib/fxl/macros.h"
+#include "third_party/skia/include/core/SkSurface.h"
+
+namespace shell {
+
+// Writes captured frames to a directory. Frames are encoded and written on a
+// thread of their own so that capturing does not skew the frame timings.
+class FrameEncoder {
+ public:
+  enum class Format {
+    // PNG files named frame_<number>.png.
+    kPNG,
+    // Tightly packed 32-bit premultiplied pixels in the native color type of
+    // Skia, in files named frame_<number>_<width>x<height>.raw.
+    kRaw,
+  };
+
+  // Captures the frames with the given numbers, starting at 1, or all frames
+  // if none are given.
+  FrameEncoder(std::string directory,
+               Format format,
+               std::set<size_t> frame_numbers);
+
+  ~FrameEncoder();
+
+  bool ShouldCapture(size_t frame_number) const;
+
+  // Copies the pixels of the surface, so the surface may be drawn into again
+  // as soon as this returns. Encoding happens on the encoder thread.
+  void Encode(size_t frame_number, SkSurface& surface);
+
+  // Blocks until all frames passed to |Encode| have been written.
+  void WaitForPendingFrames();
+
+ private:
+  const std::string directory_;
+  const Format format_;
+  const std::set<size_t> frame_numbers_;
+  fml::Thread encoder_thread_;
+
+  FXL_DISALLOW_COPY_AND_ASSIGN(FrameEncoder);
+};
+
+}  // namespace shell
+
+#endif  // FLUTTER_SHELL_TESTING_FRAME_ENCODER_H_
@@ -0,0 +1,76 @@
+// Copyright 2018 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/shell/testing/platform_view_tester.h"
+
+#include "flutter/fml/trace_event.h"
+
+namespace shell {
+
+PlatformViewTester::PlatformViewTester(
+    Shell& shell,
+    blink::TaskRunners task_runners,
+    std::unique_ptr<FrameEncoder> frame_encoder)
+    : PlatformView(shell, std::move(task_runners)),
+      shell_(shell),
+      frame_encoder_(std::move(frame_encoder)) {}
+
+PlatformViewTester::~PlatformViewTester() = default;
+
+// |shell::GPUSurfaceSoftwareDelegate|
+sk_sp<SkSurface> PlatformViewTester::AcquireBackingStore(const SkISize& size) {
+  raster_start_time_ = fxl::TimePoint::Now();
+
+  if (backing_store_ == nullptr ||
+      SkISize::Make(backing_store_->width(), backing_store_->height()) !=
+          size) {
+    backing_store_ = SkSurface::MakeRaster(SkImageInfo::MakeN32Premul(size));
+  }
+  return backing_store_;
+}
+
+// |shell::GPUSurfaceSoftwareDelegate|
+bool PlatformViewTester::PresentBackingStore(sk_sp<SkSurface> backing_store) {
+  TRACE_EVENT0("flutter", "PlatformViewTester::PresentBackingStore");
+  if (backing_store == nullptr) {
+    return false;
+  }
+
+  FrameTiming timing;
+  timing.raster_time = fxl::TimePoint::Now() - raster_start_time_;
+  // The rasterizer records the build time of the layer tree being drawn
+  // before the frame is presented.
+  auto rasterizer = shell_.GetRasterizer();
+  if (rasterizer) {
+    timing.build_time =
+        rasterizer->compositor_context()->engine_time().LastLap();
+  }
+  frame_timings_.push_back(timing);
+
+  const size_t frame_number = frame_timings_.size();
+  if (frame_encoder_ && frame_encoder_->ShouldCapture(frame_number)) {
+    // Copied after the raster time is taken, so that capturing does not
+    // count towards this frame or the next.
+    frame_encoder_->Encode(frame_number, *backing_store);
+  }
+  return true;
+}
+
+const std::vector<PlatformViewTester::FrameTiming>&
+PlatformViewTester::GetFrameTimings() const {
+  return frame_timings_;
+}
+
+void PlatformViewTester::WaitForCapturedFrames() {
+  if (frame_encoder_) {
+    frame_encoder_->WaitForPendingFrames();
+  }
+}
+
+// |shell::PlatformView|
+std::unique_ptr<Surface> PlatformViewTester::CreateRenderingSurface() {
+  return std::make_unique<GPUSurfaceSoftware>(this);
+}
+
+}  // namespace shell
@@ -0,0 +1,64 @@
+// Copyright 2018 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_SHELL_TESTING_PLATFORM_VIEW_TESTER_H_
+#define FLUTTER_SHELL_TESTING_PLATFORM_VIEW_TESTER_H_
+
+#include <memory>
+#include <vector>
+
+#include "flutter/shell/common/platform_view.h"
+#include "flutter/shell/common/shell.h"
+#include "flutter/shell/gpu/gpu_surface_software.h"
+#include "flutter/shell/testing/frame_encoder.h"
+#include "lib/fxl/macros.h"
+#include "lib/fxl/time/time_delta.h"
+
+namespace shell {
+
+// Renders frames into an offscreen software surface, optionally capturing them
+// with a frame encoder, and records how long each frame took to build and to
+// rasterize.
+class PlatformViewTester final : public PlatformView,
+                                 public GPUSurfaceSoftwareDelegate {
+ public:
+  struct FrameTiming {
+    fxl::TimeDelta build_time;
+    fxl::TimeDelta raster_time;
+  };
+
+  PlatformViewTester(Shell& shell,
+                     blink::TaskRunners task_runners,
+                     std::unique_ptr<FrameEncoder> frame_encoder);
+
+  ~PlatformViewTester() override;
+
+  // |shell::GPUSurfaceSoftwareDelegate|
+  sk_sp<SkSurface> AcquireBackingStore(const SkISize& size) override;
+
+  // |shell::GPUSurfaceSoftwareDelegate|
+  bool PresentBackingStore(sk_sp<SkSurface> backing_store) override;
+
+  // Must be called on the GPU task runner.
+  const std::vector<FrameTiming>& GetFrameTimings() const;
+
+  // Blocks until all captured frames have been written.
+  void WaitForCapturedFrames();
+
+ private:
+  Shell& shell_;
+  std::unique_ptr<FrameEncoder> frame_encoder_;
+  sk_sp<SkSurface> backing_store_;
+  fxl::TimePoint raster_start_time_;
+  std::vector<FrameTiming> frame_timings_;
+
+  // |shell::PlatformView|
+  std::unique_ptr<Surface> CreateRenderingSurface() override;
+
+  FXL_DISALLOW_COPY_AND_ASSIGN(PlatformViewTester);
+};
+
+}  // namespace shell
+
+#endif  // FLUTTER_SHELL_TESTING_PLATFORM_VIEW_TESTER_H_
@@ -4,7 +4,12 @@
 
 #define FML_USED_ON_EMBEDDER
 
+#include <algorithm>
 #include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <set>
+#include <sstream>
 
 #include "flutter/assets/asset_manager.h"
 #include "flutter/assets/directory_asset_bundle.h"
@@ -17,6 +22,9 @@
 #include "flutter/shell/common/shell.h"
 #include "flutter/shell/common/switches.h"
 #include "flutter/shell/common/thread_host.h"
+#include "flutter/shell/testing/frame_encoder.h"
+#include "flutter/shell/testing/platform_view_tester.h"
+#include "lib/fxl/files/directory.h"
 #include "lib/fxl/files/path.h"
 #include "lib/fxl/functional/make_copyable.h"
 #include "lib/fxl/synchronization/waitable_event.h"
@@ -103,7 +111,63 @@ static bool FileNameIsDill(const std::string& name) {
   return false;
 }
 
-int RunTester(const blink::Settings& settings, bool run_forever) {
+// Options of the offscreen rendering mode, in which frames are rendered into a
+// software surface instead of being discarded.
+struct OffscreenOptions {
+  // Empty unless frames are rendered.
+  SkISize surface_size = SkISize::MakeEmpty();
+  // Empty unless frames are captured.
+  std::string capture_directory;
+  FrameEncoder::Format capture_format = FrameEncoder::Format::kPNG;
+  std::set<size_t> capture_frames;
+  bool report_frame_timings = false;
+};
+
+static std::string FormatMilliseconds(fxl::TimeDelta delta) {
+  std::stringstream stream;
+  stream << std::fixed << std::setprecision(2) << delta.ToMillisecondsF()
+         << " ms";
+  return stream.str();
+}
+
+static void PrintFrameTimeSummary(const char* label,
+                                  std::vector<fxl::TimeDelta> times) {
+  std::sort(times.begin(), times.end());
+  int64_t total_micros = 0;
+  for (const auto& time : times) {
+    total_micros += time.ToMicroseconds();
+  }
+  auto percentile = [&times](size_t percent) {
+    return times[std::min(times.size() - 1, times.size() * percent / 100)];
+  };
+  std::cout << "  " << label << ": average "
+            << FormatMilliseconds(fxl::TimeDelta::FromMicroseconds(
+                   total_micros / static_cast<int64_t>(times.size())))
+            << ", 90th percentile " << FormatMilliseconds(percentile(90))
+            << ", 99th percentile " << FormatMilliseconds(percentile(99))
+            << ", worst " << FormatMilliseconds(times.back()) << std::endl;
+}
+
+static void PrintFrameTimings(
+    const std::vector<PlatformViewTester::FrameTiming>& timings) {
+  std::cout << "Frame timings (" << timings.size() << " frames)" << std::endl;
+  if (timings.empty()) {
+    return;
+  }
+
+  std::vector<fxl::TimeDelta> build_times;
+  std::vector<fxl::TimeDelta> raster_times;
+  for (const auto& timing : timings) {
+    build_times.push_back(timing.build_time);
+    raster_times.push_back(timing.raster_time);
+  }
+  PrintFrameTimeSummary("build", std::move(build_times));
+  PrintFrameTimeSummary("raster", std::move(raster_times));
+}
+
+int RunTester(const blink::Settings& settings,
+              bool run_forever,
+              const OffscreenOptions& offscreen_options) {
   const auto thread_label = "io.flutter.test";
 
   fml::MessageLoop::EnsureInitializedForCurrentThread();
@@ -118,10 +182,23 @@ int RunTester(const blink::Settings& settings, bool run_forever) {
                                         current_task_runner   // io
   );
 
+  const bool render_offscreen = !offscreen_options.surface_size.isEmpty();
+
   Shell::CreateCallback<PlatformView> on_create_platform_view =
-      [](Shell& shell) {
-        return std::make_unique<PlatformView>(shell, shell.GetTaskRunners());
-      };
+      [&offscreen_options,
+       render_offscreen](Shell& shell) -> std::unique_ptr<PlatformView> {
+    if (!render_offscreen) {
+      return std::make_unique<PlatformView>(shell, shell.GetTaskRunners());
+    }
+    std::unique_ptr<FrameEncoder> frame_encoder;
+    if (!offscreen_options.capture_directory.empty()) {
+      frame_encoder = std::make_unique<FrameEncoder>(
+          offscreen_options.capture_directory,
+          offscreen_options.capture_format, offscreen_options.capture_frames);
+    }
+    return std::make_unique<PlatformViewTester>(
+        shell, shell.GetTaskRunners(), std::move(frame_encoder));
+  };
 
   Shell::CreateCallback<Rasterizer> on_create_rasterizer = [](Shell& shell) {
     return std::make_unique<Rasterizer>(shell.GetTaskRunners());
@@ -143,6 +220,11 @@ int RunTester(const blink::Settings& settings, bool run_forever) {
     return EXIT_FAILURE;
   }
 
+  if (render_offscreen) {
+    // Sets up the software surface of the tester platform view.
+    shell->GetPlatformView()->NotifyCreated();
+  }
+
   auto isolate_configuration =
       FileNameIsDill(settings.main_dart_file_path)
           ? IsolateConfiguration::CreateForSnapshot(
@@ -183,7 +265,8 @@ int RunTester(const blink::Settings& settings, bool run_forever) {
       fxl::MakeCopyable([&sync_run_latch, &completion_observer,
                          engine = shell->GetEngine(),
                          config = std::move(run_configuration),
-                         &engine_did_run]() mutable {
+                         &engine_did_run, &offscreen_options,
+                         render_offscreen]() mutable {
         fml::MessageLoop::GetCurrent().AddTaskObserver(
             reinterpret_cast<intptr_t>(&completion_observer),
             [&completion_observer]() { completion_observer.DidProcessTask(); });
@@ -194,6 +277,10 @@ int RunTester(const blink::Settings& settings, bool run_forever) {
           metrics.device_pixel_ratio = 3.0;
           metrics.physical_width = 2400;   // 800 at 3x resolution
           metrics.physical_height = 1800;  // 600 at 3x resolution
+          if (render_offscreen) {
+            metrics.physical_width = offscreen_options.surface_size.width();
+            metrics.physical_height = offscreen_options.surface_size.height();
+          }
           engine->SetViewportMetrics(metrics);
 
         } else {
@@ -218,6 +305,23 @@ int RunTester(const blink::Settings& settings, bool run_forever) {
       });
   latch.Wait();
 
+  if (render_offscreen) {
+    fxl::AutoResetWaitableEvent timings_latch;
+    fml::TaskRunner::RunNowOrPostTask(
+        shell->GetTaskRunners().GetGPUTaskRunner(),
+        [&timings_latch, &offscreen_options,
+         view = static_cast<PlatformViewTester*>(
+             shell->GetPlatformView().get())] {
+          if (offscreen_options.report_frame_timings) {
+            PrintFrameTimings(view->GetFrameTimings());
+          }
+          timings_latch.Signal();
+        });
+    timings_latch.Wait();
+    static_cast<PlatformViewTester*>(shell->GetPlatformView().get())
+        ->WaitForCapturedFrames();
+  }
+
   if (!engine_did_run) {
     // If the engine itself didn't have a chance to run, there is no point in
     // asking it if there was an error. Signal a failure unconditionally.
@@ -227,6 +331,67 @@ int RunTester(const blink::Settings& settings, bool run_forever) {
   return completion_observer.GetExitCodeForLastError();
 }
 
+static bool ParseOffscreenOptions(const fxl::CommandLine& command_line,
+                                  OffscreenOptions* options) {
+  std::string surface_size;
+  if (!command_line.GetOptionValue(FlagForSwitch(Switch::OffscreenSurfaceSize),
+                                   &surface_size)) {
+    return true;
+  }
+
+  std::stringstream size_stream(surface_size);
+  int width = 0;
+  int height = 0;
+  char separator = 0;
+  if (!(size_stream >> width >> separator >> height) || separator != 'x' ||
+      width <= 0 || height <= 0) {
+    FXL_LOG(ERROR) << "Offscreen surface size must be <width>x<height>.";
+    return false;
+  }
+  options->surface_size = SkISize::Make(width, height);
+
+  options->report_frame_timings =
+      command_line.HasOption(FlagForSwitch(Switch::ReportFrameTimings));
+
+  if (!command_line.GetOptionValue(
+          FlagForSwitch(Switch::CaptureFramesDirectory),
+          &options->capture_directory)) {
+    return true;
+  }
+
+  if (!files::IsDirectory(options->capture_directory)) {
+    FXL_LOG(ERROR) << "Frame capture directory "
+                   << options->capture_directory << " does not exist.";
+    return false;
+  }
+
+  std::string format;
+  if (command_line.GetOptionValue(FlagForSwitch(Switch::CaptureFramesFormat),
+                                  &format)) {
+    if (format == "raw") {
+      options->capture_format = FrameEncoder::Format::kRaw;
+    } else if (format != "png") {
+      FXL_LOG(ERROR) << "Unknown frame capture format " << format << ".";
+      return false;
+    }
+  }
+
+  std::string frames;
+  if (command_line.GetOptionValue(FlagForSwitch(Switch::CaptureFrames),
+                                  &frames)) {
+    std::stringstream frames_stream(frames);
+    std::string frame;
+    while (std::getline(frames_stream, frame, ',')) {
+      const size_t frame_number = std::strtoul(frame.c_str(), nullptr, 10);
+      if (frame_number > 0) {
+        options->capture_frames.insert(frame_number);
+      }
+    }
+  }
+
+  return true;
+}
+
 }  // namespace shell
 
 int main(int argc, char* argv[]) {
@@ -268,7 +433,13 @@ int main(int argc, char* argv[]) {
     fml::MessageLoop::GetCurrent().RemoveTaskObserver(key);
   };
 
+  shell::OffscreenOptions offscreen_options;
+  if (!shell::ParseOffscreenOptions(command_line, &offscreen_options)) {
+    return EXIT_FAILURE;
+  }
+
   return shell::RunTester(
       settings,
-      command_line.HasOption(shell::FlagForSwitch(shell::Switch::RunForever)));
+      command_line.HasOption(shell::FlagForSwitch(shell::Switch::RunForever)),
+      offscreen_options);
 }
@@ -0,0 +1,119 @@
+/*
+ * Copyright 2018 Google, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "third_party/benchmark/include/benchmark/benchmark_api.h"
+
+#include <mutex>
+#include <sstream>
+
+#include "flutter/third_party/txt/tests/txt_test_utils.h"
+#include "minikin/FontCollection.h"
+#include "minikin/HbFontCache.h"
+#include "minikin/Layout.h"
+#include "minikin/MinikinInternal.h"
+#include "third_party/icu/source/common/unicode/unistr.h"
+#include "third_party/skia/include/core/SkTypeface.h"
+#include "txt/font_skia.h"
+
+namespace txt {
+
+static std::shared_ptr<minikin::FontFamily> CreateFamily(
+    const std::string& file_name) {
+  sk_sp<SkTypeface> typeface =
+      SkTypeface::MakeFromFile((GetFontDir() + "/" + file_name).c_str());
+  std::vector<minikin::Font> fonts;
+  fonts.emplace_back(std::make_shared<FontSkia>(typeface),
+                     minikin::FontStyle());
+  return std::make_shared<minikin::FontFamily>(std::move(fonts));
+}
+
+// Itemizes long text alternating between Latin, Hiragana and CJK ideographs,
+// each covered by a different family of the collection.
+static void BM_FontCollectionItemizeMixedScript(benchmark::State& state) {
+  std::vector<std::shared_ptr<minikin::FontFamily>> families = {
+      CreateFamily("Roboto-Regular.ttf"),
+      CreateFamily("Ja.ttf"),
+      CreateFamily("ZhHans.ttf"),
+  };
+  minikin::FontCollection collection(families);
+
+  auto icu_text = icu::UnicodeString::fromUTF8(
+      "The quick brown fox jumps over the lazy dog. あいうえ 㐂䑄 ");
+  std::u16string segment(icu_text.getBuffer(),
+                         icu_text.getBuffer() + icu_text.length());
+  std::u16string text;
+  for (int i = 0; i < state.range(0); ++i)
+    text += segment;
+
+  minikin::FontStyle style(
+      minikin::FontStyle::registerLanguageList("en-US,ja-JP"));
+  std::vector<minikin::FontCollection::Run> runs;
+
+  std::lock_guard<std::recursive_mutex> lock(minikin::gMinikinLock);
+  while (state.KeepRunning()) {
+    runs.clear();
+    collection.itemize(reinterpret_cast<const uint16_t*>(text.data()),
+                       text.size(), style, &runs);
+  }
+  state.SetItemsProcessed(state.iterations() * text.size());
+}
+BENCHMARK(BM_FontCollectionItemizeMixedScript)
+    ->RangeMultiplier(4)
+    ->Range(1, 256);
+
+// Lays out a short string with each of a number of distinct fonts in turn,
+// which exercises the HarfBuzz font cache once there are more fonts than it
+// holds. Font features are set so that the layout cache does not hide it.
+static void BM_HbFontCacheLayoutManyFonts(benchmark::State& state) {
+  std::vector<std::shared_ptr<minikin::FontCollection>> collections;
+  for (int i = 0; i < state.range(0); ++i) {
+    collections.push_back(std::make_shared<minikin::FontCollection>(
+        CreateFamily("Roboto-Regular.ttf")));
+  }
+
+  auto icu_text = icu::UnicodeString::fromUTF8("The quick brown fox");
+  std::u16string text(icu_text.getBuffer(),
+                      icu_text.getBuffer() + icu_text.length());
+  minikin::FontStyle style;
+  minikin::MinikinPaint paint;
+  paint.size = 14;
+  paint.fontFeatureSettings = "liga";
+
+  std::lock_guard<std::recursive_mutex> lock(minikin::gMinikinLock);
+  minikin::purgeHbFontCacheLocked();
+  minikin::resetHbFontCacheStatsLocked();
+  size_t index = 0;
+  while (state.KeepRunning()) {
+    minikin::Layout layout;
+    layout.doLayout(reinterpret_cast<const uint16_t*>(text.data()), 0,
+                    text.size(), text.size(), false, style, paint,
+                    collections[index]);
+    index = (index + 1) % collections.size();
+  }
+
+  minikin::HbFontCacheStats stats = minikin::getHbFontCacheStatsLocked();
+  std::ostringstream label;
+  label << "face hits " << stats.faceHits << " misses " << stats.faceMisses
+        << " evictions " << stats.faceEvictions << " bytes "
+        << stats.faceBytes << ", font hits " << stats.fontHits << " misses "
+        << stats.fontMisses;
+  state.SetLabel(label.str());
+}
+BENCHMARK(BM_HbFontCacheLayoutManyFonts)
+    ->RangeMultiplier(4)
+    ->Range(1, 512);
+
+}  // namespace txt
@@ -31,6 +31,7 @@
 #include "txt/font_weight.h"
 #include "txt/paragraph.h"
 #include "txt/paragraph_builder.h"
+#include "txt/text_scanner.h"
 
 namespace txt {
 
@@ -257,6 +258,42 @@ static void BM_ParagraphPaintSimple(benchmark::State& state) {
 }
 BENCHMARK(BM_ParagraphPaintSimple);
 
+// Lays out and paints many labels with the same text, as in a list of rows,
+// with the shared text blob cache disabled (0) or enabled (1). Compare with
+// BM_ParagraphPaintSimple, which paints a single paragraph laid out once.
+static void BM_ParagraphPaintRepeatedLabels(benchmark::State& state) {
+  const char* text = "Hello world! This is a simple sentence to test drawing.";
+  auto icu_text = icu::UnicodeString::fromUTF8(text);
+  std::u16string u16_text(icu_text.getBuffer(),
+                          icu_text.getBuffer() + icu_text.length());
+
+  txt::ParagraphStyle paragraph_style;
+
+  txt::TextStyle text_style;
+  text_style.font_family = "Roboto";
+  text_style.color = SK_ColorBLACK;
+
+  auto font_collection = GetTestFontCollection();
+  font_collection->GetTextBlobCache().SetMaxBytes(
+      state.range(0) ? TextBlobCache::kDefaultMaxBytes : 0);
+
+  std::unique_ptr<SkBitmap> bitmap = std::make_unique<SkBitmap>();
+  std::unique_ptr<SkCanvas> canvas = std::make_unique<SkCanvas>(*bitmap);
+  bitmap->allocN32Pixels(1000, 1000);
+  canvas->clear(SK_ColorWHITE);
+  while (state.KeepRunning()) {
+    for (int row = 0; row < 20; ++row) {
+      txt::ParagraphBuilder builder(paragraph_style, font_collection);
+      builder.PushStyle(text_style);
+      builder.AddText(u16_text);
+      auto paragraph = builder.Build();
+      paragraph->Layout(300);
+      paragraph->Paint(canvas.get(), 10, row * 40);
+    }
+  }
+}
+BENCHMARK(BM_ParagraphPaintRepeatedLabels)->Arg(0)->Arg(1);
+
 static void BM_ParagraphPaintLarge(benchmark::State& state) {
   const char* text =
       "Hello world! This is a simple sentence to test drawing. Hello world! "
@@ -304,6 +341,35 @@ static void BM_ParagraphPaintLarge(benchmark::State& state) {
 }
 BENCHMARK(BM_ParagraphPaintLarge);
 
+static void BM_ParagraphGetGlyphPositionAtCoordinate(
+    benchmark::State& state) {
+  std::u16string u16_text;
+  for (int i = 0; i < state.range(0); ++i)
+    u16_text += u"Hello world! This is a simple sentence to test hit testing. ";
+
+  txt::ParagraphStyle paragraph_style;
+
+  txt::TextStyle text_style;
+  text_style.font_family = "Roboto";
+  text_style.color = SK_ColorBLACK;
+  txt::ParagraphBuilder builder(paragraph_style, GetTestFontCollection());
+  builder.PushStyle(text_style);
+  builder.AddText(u16_text);
+  auto paragraph = builder.Build();
+  paragraph->Layout(300, true);
+
+  double height = paragraph->GetHeight();
+  int offset = 0;
+  while (state.KeepRunning()) {
+    paragraph->GetGlyphPositionAtCoordinate(
+        (offset * 37) % 300, (offset * 53) % static_cast<int>(height + 1));
+    offset++;
+  }
+}
+BENCHMARK(BM_ParagraphGetGlyphPositionAtCoordinate)
+    ->RangeMultiplier(4)
+    ->Range(1, 256);
+
 static void BM_ParagraphPaintDecoration(benchmark::State& state) {
   const char* text =
       "Hello world! This is a simple sentence to test drawing. Hello world! "
@@ -425,6 +491,24 @@ BENCHMARK(BM_ParagraphMinikinAddStyleRun)
     ->Range(1 << 7, 1 << 14)
     ->Complexity(benchmark::oN);
 
+static void BM_ParagraphFindMandatoryLineBreaks(benchmark::State& state) {
+  std::vector<uint16_t> text;
+  for (int64_t i = 0; i < state.range(0); ++i) {
+    text.push_back(i % 80 == 79 ? '\n' : 'a' + i % 26);
+  }
+
+  std::vector<size_t> breaks;
+  while (state.KeepRunning()) {
+    breaks.clear();
+    FindMandatoryLineBreaks(text.data(), 0, text.size(), &breaks);
+  }
+  state.SetComplexityN(state.range(0));
+}
+BENCHMARK(BM_ParagraphFindMandatoryLineBreaks)
+    ->RangeMultiplier(4)
+    ->Range(1 << 7, 1 << 16)
+    ->Complexity(benchmark::oN);
+
 static void BM_ParagraphSkTextBlobAlloc(benchmark::State& state) {
   SkPaint paint;
   paint.setAntiAlias(true);
@@ -364,6 +364,50 @@ const std::shared_ptr<FontFamily>& FontCollection::getFamilyForChar(
                  : mFamilies[bestFamilyIndex];
 }
 
+const std::shared_ptr<FontFamily>& FontCollection::getFamilyForCharCached(
+    uint32_t ch,
+    uint32_t vs,
+    uint32_t langListId,
+    int variant,
+    FamilyForCharCache* cache) const {
+  if (vs != 0 || ch >= mMaxChar) {
+    return getFamilyForChar(ch, vs, langListId, variant);
+  }
+
+  const uint32_t page = ch >> kLogCharsPerPage;
+  const Range& range = mRanges[page];
+  if (page != cache->page) {
+    cache->page = page;
+    cache->family = nullptr;
+    cache->bitmaps.clear();
+    for (size_t i = range.start; i < range.end; i++) {
+      cache->bitmaps.push_back(
+          mFamilies[mFamilyVec[i]]->getCoverage().getPage(ch));
+    }
+  }
+
+  std::bitset<kMaxFamilies> coverage;
+  for (size_t i = 0; i < cache->bitmaps.size(); i++) {
+    if (SparseBitSet::getInPage(cache->bitmaps[i], ch)) {
+      if (i == 0 && mFamilyVec[range.start] == 0) {
+        // The first family always wins when it supports the character.
+        return mFamilies[0];
+      }
+      coverage.set(i);
+    }
+  }
+
+  if (coverage.none()) {
+    // Fallback fonts and decompositions depend on the character itself.
+    return getFamilyForChar(ch, vs, langListId, variant);
+  }
+  if (cache->family == nullptr || coverage != cache->coverage) {
+    cache->family = &getFamilyForChar(ch, vs, langListId, variant);
+    cache->coverage = coverage;
+  }
+  return *cache->family;
+}
+
 const uint32_t NBSP = 0x00A0;
 const uint32_t SOFT_HYPHEN = 0x00AD;
 const uint32_t ZWJ = 0x200C;
@@ -441,6 +485,7 @@ void FontCollection::itemize(const uint16_t* string,
   int variant = style.getVariant();
   const FontFamily* lastFamily = nullptr;
   Run* run = NULL;
+  FamilyForCharCache familyCache;
 
   if (string_size == 0) {
     return;
@@ -478,8 +523,9 @@ void FontCollection::itemize(const uint16_t* string,
     }
 
     if (!shouldContinueRun) {
-      const std::shared_ptr<FontFamily>& family = getFamilyForChar(
-          ch, isVariationSelector(nextCh) ? nextCh : 0, langListId, variant);
+      const std::shared_ptr<FontFamily>& family = getFamilyForCharCached(
+          ch, isVariationSelector(nextCh) ? nextCh : 0, langListId, variant,
+          &familyCache);
       if (utf16Pos == 0 || family.get() != lastFamily) {
         size_t start = utf16Pos;
         // Workaround for combining marks and emoji modifiers until we implement
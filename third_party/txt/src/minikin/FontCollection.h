@@ -17,6 +17,7 @@
 #ifndef MINIKIN_FONT_COLLECTION_H
 #define MINIKIN_FONT_COLLECTION_H
 
+#include <bitset>
 #include <memory>
 #include <unordered_set>
 #include <vector>
@@ -92,6 +93,21 @@ class FontCollection {
     uint16_t end;
   };
 
+  // Upper bound of the number of families in a collection.
+  static const size_t kMaxFamilies = 256;
+
+  // Remembers the family chosen for the last code point of a page. For code
+  // points without a variation selector the choice only depends on which of
+  // the page's families cover the code point, so consecutive code points with
+  // the same coverage reuse it without scoring the families again.
+  struct FamilyForCharCache {
+    uint32_t page = ~0u;
+    // Bitmaps of the page for the families in mRanges[page].
+    std::vector<const SparseBitSet::element*> bitmaps;
+    std::bitset<kMaxFamilies> coverage;
+    const std::shared_ptr<FontFamily>* family = nullptr;
+  };
+
   // Initialize the FontCollection.
   void init(const std::vector<std::shared_ptr<FontFamily>>& typefaces);
 
@@ -100,6 +116,13 @@ class FontCollection {
                                                       uint32_t langListId,
                                                       int variant) const;
 
+  const std::shared_ptr<FontFamily>& getFamilyForCharCached(
+      uint32_t ch,
+      uint32_t vs,
+      uint32_t langListId,
+      int variant,
+      FamilyForCharCache* cache) const;
+
   uint32_t calcFamilyScore(uint32_t ch,
                            uint32_t vs,
                            int variant,
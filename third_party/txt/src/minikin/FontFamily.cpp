@@ -112,6 +112,18 @@ FontFamily::FontFamily(uint32_t langId, int variant, std::vector<Font>&& fonts)
   computeCoverage();
 }
 
+FontFamily::FontFamily(std::vector<Font>&& fonts,
+                       SparseBitSet&& coverage,
+                       bool hasVSTable)
+    : mLangId(FontLanguageListCache::kEmptyListId),
+      mVariant(0),
+      mFonts(std::move(fonts)),
+      mCoverage(std::move(coverage)),
+      mHasVSTable(hasVSTable) {
+  std::lock_guard<std::recursive_mutex> _l(gMinikinLock);
+  computeSupportedAxes();
+}
+
 bool FontFamily::analyzeStyle(const std::shared_ptr<MinikinFont>& typeface,
                               int* weight,
                               bool* italic) {
@@ -187,6 +199,10 @@ void FontFamily::computeCoverage() {
   mCoverage = CmapCoverage::getCoverage(cmapTable.get(), cmapTable.size(),
                                         &mHasVSTable);
 
+  computeSupportedAxes();
+}
+
+void FontFamily::computeSupportedAxes() {
   for (size_t i = 0; i < mFonts.size(); ++i) {
     std::unordered_set<AxisTag> supportedAxes =
         mFonts[i].getSupportedAxesLocked();
@@ -135,6 +135,11 @@ class FontFamily {
   explicit FontFamily(std::vector<Font>&& fonts);
   FontFamily(int variant, std::vector<Font>&& fonts);
   FontFamily(uint32_t langId, int variant, std::vector<Font>&& fonts);
+  // Creates a family with coverage computed earlier, for example by a
+  // persistent cache, without reading the cmap table of the fonts.
+  FontFamily(std::vector<Font>&& fonts,
+             SparseBitSet&& coverage,
+             bool hasVSTable);
 
   // TODO: Good to expose FontUtil.h.
   static bool analyzeStyle(const std::shared_ptr<MinikinFont>& typeface,
@@ -175,6 +180,7 @@ class FontFamily {
 
  private:
   void computeCoverage();
+  void computeSupportedAxes();
 
   uint32_t mLangId;
   int mVariant;
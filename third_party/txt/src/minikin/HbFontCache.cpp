@@ -29,29 +29,122 @@
 
 namespace minikin {
 
-class HbFontCache : private android::OnEntryRemoved<int32_t, hb_font_t*> {
+class HbFontCache {
  public:
-  HbFontCache() : mCache(kMaxEntries) {
-    mCache.setOnEntryRemovedListener(this);
+  HbFontCache()
+      : mFaces(android::LruCache<int32_t, FaceEntry>::kUnlimitedCapacity),
+        mFonts(kMaxFonts),
+        mFaceRemover(this),
+        mFaceBytes(0),
+        mStats() {
+    mFaces.setOnEntryRemovedListener(&mFaceRemover);
+    mFonts.setOnEntryRemovedListener(&mFontRemover);
   }
 
-  // callback for OnEntryRemoved
-  void operator()(int32_t& /* key */, hb_font_t*& value) {
-    hb_font_destroy(value);
+  hb_face_t* getFace(const MinikinFont* minikinFont) {
+    const int32_t fontId = minikinFont->GetUniqueId();
+    const FaceEntry& entry = mFaces.get(fontId);
+    if (entry.face != nullptr) {
+      mStats.faceHits++;
+      return entry.face;
+    }
+    mStats.faceMisses++;
+
+    hb_face_t* face = minikinFont->CreateHarfBuzzFace();
+    if (face == nullptr) {
+      return nullptr;
+    }
+    const size_t bytes = minikinFont->GetHarfBuzzFaceSize() + kFaceOverhead;
+    mFaces.put(fontId, FaceEntry{face, bytes});
+    mFaceBytes += bytes;
+    // Always keep the face that was just created.
+    while (mFaceBytes > kMaxFaceBytes && mFaces.size() > 1) {
+      mFaces.removeOldest();
+      mStats.faceEvictions++;
+    }
+    return face;
   }
 
-  hb_font_t* get(int32_t fontId) { return mCache.get(fontId); }
+  hb_font_t* getFont(int32_t fontId) {
+    hb_font_t* font = mFonts.get(fontId);
+    if (font != nullptr) {
+      mStats.fontHits++;
+      // Keep the face of a font in use from being evicted first.
+      mFaces.get(fontId);
+    } else {
+      mStats.fontMisses++;
+    }
+    return font;
+  }
 
-  void put(int32_t fontId, hb_font_t* font) { mCache.put(fontId, font); }
+  void putFont(int32_t fontId, hb_font_t* font) { mFonts.put(fontId, font); }
 
-  void clear() { mCache.clear(); }
+  void clear() {
+    mFonts.clear();
+    mFaces.clear();
+  }
+
+  void remove(int32_t fontId) {
+    mFonts.remove(fontId);
+    mFaces.remove(fontId);
+  }
+
+  HbFontCacheStats getStats() const {
+    HbFontCacheStats stats = mStats;
+    stats.faceCount = mFaces.size();
+    stats.faceBytes = mFaceBytes;
+    stats.fontCount = mFonts.size();
+    return stats;
+  }
 
-  void remove(int32_t fontId) { mCache.remove(fontId); }
+  void resetStats() { mStats = HbFontCacheStats(); }
 
  private:
-  static const size_t kMaxEntries = 100;
+  struct FaceEntry {
+    FaceEntry(hb_face_t* face, size_t bytes = 0) : face(face), bytes(bytes) {}
+
+    hb_face_t* face;
+    size_t bytes;
+  };
+
+  class FaceRemover : public android::OnEntryRemoved<int32_t, FaceEntry> {
+   public:
+    explicit FaceRemover(HbFontCache* cache) : mCache(cache) {}
+
+    void operator()(int32_t& key, FaceEntry& value) {
+      mCache->mFaceBytes -= value.bytes;
+      // The font holds a reference to the face, so it must go too for the
+      // face to be freed.
+      mCache->mFonts.remove(key);
+      hb_face_destroy(value.face);
+    }
+
+   private:
+    HbFontCache* mCache;
+  };
 
-  android::LruCache<int32_t, hb_font_t*> mCache;
+  class FontRemover : public android::OnEntryRemoved<int32_t, hb_font_t*> {
+   public:
+    void operator()(int32_t& /* key */, hb_font_t*& value) {
+      hb_font_destroy(value);
+    }
+  };
+
+  // Budget for the estimated size of the cached faces. Fonts are keyed like
+  // their faces and are evicted with them, so the budget bounds both.
+  static const size_t kMaxFaceBytes = 8 * 1024 * 1024;
+  // Estimated size of a face in addition to its tables.
+  static const size_t kFaceOverhead = 4 * 1024;
+  // Only bounds the fonts whose face could not be created. A font is small
+  // next to its face.
+  static const size_t kMaxFonts = 100;
+
+  android::LruCache<int32_t, FaceEntry> mFaces;
+  android::LruCache<int32_t, hb_font_t*> mFonts;
+  FaceRemover mFaceRemover;
+  FontRemover mFontRemover;
+  size_t mFaceBytes;
+  HbFontCacheStats mStats;
 };
 
 HbFontCache* getFontCacheLocked() {
@@ -89,13 +182,13 @@ hb_font_t* getHbFontLocked(const MinikinFont* minikinFont) {
 
   HbFontCache* fontCache = getFontCacheLocked();
   const int32_t fontId = minikinFont->GetUniqueId();
-  hb_font_t* font = fontCache->get(fontId);
+  hb_font_t* font = fontCache->getFont(fontId);
   if (font != nullptr) {
     return hb_font_reference(font);
   }
 
-  hb_face_t* face = minikinFont->CreateHarfBuzzFace();
-
+  // The face is owned by the cache.
+  hb_face_t* face = fontCache->getFace(minikinFont);
   hb_font_t* parent_font = hb_font_create(face);
   hb_ot_font_set_funcs(parent_font);
 
@@ -105,13 +198,23 @@ hb_font_t* getHbFontLocked(const MinikinFont* minikinFont) {
   font = hb_font_create_sub_font(parent_font);
   std::vector<hb_variation_t> variations;
   for (const FontVariation& variation : minikinFont->GetAxes()) {
-      variations.push_back({variation.axisTag, variation.value});
+    variations.push_back({variation.axisTag, variation.value});
   }
   hb_font_set_variations(font, variations.data(), variations.size());
   hb_font_destroy(parent_font);
-  hb_face_destroy(face);
-  fontCache->put(fontId, font);
+
+  fontCache->putFont(fontId, font);
   return hb_font_reference(font);
 }
 
+HbFontCacheStats getHbFontCacheStatsLocked() {
+  assertMinikinLocked();
+  return getFontCacheLocked()->getStats();
+}
+
+void resetHbFontCacheStatsLocked() {
+  assertMinikinLocked();
+  getFontCacheLocked()->resetStats();
+}
+
 }  // namespace minikin
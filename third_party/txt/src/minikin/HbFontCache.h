@@ -17,14 +17,34 @@
 #ifndef MINIKIN_HBFONT_CACHE_H
 #define MINIKIN_HBFONT_CACHE_H
 
+#include <stddef.h>
+
 struct hb_font_t;
 
 namespace minikin {
 class MinikinFont;
 
+// Counters of the HarfBuzz face and font caches. HarfBuzz faces hold the font
+// tables and the shaping data derived from them, and are bounded by their
+// estimated size. Fonts are cheap wrappers around a face and are bounded by
+// count, so evicting a font keeps its face.
+struct HbFontCacheStats {
+  size_t faceHits;
+  size_t faceMisses;
+  size_t faceEvictions;
+  size_t faceCount;
+  size_t faceBytes;
+  size_t fontHits;
+  size_t fontMisses;
+  size_t fontCount;
+};
+
 void purgeHbFontCacheLocked();
 void purgeHbFontLocked(const MinikinFont* minikinFont);
 hb_font_t* getHbFontLocked(const MinikinFont* minikinFont);
 
+HbFontCacheStats getHbFontCacheStatsLocked();
+void resetHbFontCacheStatsLocked();
+
 }  // namespace minikin
 #endif  // MINIKIN_HBFONT_CACHE_H
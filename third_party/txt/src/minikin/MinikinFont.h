@@ -103,6 +103,10 @@ class MinikinFont {
 
   virtual hb_face_t* CreateHarfBuzzFace() const { return nullptr; }
 
+  // Estimated number of bytes of font tables that a HarfBuzz face created by
+  // CreateHarfBuzzFace() loads for shaping. Used to bound the face cache.
+  virtual size_t GetHarfBuzzFaceSize() const { return 0; }
+
   virtual const std::vector<minikin::FontVariation>& GetAxes() const = 0;
 
   virtual std::shared_ptr<MinikinFont> createFontWithVariation(
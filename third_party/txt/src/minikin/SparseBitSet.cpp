@@ -61,8 +61,9 @@ void SparseBitSet::initFromRanges(const uint32_t* ranges, size_t nRanges) {
     return;
   }
   mMaxVal = maxVal;
-  mIndices.reset(new uint16_t[(mMaxVal + kPageMask) >> kLogValuesPerPage]);
+  mIndices.reset(new uint16_t[numIndices()]);
   uint32_t nPages = calcNumPages(ranges, nRanges);
+  mNumPages = nPages;
   mBitmaps.reset(new element[nPages << (kLogValuesPerPage - kLogBitsPerEl)]());
   mZeroPageIndex = noZeroPage;
   uint32_t nonzeroPageEnd = 0;
@@ -107,6 +108,89 @@ void SparseBitSet::initFromRanges(const uint32_t* ranges, size_t nRanges) {
   }
 }
 
+// The serialized form is a header of three 32-bit words (maximum value, page
+// count and zero page index) followed by the index table and the bitmaps, each
+// padded to a multiple of four bytes.
+static const size_t kSerializedHeaderSize = 3 * sizeof(uint32_t);
+
+static size_t alignToWord(size_t size) {
+  return (size + sizeof(uint32_t) - 1) & ~(sizeof(uint32_t) - 1);
+}
+
+size_t SparseBitSet::serializedSize() const {
+  return kSerializedHeaderSize + alignToWord(numIndices() * sizeof(uint16_t)) +
+         (mNumPages << (kLogValuesPerPage - kLogBitsPerEl)) * sizeof(element);
+}
+
+void SparseBitSet::serialize(uint8_t* out) const {
+  const uint32_t header[] = {mMaxVal, mNumPages, mZeroPageIndex};
+  memcpy(out, header, kSerializedHeaderSize);
+  out += kSerializedHeaderSize;
+  const size_t indicesSize = numIndices() * sizeof(uint16_t);
+  if (indicesSize != 0) {
+    memcpy(out, mIndices.get(), indicesSize);
+  }
+  memset(out + indicesSize, 0, alignToWord(indicesSize) - indicesSize);
+  out += alignToWord(indicesSize);
+  const size_t bitmapsSize =
+      (mNumPages << (kLogValuesPerPage - kLogBitsPerEl)) * sizeof(element);
+  if (bitmapsSize != 0) {
+    memcpy(out, mBitmaps.get(), bitmapsSize);
+  }
+}
+
+bool SparseBitSet::deserialize(const uint8_t* data, size_t size) {
+  mMaxVal = 0;
+  mNumPages = 0;
+  mZeroPageIndex = noZeroPage;
+  mIndices.reset();
+  mBitmaps.reset();
+
+  uint32_t header[3];
+  if (size < kSerializedHeaderSize) {
+    return false;
+  }
+  memcpy(header, data, kSerializedHeaderSize);
+  const uint32_t maxVal = header[0];
+  const uint32_t nPages = header[1];
+  // Indices are 16-bit element offsets, which limits the number of pages.
+  if (maxVal >= kMaximumCapacity ||
+      nPages > (1 << (16 - (kLogValuesPerPage - kLogBitsPerEl)))) {
+    return false;
+  }
+  const size_t nIndices = (maxVal + kPageMask) >> kLogValuesPerPage;
+  const size_t nElements = nPages << (kLogValuesPerPage - kLogBitsPerEl);
+  const size_t indicesSize = nIndices * sizeof(uint16_t);
+  if (size != kSerializedHeaderSize + alignToWord(indicesSize) +
+                  nElements * sizeof(element)) {
+    return false;
+  }
+  if (maxVal == 0) {
+    return true;
+  }
+
+  std::unique_ptr<uint16_t[]> indices(new uint16_t[nIndices]);
+  memcpy(indices.get(), data + kSerializedHeaderSize, indicesSize);
+  for (size_t i = 0; i < nIndices; i++) {
+    // Every index has to point at the start of a page.
+    if ((indices[i] & ((1 << (kLogValuesPerPage - kLogBitsPerEl)) - 1)) != 0 ||
+        indices[i] >= nElements) {
+      return false;
+    }
+  }
+  std::unique_ptr<element[]> bitmaps(new element[nElements]);
+  memcpy(bitmaps.get(),
+         data + kSerializedHeaderSize + alignToWord(indicesSize),
+         nElements * sizeof(element));
+
+  mMaxVal = maxVal;
+  mNumPages = nPages;
+  mZeroPageIndex = static_cast<uint16_t>(header[2]);
+  mIndices = std::move(indices);
+  mBitmaps = std::move(bitmaps);
+  return true;
+}
+
 #if defined(_WIN32)
 int SparseBitSet::CountLeadingZeros(element x) {
   return sizeof(element) <= sizeof(int) ? clz_win(x) : clzl_win(x);
@@ -34,7 +34,7 @@ namespace minikin {
 class SparseBitSet {
  public:
   // Create an empty bit set.
-  SparseBitSet() : mMaxVal(0) {}
+  SparseBitSet() : mMaxVal(0), mNumPages(0), mZeroPageIndex(noZeroPage) {}
 
   // Initialize the set to a new value, represented by ranges. For
   // simplicity, these ranges are arranged as pairs of values,
@@ -56,6 +56,27 @@ class SparseBitSet {
            0;
   }
 
+  typedef uint32_t element;
+
+  // Returns the bitmap of the page holding |ch|, or null if |ch| is not less
+  // than length(). Callers testing many values of the same page can look up
+  // the page once and test each value with getInPage().
+  const element* getPage(uint32_t ch) const {
+    if (ch >= mMaxVal)
+      return nullptr;
+    return &mBitmaps[mIndices[ch >> kLogValuesPerPage]];
+  }
+
+  // Determine whether the value is included in a page returned by getPage()
+  // for a value of the same page.
+  static bool getInPage(const element* page, uint32_t ch) {
+    if (page == nullptr)
+      return false;
+    uint32_t index = ch & kPageMask;
+    return (page[index >> kLogBitsPerEl] & (kElFirst >> (index & kElMask))) !=
+           0;
+  }
+
   // One more than the maximum value in the set, or zero if empty
   uint32_t length() const { return mMaxVal; }
 
@@ -65,6 +86,18 @@ class SparseBitSet {
 
   static const uint32_t kNotFound = ~0u;
 
+  // Number of bytes written by serialize().
+  size_t serializedSize() const;
+
+  // Writes the page tables of the set to |out|, which must have room for
+  // serializedSize() bytes. The result can be restored with deserialize()
+  // without recomputing the set from its ranges.
+  void serialize(uint8_t* out) const;
+
+  // Replaces the contents of the set with data written by serialize(). Returns
+  // false and leaves the set empty if the data is malformed.
+  bool deserialize(const uint8_t* data, size_t size);
+
  private:
   void initFromRanges(const uint32_t* ranges, size_t nRanges);
 
@@ -75,7 +108,6 @@ class SparseBitSet {
   static const int kLogBitsPerEl = kLogBytesPerEl + 3;
   static const int kElMask = (1 << kLogBitsPerEl) - 1;
   // invariant: sizeof(element) == (1 << kLogBytesPerEl)
-  typedef uint32_t element;
   static const element kElAllOnes = ~((element)0);
   static const element kElFirst = ((element)1) << kElMask;
   static const uint16_t noZeroPage = 0xFFFF;
@@ -83,7 +115,12 @@ class SparseBitSet {
   static uint32_t calcNumPages(const uint32_t* ranges, size_t nRanges);
   static int CountLeadingZeros(element x);
 
+  uint32_t numIndices() const {
+    return (mMaxVal + kPageMask) >> kLogValuesPerPage;
+  }
+
   uint32_t mMaxVal;
+  uint32_t mNumPages;
 
   std::unique_ptr<uint16_t[]> mIndices;
   std::unique_ptr<element[]> mBitmaps;
@@ -25,6 +25,8 @@
 #include <vector>
 #include "font_skia.h"
 #include "lib/fxl/logging.h"
+#include "minikin/MinikinInternal.h"
+#include "txt/font_metadata_cache.h"
 #include "txt/platform.h"
 #include "txt/text_style.h"
 
@@ -73,19 +75,26 @@ FontCollection::FontCollection() : enable_font_fallback_(true) {}
 FontCollection::~FontCollection() = default;
 
 size_t FontCollection::GetFontManagersCount() const {
+  std::lock_guard<std::recursive_mutex> lock(minikin::gMinikinLock);
   return GetFontManagerOrder().size();
 }
 
 void FontCollection::SetDefaultFontManager(sk_sp<SkFontMgr> font_manager) {
+  std::lock_guard<std::recursive_mutex> lock(minikin::gMinikinLock);
   default_font_manager_ = font_manager;
+  ClearFallbackCache();
 }
 
 void FontCollection::SetAssetFontManager(sk_sp<SkFontMgr> font_manager) {
+  std::lock_guard<std::recursive_mutex> lock(minikin::gMinikinLock);
   asset_font_manager_ = font_manager;
+  ClearFallbackCache();
 }
 
 void FontCollection::SetTestFontManager(sk_sp<SkFontMgr> font_manager) {
+  std::lock_guard<std::recursive_mutex> lock(minikin::gMinikinLock);
   test_font_manager_ = font_manager;
+  ClearFallbackCache();
 }
 
 // Return the available font managers in the order they should be queried.
@@ -101,13 +110,27 @@ std::vector<sk_sp<SkFontMgr>> FontCollection::GetFontManagerOrder() const {
 }
 
 void FontCollection::DisableFontFallback() {
+  std::lock_guard<std::recursive_mutex> lock(minikin::gMinikinLock);
   enable_font_fallback_ = false;
+  ClearFallbackCache();
+}
+
+void FontCollection::ClearFallbackCache() {
+  fallback_cache_.clear();
+  fallback_cache_stats_.negative_entries = 0;
+}
+
+FontCollection::FallbackCacheStats FontCollection::GetFallbackCacheStats()
+    const {
+  std::lock_guard<std::recursive_mutex> lock(minikin::gMinikinLock);
+  return fallback_cache_stats_;
 }
 
 std::shared_ptr<minikin::FontCollection>
 FontCollection::GetMinikinFontCollectionForFamily(
     const std::string& font_family,
     const std::string& locale) {
+  std::lock_guard<std::recursive_mutex> lock(minikin::gMinikinLock);
   // Look inside the font collections cache first.
   FamilyKey family_key(font_family, locale);
   auto cached = font_collections_cache_.find(family_key);
@@ -165,39 +188,102 @@ std::shared_ptr<minikin::FontFamily> FontCollection::CreateMinikinFontFamily(
     return nullptr;
   }
 
-  std::vector<minikin::Font> minikin_fonts;
-
-  // Add fonts to the Minikin font family.
+  std::vector<sk_sp<SkTypeface>> skia_typefaces;
   for (int i = 0; i < font_style_set->count(); ++i) {
-    // Create the skia typeface.
     sk_sp<SkTypeface> skia_typeface(
         sk_sp<SkTypeface>(font_style_set->createTypeface(i)));
-    if (skia_typeface == nullptr) {
-      continue;
+    if (skia_typeface != nullptr) {
+      skia_typefaces.push_back(std::move(skia_typeface));
+    }
+  }
+
+  // Reuse the coverage and styles computed for the same font files by an
+  // earlier collection or process.
+  FontMetadataCache& metadata_cache = FontMetadataCache::GetInstance();
+  bool use_metadata_cache =
+      !skia_typefaces.empty() && metadata_cache.IsEnabled();
+  uint64_t metadata_key =
+      use_metadata_cache ? FontMetadataCache::ComputeKey(skia_typefaces) : 0;
+  FontMetadataCache::Metadata metadata;
+  bool has_metadata =
+      use_metadata_cache &&
+      metadata_cache.Lookup(metadata_key, skia_typefaces.size(), &metadata);
+
+  // Add fonts to the Minikin font family.
+  std::vector<minikin::Font> minikin_fonts;
+  std::vector<minikin::FontStyle> minikin_styles;
+  for (size_t i = 0; i < skia_typefaces.size(); ++i) {
+    const sk_sp<SkTypeface>& skia_typeface = skia_typefaces[i];
+    minikin::FontStyle style;
+    if (has_metadata) {
+      style = metadata.styles[i];
+    } else {
+      // Divide by 100 because the weights are given as "100", "200", etc.
+      style = minikin::FontStyle{skia_typeface->fontStyle().weight() / 100,
+                                 skia_typeface->isItalic()};
     }
+    minikin_styles.push_back(style);
 
     // Create the minikin font from the skia typeface.
-    // Divide by 100 because the weights are given as "100", "200", etc.
-    minikin::Font minikin_font(
-        std::make_shared<FontSkia>(skia_typeface),
-        minikin::FontStyle{skia_typeface->fontStyle().weight() / 100,
-                           skia_typeface->isItalic()});
+    minikin::Font minikin_font(std::make_shared<FontSkia>(skia_typeface),
+                               style);
 
     minikin_fonts.emplace_back(std::move(minikin_font));
   }
 
-  return std::make_shared<minikin::FontFamily>(std::move(minikin_fonts));
+  if (has_metadata) {
+    return std::make_shared<minikin::FontFamily>(std::move(minikin_fonts),
+                                                 std::move(metadata.coverage),
+                                                 metadata.has_vs_table);
+  }
+
+  auto minikin_family =
+      std::make_shared<minikin::FontFamily>(std::move(minikin_fonts));
+  if (use_metadata_cache) {
+    metadata_cache.Store(metadata_key, minikin_styles,
+                         minikin_family->getCoverage(),
+                         minikin_family->hasVSTable());
+  }
+  return minikin_family;
 }
 
 const std::shared_ptr<minikin::FontFamily>& FontCollection::MatchFallbackFont(
     uint32_t ch,
     std::string locale) {
+  std::lock_guard<std::recursive_mutex> lock(minikin::gMinikinLock);
+  // Minikin asks for a fallback font every time it meets a character that the
+  // current families do not cover, so remember the answer for each code point,
+  // including the absence of any matching font.
+  std::unique_ptr<FallbackBlock>& block =
+      fallback_cache_[locale][ch >> kFallbackBlockBits];
+  if (!block) {
+    block = std::make_unique<FallbackBlock>();
+    block->fill(nullptr);
+  }
+
+  const std::shared_ptr<minikin::FontFamily>*& entry =
+      (*block)[ch & ((1 << kFallbackBlockBits) - 1)];
+  if (entry) {
+    fallback_cache_stats_.hits++;
+    return *entry;
+  }
+
+  fallback_cache_stats_.misses++;
+  entry = &MatchFallbackFontUncached(ch, locale);
+  if (entry == &g_null_family)
+    fallback_cache_stats_.negative_entries++;
+  return *entry;
+}
+
+const std::shared_ptr<minikin::FontFamily>&
+FontCollection::MatchFallbackFontUncached(uint32_t ch,
+                                          const std::string& locale) {
+  const char* bcp47 = locale.c_str();
+  int bcp47_count = locale.empty() ? 0 : 1;
+
   for (const sk_sp<SkFontMgr>& manager : GetFontManagerOrder()) {
-    std::vector<const char*> bcp47;
-    if (!locale.empty())
-      bcp47.push_back(locale.c_str());
     sk_sp<SkTypeface> typeface(manager->matchFamilyStyleCharacter(
-        0, SkFontStyle(), bcp47.data(), bcp47.size(), ch));
+        0, SkFontStyle(), &bcp47, bcp47_count, ch));
     if (!typeface)
       continue;
 
@@ -17,6 +17,7 @@
 #ifndef LIB_TXT_SRC_FONT_COLLECTION_H_
 #define LIB_TXT_SRC_FONT_COLLECTION_H_
 
+#include <array>
 #include <memory>
 #include <set>
 #include <string>
@@ -28,10 +29,14 @@
 #include "third_party/skia/include/core/SkFontMgr.h"
 #include "third_party/skia/include/core/SkRefCnt.h"
 #include "txt/asset_font_manager.h"
+#include "txt/text_blob_cache.h"
 #include "txt/text_style.h"
 
 namespace txt {
 
+// The font managers and caches of the collection are guarded by the global
+// Minikin lock, which layouts already hold when they ask the collection for
+// fallback fonts. So a collection may be used on several threads.
 class FontCollection : public std::enable_shared_from_this<FontCollection> {
  public:
   FontCollection();
@@ -52,10 +57,24 @@ class FontCollection : public std::enable_shared_from_this<FontCollection> {
       uint32_t ch,
       std::string locale);
 
+  struct FallbackCacheStats {
+    // Lookups answered by the fallback cache, including cached misses.
+    size_t hits = 0;
+    // Lookups that had to query the font managers.
+    size_t misses = 0;
+    // Code points for which no font manager has a fallback font.
+    size_t negative_entries = 0;
+  };
+
+  FallbackCacheStats GetFallbackCacheStats() const;
+
   // Do not provide alternative fonts that can match characters which are
   // missing from the requested font family.
   void DisableFontFallback();
 
+  // Shaped runs shared by all paragraphs laid out with this collection.
+  TextBlobCache& GetTextBlobCache() { return text_blob_cache_; }
+
  private:
   struct FamilyKey {
     FamilyKey(const std::string& family, const std::string& loc)
@@ -71,6 +90,15 @@ class FontCollection : public std::enable_shared_from_this<FontCollection> {
     };
   };
 
+  // Number of low bits of a code point used to index into a fallback block.
+  static const uint32_t kFallbackBlockBits = 7;
+
+  // Fallback families resolved for a block of consecutive code points. An entry
+  // is null if the code point has not been looked up, points to a null family
+  // if no fallback font covers it, and otherwise points into fallback_fonts_.
+  using FallbackBlock = std::array<const std::shared_ptr<minikin::FontFamily>*,
+                                   1 << kFallbackBlockBits>;
+
   sk_sp<SkFontMgr> default_font_manager_;
   sk_sp<SkFontMgr> asset_font_manager_;
   sk_sp<SkFontMgr> test_font_manager_;
@@ -82,10 +110,22 @@ class FontCollection : public std::enable_shared_from_this<FontCollection> {
       fallback_fonts_;
   std::unordered_map<std::string, std::set<std::string>>
       fallback_fonts_for_locale_;
+  std::unordered_map<
+      std::string,
+      std::unordered_map<uint32_t, std::unique_ptr<FallbackBlock>>>
+      fallback_cache_;
+  FallbackCacheStats fallback_cache_stats_;
   bool enable_font_fallback_;
+  TextBlobCache text_blob_cache_;
 
   std::vector<sk_sp<SkFontMgr>> GetFontManagerOrder() const;
 
+  void ClearFallbackCache();
+
+  const std::shared_ptr<minikin::FontFamily>& MatchFallbackFontUncached(
+      uint32_t ch,
+      const std::string& locale);
+
   std::shared_ptr<minikin::FontFamily> CreateMinikinFontFamily(
       const sk_sp<SkFontMgr>& manager,
       const std::string& family_name);
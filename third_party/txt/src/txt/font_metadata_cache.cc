@@ -0,0 +1,345 @@
+/*
+ * Copyright 2018 Google Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "font_metadata_cache.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+#include "lib/fxl/logging.h"
+#include "third_party/skia/include/core/SkFontStyle.h"
+#include "third_party/skia/include/core/SkString.h"
+#include "txt/mapped_file.h"
+
+namespace txt {
+
+namespace {
+
+const char kCacheFileName[] = "txt_font_metadata.cache";
+
+// The file starts with a header of four 32-bit words: magic, format version,
+// entry count and a reserved word. It is followed by an index of entries
+// sorted by key and then by the entry payloads.
+const uint32_t kMagic = 0x4D465854;  // "TXFM"
+const size_t kHeaderSize = 4 * sizeof(uint32_t);
+
+// Each index entry holds the 64-bit key followed by the offset and size of
+// the payload within the file.
+const size_t kIndexEntrySize = sizeof(uint64_t) + 2 * sizeof(uint32_t);
+
+// A payload holds the font count, the variation sequence flag, one word per
+// font style and the serialized coverage.
+const size_t kPayloadHeaderSize = 2 * sizeof(uint32_t);
+const uint32_t kItalicBit = 1 << 8;
+
+const SkFontTableTag kHeadTag = SkSetFourByteTag('h', 'e', 'a', 'd');
+// Covers the checkSumAdjustment, created and modified fields.
+const size_t kHeadIdentitySize = 36;
+
+const uint64_t kFnvOffsetBasis = 0xcbf29ce484222325ull;
+const uint64_t kFnvPrime = 0x100000001b3ull;
+
+uint64_t Hash(uint64_t hash, const void* data, size_t size) {
+  const uint8_t* bytes = static_cast<const uint8_t*>(data);
+  for (size_t i = 0; i < size; ++i) {
+    hash = (hash ^ bytes[i]) * kFnvPrime;
+  }
+  return hash;
+}
+
+template <typename T>
+uint64_t HashValue(uint64_t hash, T value) {
+  return Hash(hash, &value, sizeof(value));
+}
+
+template <typename T>
+T ReadValue(const uint8_t* data) {
+  T value;
+  memcpy(&value, data, sizeof(value));
+  return value;
+}
+
+template <typename T>
+void AppendValue(std::vector<uint8_t>* out, T value) {
+  const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+  out->insert(out->end(), bytes, bytes + sizeof(value));
+}
+
+}  // namespace
+
+FontMetadataCache& FontMetadataCache::GetInstance() {
+  static FontMetadataCache* instance = new FontMetadataCache();
+  return *instance;
+}
+
+FontMetadataCache::FontMetadataCache() = default;
+
+FontMetadataCache::~FontMetadataCache() = default;
+
+uint64_t FontMetadataCache::ComputeKey(
+    const std::vector<sk_sp<SkTypeface>>& typefaces) {
+  uint64_t hash = HashValue(kFnvOffsetBasis, kFormatVersion);
+  for (const sk_sp<SkTypeface>& typeface : typefaces) {
+    SkString family_name;
+    typeface->getFamilyName(&family_name);
+    hash = Hash(hash, family_name.c_str(), family_name.size());
+
+    SkFontStyle style = typeface->fontStyle();
+    hash = HashValue(hash, style.weight());
+    hash = HashValue(hash, style.width());
+    hash = HashValue(hash, static_cast<int>(style.slant()));
+
+    std::vector<SkFontTableTag> tags(typeface->countTables());
+    typeface->getTableTags(tags.data());
+    for (SkFontTableTag tag : tags) {
+      hash = HashValue(hash, tag);
+      hash =
+          HashValue(hash, static_cast<uint64_t>(typeface->getTableSize(tag)));
+    }
+
+    uint8_t head[kHeadIdentitySize];
+    size_t head_size = typeface->getTableData(kHeadTag, 0, sizeof(head), head);
+    hash = Hash(hash, head, head_size);
+  }
+  return hash;
+}
+
+void FontMetadataCache::SetCacheDirectory(const std::string& directory) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::string path =
+      directory.empty() ? std::string() : directory + "/" + kCacheFileName;
+  if (path == path_)
+    return;
+  path_ = std::move(path);
+  pending_.clear();
+  MapFileLocked();
+}
+
+void FontMetadataCache::MapFileLocked() {
+  file_index_ = nullptr;
+  file_entry_count_ = 0;
+  file_ = path_.empty() ? nullptr : MappedFile::Open(path_);
+  if (!file_)
+    return;
+
+  const uint8_t* data = file_->data();
+  size_t size = file_->size();
+  if (size < kHeaderSize || ReadValue<uint32_t>(data) != kMagic ||
+      ReadValue<uint32_t>(data + 4) != kFormatVersion) {
+    FXL_DLOG(INFO) << "Ignoring font metadata cache with unknown format.";
+    file_.reset();
+    return;
+  }
+  size_t entry_count = ReadValue<uint32_t>(data + 8);
+  if (entry_count > (size - kHeaderSize) / kIndexEntrySize) {
+    file_.reset();
+    return;
+  }
+  file_index_ = data + kHeaderSize;
+  file_entry_count_ = entry_count;
+}
+
+bool FontMetadataCache::IsEnabled() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return !path_.empty();
+}
+
+bool FontMetadataCache::FindLocked(uint64_t key,
+                                   const uint8_t** data,
+                                   size_t* size) const {
+  auto pending = pending_.find(key);
+  if (pending != pending_.end()) {
+    *data = pending->second.data();
+    *size = pending->second.size();
+    return true;
+  }
+
+  size_t low = 0;
+  size_t high = file_entry_count_;
+  while (low < high) {
+    size_t mid = low + (high - low) / 2;
+    const uint8_t* entry = file_index_ + mid * kIndexEntrySize;
+    uint64_t entry_key = ReadValue<uint64_t>(entry);
+    if (entry_key < key) {
+      low = mid + 1;
+    } else if (entry_key > key) {
+      high = mid;
+    } else {
+      size_t offset = ReadValue<uint32_t>(entry + sizeof(uint64_t));
+      size_t entry_size =
+          ReadValue<uint32_t>(entry + sizeof(uint64_t) + sizeof(uint32_t));
+      if (offset > file_->size() || entry_size > file_->size() - offset)
+        return false;
+      *data = file_->data() + offset;
+      *size = entry_size;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool FontMetadataCache::Lookup(uint64_t key,
+                               size_t font_count,
+                               Metadata* metadata) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  const uint8_t* data;
+  size_t size;
+  if (!FindLocked(key, &data, &size))
+    return false;
+
+  if (size < kPayloadHeaderSize || ReadValue<uint32_t>(data) != font_count)
+    return false;
+  size_t styles_size = font_count * sizeof(uint32_t);
+  if (size - kPayloadHeaderSize < styles_size)
+    return false;
+
+  const uint8_t* styles = data + kPayloadHeaderSize;
+  const uint8_t* coverage = styles + styles_size;
+  if (!metadata->coverage.deserialize(
+          coverage, size - kPayloadHeaderSize - styles_size)) {
+    return false;
+  }
+
+  metadata->has_vs_table = ReadValue<uint32_t>(data + sizeof(uint32_t)) != 0;
+  metadata->styles.clear();
+  for (size_t i = 0; i < font_count; ++i) {
+    uint32_t style = ReadValue<uint32_t>(styles + i * sizeof(uint32_t));
+    metadata->styles.emplace_back(style & ~kItalicBit,
+                                  (style & kItalicBit) != 0);
+  }
+  return true;
+}
+
+void FontMetadataCache::Store(uint64_t key,
+                              const std::vector<minikin::FontStyle>& styles,
+                              const minikin::SparseBitSet& coverage,
+                              bool has_vs_table) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  const uint8_t* data;
+  size_t size;
+  if (path_.empty() || FindLocked(key, &data, &size))
+    return;
+
+  std::vector<uint8_t> payload;
+  payload.reserve(kPayloadHeaderSize + styles.size() * sizeof(uint32_t) +
+                  coverage.serializedSize());
+  AppendValue<uint32_t>(&payload, styles.size());
+  AppendValue<uint32_t>(&payload, has_vs_table ? 1 : 0);
+  for (const minikin::FontStyle& style : styles) {
+    AppendValue<uint32_t>(
+        &payload, style.getWeight() | (style.getItalic() ? kItalicBit : 0));
+  }
+  size_t coverage_offset = payload.size();
+  payload.resize(coverage_offset + coverage.serializedSize());
+  coverage.serialize(payload.data() + coverage_offset);
+
+  pending_.emplace(key, std::move(payload));
+}
+
+bool FontMetadataCache::Flush() {
+  // Lookups and stores only wait for the file contents to be assembled, not
+  // for the file to be written.
+  std::lock_guard<std::mutex> flush_lock(flush_mutex_);
+  std::string path;
+  std::vector<uint64_t> flushed_keys;
+  std::vector<uint8_t> contents;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (path_.empty() || pending_.empty())
+      return true;
+    path = path_;
+
+    // Merge the mapped entries with the new ones, keeping them sorted by key.
+    std::map<uint64_t, std::pair<const uint8_t*, size_t>> entries;
+    for (size_t i = 0; i < file_entry_count_; ++i) {
+      uint64_t key = ReadValue<uint64_t>(file_index_ + i * kIndexEntrySize);
+      const uint8_t* data;
+      size_t size;
+      if (FindLocked(key, &data, &size))
+        entries[key] = std::make_pair(data, size);
+    }
+    for (const auto& pending : pending_) {
+      entries[pending.first] =
+          std::make_pair(pending.second.data(), pending.second.size());
+      flushed_keys.push_back(pending.first);
+    }
+
+    AppendValue<uint32_t>(&contents, kMagic);
+    AppendValue<uint32_t>(&contents, kFormatVersion);
+    AppendValue<uint32_t>(&contents, entries.size());
+    AppendValue<uint32_t>(&contents, 0);
+    size_t offset = kHeaderSize + entries.size() * kIndexEntrySize;
+    for (const auto& entry : entries) {
+      AppendValue<uint64_t>(&contents, entry.first);
+      AppendValue<uint32_t>(&contents, offset);
+      AppendValue<uint32_t>(&contents, entry.second.second);
+      // Keep payloads word aligned.
+      offset += (entry.second.second + 3) & ~3;
+    }
+    for (const auto& entry : entries) {
+      contents.insert(contents.end(), entry.second.first,
+                      entry.second.first + entry.second.second);
+      contents.resize((contents.size() + 3) & ~3);
+    }
+  }
+
+  // Write a temporary file and move it into place so that other processes
+  // never map a partially written cache.
+  std::string temp_path = path + ".tmp";
+  {
+    std::ofstream out(temp_path, std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char*>(contents.data()), contents.size());
+    if (!out) {
+      FXL_DLOG(WARNING) << "Could not write font metadata cache " << temp_path;
+      return false;
+    }
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (path_ != path) {
+    // The cache directory changed while the file was written.
+    std::remove(temp_path.c_str());
+    return false;
+  }
+  file_.reset();
+#if defined(_WIN32)
+  std::remove(path_.c_str());
+#endif
+  bool renamed = std::rename(temp_path.c_str(), path_.c_str()) == 0;
+  if (renamed) {
+    // Entries stored while the file was written stay pending.
+    for (uint64_t key : flushed_keys)
+      pending_.erase(key);
+  } else {
+    std::remove(temp_path.c_str());
+  }
+  MapFileLocked();
+  return renamed;
+}
+
+bool FontMetadataCache::HasPendingEntries() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return !path_.empty() && !pending_.empty();
+}
+
+size_t FontMetadataCache::GetEntryCount() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  // Stored entries are never also in the mapped file.
+  return file_entry_count_ + pending_.size();
+}
+
+}  // namespace txt
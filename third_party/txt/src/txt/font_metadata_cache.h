@@ -0,0 +1,115 @@
+/*
+ * Copyright 2018 Google Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LIB_TXT_SRC_FONT_METADATA_CACHE_H_
+#define LIB_TXT_SRC_FONT_METADATA_CACHE_H_
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "lib/fxl/macros.h"
+#include "minikin/FontFamily.h"
+#include "minikin/SparseBitSet.h"
+#include "third_party/skia/include/core/SkRefCnt.h"
+#include "third_party/skia/include/core/SkTypeface.h"
+
+namespace txt {
+
+class MappedFile;
+
+// Process wide cache of the metadata minikin computes when creating a font
+// family: the code point coverage parsed from the cmap table and the style of
+// each font.
+//
+// Entries are keyed by the identity of the font files of a family and are
+// persisted in a single versioned file in the cache directory. The file is
+// memory mapped when the directory is set, so families seen by earlier
+// launches are created without parsing their cmap tables. New entries are
+// kept in memory until Flush() rewrites the file.
+class FontMetadataCache {
+ public:
+  struct Metadata {
+    std::vector<minikin::FontStyle> styles;
+    minikin::SparseBitSet coverage;
+    bool has_vs_table = false;
+  };
+
+  // Version of the cache file format. Files with another version are ignored
+  // and replaced on the next flush.
+  static const uint32_t kFormatVersion = 1;
+
+  static FontMetadataCache& GetInstance();
+
+  // Returns a key identifying the font files of a family. The key is derived
+  // from the family name, style and table directory of each typeface along with
+  // the checksum and modification time recorded in their 'head' tables.
+  static uint64_t ComputeKey(const std::vector<sk_sp<SkTypeface>>& typefaces);
+
+  // Sets the directory of the cache file and maps any file left there by an
+  // earlier process. An empty directory disables the cache.
+  void SetCacheDirectory(const std::string& directory);
+
+  // Whether a cache directory is set. Lookups always fail and stores are
+  // dropped otherwise, so callers can skip computing keys.
+  bool IsEnabled() const;
+
+  // Fills in |metadata| and returns true if an entry for the key exists and
+  // describes |font_count| fonts.
+  bool Lookup(uint64_t key, size_t font_count, Metadata* metadata) const;
+
+  void Store(uint64_t key,
+             const std::vector<minikin::FontStyle>& styles,
+             const minikin::SparseBitSet& coverage,
+             bool has_vs_table);
+
+  // Writes the entries stored since the file was mapped. Returns false if the
+  // file could not be written. Writes the file without blocking lookups, but
+  // should still be called off the UI thread.
+  bool Flush();
+
+  // Whether a call to Flush() would write the file.
+  bool HasPendingEntries() const;
+
+  size_t GetEntryCount() const;
+
+ private:
+  mutable std::mutex mutex_;
+  // Held by Flush() while it writes the file without |mutex_|.
+  std::mutex flush_mutex_;
+  std::string path_;
+  std::unique_ptr<MappedFile> file_;
+  // Index into file_, sorted by key.
+  const uint8_t* file_index_ = nullptr;
+  size_t file_entry_count_ = 0;
+  std::map<uint64_t, std::vector<uint8_t>> pending_;
+
+  FontMetadataCache();
+
+  ~FontMetadataCache();
+
+  void MapFileLocked();
+
+  bool FindLocked(uint64_t key, const uint8_t** data, size_t* size) const;
+
+  FXL_DISALLOW_COPY_AND_ASSIGN(FontMetadataCache);
+};
+
+}  // namespace txt
+
+#endif  // LIB_TXT_SRC_FONT_METADATA_CACHE_H_
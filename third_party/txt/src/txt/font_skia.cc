@@ -40,6 +40,14 @@ hb_blob_t* GetTable(hb_face_t* face, hb_tag_t tag, void* context) {
                         HB_MEMORY_MODE_WRITABLE, buffer, free);
 }
 
+// Tables that HarfBuzz copies out of the typeface while shaping.
+const hb_tag_t kShapingTables[] = {
+    HB_TAG('c', 'm', 'a', 'p'), HB_TAG('h', 'h', 'e', 'a'),
+    HB_TAG('h', 'm', 't', 'x'), HB_TAG('k', 'e', 'r', 'n'),
+    HB_TAG('G', 'D', 'E', 'F'), HB_TAG('G', 'S', 'U', 'B'),
+    HB_TAG('G', 'P', 'O', 'S'),
+};
+
 }  // namespace
 
 FontSkia::FontSkia(sk_sp<SkTypeface> typeface)
@@ -84,6 +92,14 @@ hb_face_t* FontSkia::CreateHarfBuzzFace() const {
   return hb_face_create_for_tables(GetTable, typeface_.get(), 0);
 }
 
+size_t FontSkia::GetHarfBuzzFaceSize() const {
+  size_t size = 0;
+  for (hb_tag_t tag : kShapingTables) {
+    size += typeface_->getTableSize(tag);
+  }
+  return size;
+}
+
 const std::vector<minikin::FontVariation>& FontSkia::GetAxes() const {
   return variations_;
 }
@@ -0,0 +1,211 @@
+/*
+ * Copyright 2018 Google Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "hyphenator_cache.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+
+#include "lib/fxl/logging.h"
+#include "txt/mapped_file.h"
+#include "txt/platform.h"
+
+namespace txt {
+
+namespace {
+
+// Minimum number of characters kept before and after a hyphenation point.
+// These match the values used by the Android framework.
+const size_t kMinPrefix = 2;
+const size_t kMinSuffix = 2;
+
+// Converts a locale such as "en_US" into the lower case, hyphen separated form
+// used in pattern file names.
+std::string NormalizeLocale(const std::string& locale) {
+  std::string result(locale);
+  for (char& c : result) {
+    c = (c == '_') ? '-' : std::tolower(static_cast<unsigned char>(c));
+  }
+  return result;
+}
+
+// The layout of the header of .hyb files, as written by mk_hyb_file.py. The
+// tables it points at start with the fields below.
+const uint32_t kPatternFileMagic = 0x62ad7968;
+const uint32_t kPatternFileVersion = 0;
+const size_t kHeaderSize = 6 * sizeof(uint32_t);
+const size_t kAlphabetTable0HeaderSize = 3 * sizeof(uint32_t);
+const size_t kAlphabetTable1HeaderSize = 2 * sizeof(uint32_t);
+const size_t kTrieHeaderSize = 6 * sizeof(uint32_t);
+const size_t kPatternHeaderSize = 4 * sizeof(uint32_t);
+
+uint32_t ReadWord(const MappedFile& file, size_t offset) {
+  uint32_t word;
+  memcpy(&word, file.data() + offset, sizeof(word));
+  return word;
+}
+
+// Whether |size| bytes from |offset| lie within the file. |offset| is known to
+// be within the file.
+bool FitsInFile(const MappedFile& file, size_t offset, uint64_t size) {
+  return size <= file.size() - offset;
+}
+
+// Whether the table at |offset| starts after the header, is aligned, and has a
+// header of |header_size| bytes within the file.
+bool IsValidTableOffset(const MappedFile& file,
+                        uint32_t offset,
+                        size_t header_size) {
+  return offset >= kHeaderSize && offset % sizeof(uint32_t) == 0 &&
+         offset < file.size() && FitsInFile(file, offset, header_size);
+}
+
+// Checks the header of a .hyb file and the sizes of its tables against the
+// size of the mapping, so that minikin never reads past its end. minikin does
+// not check the file itself.
+bool IsValidPatternFile(const MappedFile& file) {
+  if (file.size() < kHeaderSize)
+    return false;
+  if (ReadWord(file, 0) != kPatternFileMagic ||
+      ReadWord(file, 4) != kPatternFileVersion)
+    return false;
+  const uint32_t alphabet_offset = ReadWord(file, 8);
+  const uint32_t trie_offset = ReadWord(file, 12);
+  const uint32_t pattern_offset = ReadWord(file, 16);
+  const uint32_t file_size = ReadWord(file, 20);
+  if (file_size > file.size())
+    return false;
+
+  if (!IsValidTableOffset(file, alphabet_offset, kAlphabetTable1HeaderSize))
+    return false;
+  const uint32_t alphabet_version = ReadWord(file, alphabet_offset);
+  if (alphabet_version == 0) {
+    if (!IsValidTableOffset(file, alphabet_offset, kAlphabetTable0HeaderSize))
+      return false;
+    const uint32_t min_codepoint = ReadWord(file, alphabet_offset + 4);
+    const uint32_t max_codepoint = ReadWord(file, alphabet_offset + 8);
+    if (min_codepoint > max_codepoint ||
+        !FitsInFile(file, alphabet_offset,
+                    kAlphabetTable0HeaderSize + max_codepoint - min_codepoint))
+      return false;
+  } else if (alphabet_version == 1) {
+    const uint64_t entries = ReadWord(file, alphabet_offset + 4);
+    if (!FitsInFile(file, alphabet_offset,
+                    kAlphabetTable1HeaderSize + entries * sizeof(uint32_t)))
+      return false;
+  } else {
+    return false;
+  }
+
+  if (!IsValidTableOffset(file, trie_offset, kTrieHeaderSize))
+    return false;
+  const uint64_t trie_entries = ReadWord(file, trie_offset + 20);
+  if (!FitsInFile(file, trie_offset,
+                  kTrieHeaderSize + trie_entries * sizeof(uint32_t)))
+    return false;
+
+  if (!IsValidTableOffset(file, pattern_offset, kPatternHeaderSize))
+    return false;
+  const uint64_t pattern_entries = ReadWord(file, pattern_offset + 4);
+  const uint64_t pattern_buffer_offset = ReadWord(file, pattern_offset + 8);
+  const uint64_t pattern_buffer_size = ReadWord(file, pattern_offset + 12);
+  return FitsInFile(file, pattern_offset,
+                    kPatternHeaderSize + pattern_entries * sizeof(uint32_t)) &&
+         FitsInFile(file, pattern_offset,
+                    pattern_buffer_offset + pattern_buffer_size);
+}
+
+}  // namespace
+
+HyphenatorCache& HyphenatorCache::GetInstance() {
+  // Intentionally leaked so that hyphenators stay valid during shutdown.
+  static HyphenatorCache* instance = new HyphenatorCache();
+  return *instance;
+}
+
+HyphenatorCache::HyphenatorCache()
+    : directory_(GetHyphenationPatternDirectory()) {}
+
+HyphenatorCache::~HyphenatorCache() = default;
+
+void HyphenatorCache::SetPatternDirectory(std::string directory) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  directory_ = std::move(directory);
+}
+
+std::string HyphenatorCache::GetPatternDirectory() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return directory_;
+}
+
+minikin::Hyphenator* HyphenatorCache::GetHyphenator(const std::string& locale) {
+  std::string key = NormalizeLocale(locale);
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto found = entries_.find(key);
+  if (found != entries_.end())
+    return found->second->hyphenator.get();
+
+  auto entry = std::make_unique<Entry>();
+  entry->patterns = OpenPatternsLocked(key);
+  const uint8_t* pattern_data = nullptr;
+  if (entry->patterns) {
+    pattern_data = entry->patterns->data();
+    mapped_bytes_ += entry->patterns->size();
+  }
+  entry->hyphenator.reset(
+      minikin::Hyphenator::loadBinary(pattern_data, kMinPrefix, kMinSuffix));
+
+  minikin::Hyphenator* result = entry->hyphenator.get();
+  entries_.emplace(std::move(key), std::move(entry));
+  return result;
+}
+
+size_t HyphenatorCache::GetMappedBytes() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return mapped_bytes_;
+}
+
+std::unique_ptr<MappedFile> HyphenatorCache::OpenPatternsLocked(
+    const std::string& locale) {
+  if (directory_.empty() || locale.empty())
+    return nullptr;
+
+  // Try the full locale first and then drop trailing subtags.
+  std::string name = locale;
+  while (true) {
+    std::unique_ptr<MappedFile> file =
+        MappedFile::Open(directory_ + "/hyph-" + name + ".hyb");
+    if (file) {
+      if (!IsValidPatternFile(*file)) {
+        // A corrupt file for the full locale does not make a file for a
+        // shorter one any better, so do not hyphenate at all.
+        FXL_LOG(ERROR) << "Invalid hyphenation patterns for " << locale << ".";
+        return nullptr;
+      }
+      FXL_DLOG(INFO) << "Mapped hyphenation patterns for " << locale << " ("
+                     << file->size() << " bytes).";
+      return file;
+    }
+    size_t separator = name.rfind('-');
+    if (separator == std::string::npos)
+      return nullptr;
+    name.erase(separator);
+  }
+}
+
+}  // namespace txt
@@ -0,0 +1,84 @@
+/*
+ * Copyright 2018 Google Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LIB_TXT_SRC_HYPHENATOR_CACHE_H_
+#define LIB_TXT_SRC_HYPHENATOR_CACHE_H_
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "lib/fxl/macros.h"
+#include "minikin/Hyphenator.h"
+
+namespace txt {
+
+class MappedFile;
+
+// Process wide cache of minikin hyphenators keyed by locale.
+//
+// Hyphenation patterns are stored in the binary "hyb" format produced by
+// Android's mk_hyb_file.py, one file per locale named "hyph-<locale>.hyb"
+// (for example "hyph-en-us.hyb"). A locale's file is only opened the first
+// time a paragraph with that locale asks for hyphenation. The file is memory
+// mapped and handed to minikin as is, so loading patterns neither parses nor
+// copies them.
+//
+// Hyphenators are never released once created, which allows callers such as
+// minikin::LineBreaker to keep raw pointers to them.
+class HyphenatorCache {
+ public:
+  static HyphenatorCache& GetInstance();
+
+  // Sets the directory searched for pattern files. Only affects locales that
+  // have not been looked up yet.
+  void SetPatternDirectory(std::string directory);
+
+  std::string GetPatternDirectory() const;
+
+  // Returns the hyphenator for the locale. The locale is matched against the
+  // pattern files from most to least specific subtag, so "en-US" uses
+  // "hyph-en-us.hyb" if present and "hyph-en.hyb" otherwise. Locales without
+  // patterns get a hyphenator that only breaks at soft hyphens.
+  minikin::Hyphenator* GetHyphenator(const std::string& locale);
+
+  // Total size of the pattern files currently mapped into memory.
+  size_t GetMappedBytes() const;
+
+ private:
+  struct Entry {
+    std::unique_ptr<MappedFile> patterns;
+    std::unique_ptr<minikin::Hyphenator> hyphenator;
+  };
+
+  mutable std::mutex mutex_;
+  std::string directory_;
+  std::unordered_map<std::string, std::unique_ptr<Entry>> entries_;
+  size_t mapped_bytes_ = 0;
+
+  HyphenatorCache();
+
+  ~HyphenatorCache();
+
+  std::unique_ptr<MappedFile> OpenPatternsLocked(const std::string& locale);
+
+  FXL_DISALLOW_COPY_AND_ASSIGN(HyphenatorCache);
+};
+
+}  // namespace txt
+
+#endif  // LIB_TXT_SRC_HYPHENATOR_CACHE_H_
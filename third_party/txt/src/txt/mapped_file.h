@@ -0,0 +1,52 @@
+/*
+ * Copyright 2018 Google Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LIB_TXT_SRC_MAPPED_FILE_H_
+#define LIB_TXT_SRC_MAPPED_FILE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "lib/fxl/macros.h"
+
+namespace txt {
+
+// A read-only memory mapping of a file.
+class MappedFile {
+ public:
+  // Returns null if the file does not exist or is empty.
+  static std::unique_ptr<MappedFile> Open(const std::string& path);
+
+  ~MappedFile();
+
+  const uint8_t* data() const { return static_cast<const uint8_t*>(data_); }
+
+  size_t size() const { return size_; }
+
+ private:
+  void* data_;
+  size_t size_;
+
+  MappedFile(void* data, size_t size);
+
+  FXL_DISALLOW_COPY_AND_ASSIGN(MappedFile);
+};
+
+}  // namespace txt
+
+#endif  // LIB_TXT_SRC_MAPPED_FILE_H_
@@ -27,6 +27,7 @@
 #include <minikin/Layout.h>
 #include "font_collection.h"
 #include "font_skia.h"
+#include "hyphenator_cache.h"
 #include "lib/fxl/logging.h"
 #include "minikin/FontLanguageListCache.h"
 #include "minikin/GraphemeBreak.h"
@@ -34,6 +35,7 @@
 #include "minikin/LayoutUtils.h"
 #include "minikin/LineBreaker.h"
 #include "minikin/MinikinFont.h"
+#include "text_scanner.h"
 #include "third_party/icu/source/common/unicode/ubidi.h"
 #include "third_party/skia/include/core/SkCanvas.h"
 #include "third_party/skia/include/core/SkPaint.h"
@@ -164,59 +166,64 @@ void FindWords(const std::vector<uint16_t>& text,
                size_t start,
                size_t end,
                std::vector<Paragraph::Range<size_t>>* words) {
-  bool in_word = false;
-  size_t word_start;
-  for (size_t i = start; i < end; ++i) {
-    bool is_space = minikin::isWordSpace(text[i]);
-    if (!in_word && !is_space) {
-      word_start = i;
-      in_word = true;
-    } else if (in_word && is_space) {
-      words->emplace_back(word_start, i);
-      in_word = false;
-    }
+  size_t word_end = start;
+  while (word_end < end) {
+    size_t word_start = FindWordSpace(text.data(), word_end, end, false);
+    if (word_start == end)
+      break;
+    word_end = FindWordSpace(text.data(), word_start, end, true);
+    words->emplace_back(word_start, word_end);
   }
-  if (in_word)
-    words->emplace_back(word_start, end);
 }
 
 }  // namespace
 
 static const float kDoubleDecorationSpacing = 3.0f;
 
-Paragraph::GlyphPosition::GlyphPosition(double x_start,
-                                        double x_advance,
-                                        size_t code_unit_index,
-                                        size_t code_unit_width)
-    : code_units(code_unit_index, code_unit_index + code_unit_width),
-      x_pos(x_start, x_start + x_advance) {}
+void Paragraph::GlyphPositions::push_back(double x_s,
+                                          double x_e,
+                                          size_t cu_s,
+                                          size_t cu_e) {
+  x_start.push_back(x_s);
+  x_end.push_back(x_e);
+  code_unit_start.push_back(cu_s);
+  code_unit_end.push_back(cu_e);
+}
+
+void Paragraph::GlyphPositions::Shift(size_t begin, size_t end, double delta) {
+  for (size_t i = begin; i < end; ++i) {
+    x_start[i] += delta;
+    x_end[i] += delta;
+  }
+}
 
-void Paragraph::GlyphPosition::Shift(double delta) {
-  x_pos.Shift(delta);
+void Paragraph::GlyphPositions::clear() {
+  x_start.clear();
+  x_end.clear();
+  code_unit_start.clear();
+  code_unit_end.clear();
 }
 
-Paragraph::GlyphLine::GlyphLine(std::vector<GlyphPosition>&& p, size_t tcu)
-    : positions(std::move(p)), total_code_units(tcu) {}
+void Paragraph::GlyphPositions::reserve(size_t count) {
+  x_start.reserve(count);
+  x_end.reserve(count);
+  code_unit_start.reserve(count);
+  code_unit_end.reserve(count);
+}
 
-Paragraph::CodeUnitRun::CodeUnitRun(std::vector<GlyphPosition>&& p,
+Paragraph::CodeUnitRun::CodeUnitRun(Range<size_t> g,
                                     Range<size_t> cu,
                                     Range<double> x,
                                     size_t line,
                                     const SkPaint::FontMetrics& metrics,
                                     TextDirection dir)
-    : positions(std::move(p)),
+    : glyphs(g),
       code_units(cu),
       x_pos(x),
       line_number(line),
       font_metrics(metrics),
       direction(dir) {}
 
-void Paragraph::CodeUnitRun::Shift(double delta) {
-  x_pos.Shift(delta);
-  for (GlyphPosition& position : positions)
-    position.Shift(delta);
-}
-
 Paragraph::Paragraph() {
   breaker_.setLocale(icu::Locale(), nullptr);
 }
@@ -235,13 +242,25 @@ bool Paragraph::ComputeLineBreaks() {
   line_ranges_.clear();
   line_widths_.clear();
 
-  std::vector<size_t> newline_positions;
-  for (size_t i = 0; i < text_.size(); ++i) {
-    ULineBreak ulb = static_cast<ULineBreak>(
-        u_getIntPropertyValue(text_[i], UCHAR_LINE_BREAK));
-    if (ulb == U_LB_LINE_FEED || ulb == U_LB_MANDATORY_BREAK)
-      newline_positions.push_back(i);
+  // Hyphenation patterns are only loaded once a paragraph asks for them.
+  minikin::Hyphenator* hyphenator = nullptr;
+  if (paragraph_style_.hyphenation_frequency !=
+      minikin::kHyphenationFrequency_None) {
+    hyphenator =
+        HyphenatorCache::GetInstance().GetHyphenator(paragraph_style_.locale);
   }
+  if (paragraph_style_.locale != breaker_locale_ ||
+      hyphenator != breaker_hyphenator_) {
+    breaker_.setLocale(paragraph_style_.locale.empty()
+                           ? icu::Locale()
+                           : icu::Locale(paragraph_style_.locale.c_str()),
+                       hyphenator);
+    breaker_locale_ = paragraph_style_.locale;
+    breaker_hyphenator_ = hyphenator;
+  }
+
+  std::vector<size_t> newline_positions;
+  FindMandatoryLineBreaks(text_.data(), 0, text_.size(), &newline_positions);
   newline_positions.push_back(text_.size());
 
   size_t run_index = 0;
@@ -262,6 +281,7 @@ bool Paragraph::ComputeLineBreaks() {
     breaker_.setLineWidths(0.0f, 0, width_);
     breaker_.setJustified(paragraph_style_.text_align == TextAlign::justify);
     breaker_.setStrategy(paragraph_style_.break_strategy);
+    breaker_.setHyphenationFrequency(paragraph_style_.hyphenation_frequency);
     breaker_.resize(block_size);
     memcpy(breaker_.buffer(), text_.data() + block_start,
            block_size * sizeof(text_[0]));
@@ -299,6 +319,7 @@ bool Paragraph::ComputeLineBreaks() {
 
     size_t breaks_count = breaker_.computeBreaks();
     const int* breaks = breaker_.getBreaks();
+    const int* flags = breaker_.getFlags();
     for (size_t i = 0; i < breaks_count; ++i) {
       size_t break_start = (i > 0) ? breaks[i - 1] : 0;
       size_t line_start = break_start + block_start;
@@ -312,9 +333,12 @@ bool Paragraph::ComputeLineBreaks() {
           minikin::isLineEndSpace(text_[line_end_excluding_whitespace - 1])) {
         line_end_excluding_whitespace--;
       }
-      line_ranges_.emplace_back(line_start, line_end,
-                                line_end_excluding_whitespace,
-                                line_end_including_newline, hard_break);
+      uint32_t hyphen_edit =
+          flags[i] & (minikin::HyphenEdit::MASK_START_OF_LINE |
+                      minikin::HyphenEdit::MASK_END_OF_LINE);
+      line_ranges_.emplace_back(
+          line_start, line_end, line_end_excluding_whitespace,
+          line_end_including_newline, hard_break, hyphen_edit);
       line_widths_.push_back(breaker_.getWidths()[i]);
     }
 
@@ -422,23 +446,31 @@ void Paragraph::Layout(double width, bool force) {
   if (!ComputeLineBreaks())
     return;
 
-  std::vector<BidiRun> bidi_runs;
-  if (!ComputeBidiRuns(&bidi_runs))
+  bidi_runs_.clear();
+  if (!ComputeBidiRuns(&bidi_runs_))
     return;
 
+  // Only measure the lines here. The glyph positions and text blobs needed for
+  // painting and hit testing are built on demand by BuildPaintData, so callers
+  // that only need the size of the paragraph never pay for them.
+  records_.clear();
+  glyph_positions_.clear();
+  line_glyph_starts_.clear();
+  code_unit_order_.clear();
+  code_unit_runs_.clear();
+  run_layouts_.clear();
+  needs_paint_data_ = true;
+
   SkPaint paint;
   paint.setAntiAlias(true);
   paint.setTextEncoding(SkPaint::kGlyphID_TextEncoding);
   paint.setSubpixelText(true);
   paint.setHinting(SkPaint::kSlight_Hinting);
 
-  records_.clear();
   line_heights_.clear();
-  glyph_lines_.clear();
-  code_unit_runs_.clear();
+  line_baselines_.clear();
+  line_y_offsets_.clear();
 
-  minikin::Layout layout;
-  SkTextBlobBuilder builder;
   double y_offset = 0;
   double prev_max_descent = 0;
   double max_word_width = 0;
@@ -449,98 +481,62 @@ void Paragraph::Layout(double width, bool force) {
   for (size_t line_number = 0; line_number < line_limit; ++line_number) {
     const LineRange& line_range = line_ranges_[line_number];
 
-    // Break the line into words if justification should be applied.
     std::vector<Range<size_t>> words;
-    double word_gap_width = 0;
-    size_t word_index = 0;
-    bool justify_line =
-        (paragraph_style_.text_align == TextAlign::justify &&
-         line_number != line_limit - 1 && !line_range.hard_break);
     FindWords(text_, line_range.start, line_range.end, &words);
-    if (justify_line) {
-      if (words.size() > 1) {
-        word_gap_width =
-            (width_ - line_widths_[line_number]) / (words.size() - 1);
-      }
-    }
 
-    // Exclude trailing whitespace from right-justified lines so the last
-    // visible character in the line will be flush with the right margin.
-    size_t line_end_index =
-        (paragraph_style_.effective_align() == TextAlign::right ||
-         paragraph_style_.effective_align() == TextAlign::center)
-            ? line_range.end_excluding_whitespace
-            : line_range.end;
-
-    // Find the runs comprising this line.
-    std::vector<BidiRun> line_runs;
-    for (const BidiRun& bidi_run : bidi_runs) {
-      if (bidi_run.start() < line_end_index &&
-          bidi_run.end() > line_range.start) {
-        line_runs.emplace_back(std::max(bidi_run.start(), line_range.start),
-                               std::min(bidi_run.end(), line_end_index),
-                               bidi_run.direction(), bidi_run.style());
+    double max_line_spacing = 0;
+    double max_descent = 0;
+    bool has_glyphs = false;
+    auto update_line_metrics = [&](const SkPaint::FontMetrics& metrics,
+                                   const TextStyle& style) {
+      double line_spacing =
+          (line_number == 0)
+              ? -metrics.fAscent * style.height
+              : (-metrics.fAscent + metrics.fLeading) * style.height;
+      if (line_spacing > max_line_spacing) {
+        max_line_spacing = line_spacing;
+        if (line_number == 0) {
+          alphabetic_baseline_ = line_spacing;
+          // TODO(garyq): Properly implement ideographic_baseline_.
+          ideographic_baseline_ =
+              (metrics.fUnderlinePosition - metrics.fAscent) * style.height;
+        }
       }
-    }
+      max_line_spacing = std::max(line_spacing, max_line_spacing);
+
+      double descent = metrics.fDescent * style.height;
+      max_descent = std::max(descent, max_descent);
+    };
 
-    std::vector<GlyphPosition> line_glyph_positions;
-    std::vector<CodeUnitRun> line_code_unit_runs;
+    std::vector<BidiRun> line_runs = GetLineRuns(line_range);
     double run_x_offset = 0;
-    double justify_x_offset = 0;
-    std::vector<PaintRecord> paint_records;
 
     for (auto line_run_it = line_runs.begin(); line_run_it != line_runs.end();
          ++line_run_it) {
       const BidiRun& run = *line_run_it;
       minikin::FontStyle font;
       minikin::MinikinPaint minikin_paint;
-      GetFontAndMinikinPaint(run.style(), &font, &minikin_paint);
+      GetRunFontAndMinikinPaint(line_range, run, &font, &minikin_paint);
       paint.setTextSize(run.style().font_size);
 
       std::shared_ptr<minikin::FontCollection> minikin_font_collection =
           GetMinikinFontCollectionForStyle(run.style());
+      run_layouts_.emplace_back(minikin_font_collection);
+      RunLayout& run_layout = run_layouts_.back();
+      minikin::Layout& layout = run_layout.layout;
 
-      // Lay out this run.
       uint16_t* text_ptr = text_.data();
       size_t text_start = run.start();
       size_t text_count = run.end() - run.start();
 
-      // Apply ellipsizing if the run was not completely laid out and this
-      // is the last line (or lines are unlimited).
-      const std::u16string& ellipsis = paragraph_style_.ellipsis;
-      std::vector<uint16_t> ellipsized_text;
-      if (ellipsis.length() && !isinf(width_) && !line_range.hard_break &&
-          line_run_it == line_runs.end() - 1 &&
-          (line_number == line_limit - 1 ||
-           paragraph_style_.unlimited_lines())) {
-        float ellipsis_width = layout.measureText(
-            reinterpret_cast<const uint16_t*>(ellipsis.data()), 0,
-            ellipsis.length(), ellipsis.length(), run.is_rtl(), font,
-            minikin_paint, minikin_font_collection, nullptr);
-
-        std::vector<float> text_advances(text_count);
-        float text_width = layout.measureText(
-            text_ptr, text_start, text_count, text_.size(), run.is_rtl(), font,
-            minikin_paint, minikin_font_collection, text_advances.data());
-
-        // Truncate characters from the text until the ellipsis fits.
-        size_t truncate_count = 0;
-        while (truncate_count < text_count &&
-               run_x_offset + text_width + ellipsis_width > width_) {
-          text_width -= text_advances[text_count - truncate_count - 1];
-          truncate_count++;
-        }
-
-        ellipsized_text.reserve(text_count - truncate_count +
-                                ellipsis.length());
-        ellipsized_text.insert(ellipsized_text.begin(),
-                               text_.begin() + run.start(),
-                               text_.begin() + run.end() - truncate_count);
-        ellipsized_text.insert(ellipsized_text.end(), ellipsis.begin(),
-                               ellipsis.end());
-        text_ptr = ellipsized_text.data();
+      if (ShouldEllipsizeRun(line_range, line_number, line_limit,
+                             line_run_it == line_runs.end() - 1)) {
+        run_layout.ellipsized_text =
+            EllipsizeRun(run, font, minikin_paint, minikin_font_collection,
+                         run_x_offset, &layout);
+        text_ptr = run_layout.ellipsized_text.data();
         text_start = 0;
-        text_count = ellipsized_text.size();
+        text_count = run_layout.ellipsized_text.size();
 
         // If there is no line limit, then skip all lines after the ellipsized
         // line.
@@ -553,198 +549,36 @@ void Paragraph::Layout(double width, bool force) {
       layout.doLayout(text_ptr, text_start, text_count, text_.size(),
                       run.is_rtl(), font, minikin_paint,
                       minikin_font_collection);
-
       if (layout.nGlyphs() == 0)
         continue;
 
-      std::vector<float> layout_advances(text_count);
-      layout.getAdvances(layout_advances.data());
-
-      // Break the layout into blobs that share the same SkPaint parameters.
-      std::vector<Range<size_t>> glyph_blobs = GetLayoutTypefaceRuns(layout);
-
-      double word_start_position = std::numeric_limits<double>::quiet_NaN();
-
-      // Build a Skia text blob from each group of glyphs.
-      for (const Range<size_t>& glyph_blob : glyph_blobs) {
-        std::vector<GlyphPosition> glyph_positions;
-
-        GetGlyphTypeface(layout, glyph_blob.start).apply(paint);
-        const SkTextBlobBuilder::RunBuffer& blob_buffer =
-            builder.allocRunPos(paint, glyph_blob.end - glyph_blob.start);
-
-        for (size_t glyph_index = glyph_blob.start;
-             glyph_index < glyph_blob.end;) {
-          size_t cluster_start_glyph_index = glyph_index;
-          uint32_t cluster = layout.getGlyphCluster(cluster_start_glyph_index);
-          double glyph_x_offset;
-
-          // Add all the glyphs in this cluster to the text blob.
-          do {
-            size_t blob_index = glyph_index - glyph_blob.start;
-            blob_buffer.glyphs[blob_index] = layout.getGlyphId(glyph_index);
-
-            size_t pos_index = blob_index * 2;
-            blob_buffer.pos[pos_index] =
-                layout.getX(glyph_index) + justify_x_offset;
-            blob_buffer.pos[pos_index + 1] = layout.getY(glyph_index);
-
-            if (glyph_index == cluster_start_glyph_index)
-              glyph_x_offset = blob_buffer.pos[pos_index];
-
-            glyph_index++;
-          } while (glyph_index < glyph_blob.end &&
-                   layout.getGlyphCluster(glyph_index) == cluster);
-
-          Range<int32_t> glyph_code_units(cluster, 0);
-          std::vector<size_t> grapheme_code_unit_counts;
-          if (run.is_rtl()) {
-            if (cluster_start_glyph_index > 0) {
-              glyph_code_units.end =
-                  layout.getGlyphCluster(cluster_start_glyph_index - 1);
-            } else {
-              glyph_code_units.end = text_count;
-            }
-            grapheme_code_unit_counts.push_back(glyph_code_units.width());
-          } else {
-            if (glyph_index < layout.nGlyphs()) {
-              glyph_code_units.end = layout.getGlyphCluster(glyph_index);
-            } else {
-              glyph_code_units.end = text_count;
-            }
-
-            // The glyph may be a ligature.  Determine how many graphemes are
-            // joined into this glyph and how many input code units map to
-            // each grapheme.
-            size_t code_unit_count = 1;
-            for (int32_t offset = glyph_code_units.start + 1;
-                 offset < glyph_code_units.end; ++offset) {
-              if (minikin::GraphemeBreak::isGraphemeBreak(
-                      layout_advances.data(), text_ptr, text_start, text_count,
-                      offset)) {
-                grapheme_code_unit_counts.push_back(code_unit_count);
-                code_unit_count = 1;
-              } else {
-                code_unit_count++;
-              }
-            }
-            grapheme_code_unit_counts.push_back(code_unit_count);
-          }
-          float glyph_advance = layout.getCharAdvance(glyph_code_units.start);
-          float grapheme_advance =
-              glyph_advance / grapheme_code_unit_counts.size();
-
-          glyph_positions.emplace_back(run_x_offset + glyph_x_offset,
-                                       grapheme_advance,
-                                       run.start() + glyph_code_units.start,
-                                       grapheme_code_unit_counts[0]);
-
-          // Compute positions for the additional graphemes in the ligature.
-          for (size_t i = 1; i < grapheme_code_unit_counts.size(); ++i) {
-            glyph_positions.emplace_back(
-                glyph_positions.back().x_pos.end, grapheme_advance,
-                glyph_positions.back().code_units.start +
-                    grapheme_code_unit_counts[i - 1],
-                grapheme_code_unit_counts[i]);
-          }
-
-          if (word_index < words.size() &&
-              words[word_index].start == run.start() + glyph_code_units.start) {
-            word_start_position = run_x_offset + glyph_x_offset;
-          }
-
-          if (word_index < words.size() &&
-              words[word_index].end == run.start() + glyph_code_units.end) {
-            if (justify_line)
-              justify_x_offset += word_gap_width;
-            word_index++;
-
-            if (!isnan(word_start_position)) {
-              double word_width =
-                  glyph_positions.back().x_pos.end - word_start_position;
-              max_word_width = std::max(word_width, max_word_width);
-              word_start_position = std::numeric_limits<double>::quiet_NaN();
-            }
-          }
-        }
-
-        if (glyph_positions.empty())
-          continue;
-
+      for (const Range<size_t>& glyph_run : GetLayoutTypefaceRuns(layout)) {
         SkPaint::FontMetrics metrics;
+        GetGlyphTypeface(layout, glyph_run.start).apply(paint);
         paint.getFontMetrics(&metrics);
-        paint_records.emplace_back(run.style(), SkPoint::Make(run_x_offset, 0),
-                                   builder.make(), metrics, line_number,
-                                   layout.getAdvance());
-
-        line_glyph_positions.insert(line_glyph_positions.end(),
-                                    glyph_positions.begin(),
-                                    glyph_positions.end());
-
-        // Add a record of glyph positions sorted by code unit index.
-        std::vector<GlyphPosition> code_unit_positions(glyph_positions);
-        std::sort(code_unit_positions.begin(), code_unit_positions.end(),
-                  [](const GlyphPosition& a, const GlyphPosition& b) {
-                    return a.code_units.start < b.code_units.start;
-                  });
-        line_code_unit_runs.emplace_back(
-            std::move(code_unit_positions),
-            Range<size_t>(run.start(), run.end()),
-            Range<double>(glyph_positions.front().x_pos.start,
-                          glyph_positions.back().x_pos.end),
-            line_number, metrics, run.direction());
+        update_line_metrics(metrics, run.style());
+        has_glyphs = true;
       }
 
-      run_x_offset += layout.getAdvance();
-    }
-
-    // Adjust the glyph positions based on the alignment of the line.
-    double line_x_offset = GetLineXOffset(run_x_offset);
-    if (line_x_offset) {
-      for (CodeUnitRun& code_unit_run : line_code_unit_runs) {
-        code_unit_run.Shift(line_x_offset);
-      }
-      for (GlyphPosition& position : line_glyph_positions) {
-        position.Shift(line_x_offset);
-      }
-    }
-
-    size_t next_line_start = (line_number < line_ranges_.size() - 1)
-                                 ? line_ranges_[line_number + 1].start
-                                 : text_.size();
-    glyph_lines_.emplace_back(std::move(line_glyph_positions),
-                              next_line_start - line_range.start);
-    code_unit_runs_.insert(code_unit_runs_.end(), line_code_unit_runs.begin(),
-                           line_code_unit_runs.end());
-
-    double max_line_spacing = 0;
-    double max_descent = 0;
-    auto update_line_metrics = [&](const SkPaint::FontMetrics& metrics,
-                                   const TextStyle& style) {
-      double line_spacing =
-          (line_number == 0)
-              ? -metrics.fAscent * style.height
-              : (-metrics.fAscent + metrics.fLeading) * style.height;
-      if (line_spacing > max_line_spacing) {
-        max_line_spacing = line_spacing;
-        if (line_number == 0) {
-          alphabetic_baseline_ = line_spacing;
-          // TODO(garyq): Properly implement ideographic_baseline_.
-          ideographic_baseline_ =
-              (metrics.fUnderlinePosition - metrics.fAscent) * style.height;
-        }
+      // Track the widest word within the run to compute the minimum intrinsic
+      // width.
+      std::vector<float> advances(text_count);
+      layout.getAdvances(advances.data());
+      for (const Range<size_t>& word : words) {
+        if (word.start < run.start() || word.end > run.start() + text_count)
+          continue;
+        double word_width =
+            std::accumulate(advances.begin() + (word.start - run.start()),
+                            advances.begin() + (word.end - run.start()), 0.0);
+        max_word_width = std::max(word_width, max_word_width);
       }
-      max_line_spacing = std::max(line_spacing, max_line_spacing);
 
-      double descent = metrics.fDescent * style.height;
-      max_descent = std::max(descent, max_descent);
-    };
-    for (const PaintRecord& paint_record : paint_records) {
-      update_line_metrics(paint_record.metrics(), paint_record.style());
+      run_x_offset += layout.getAdvance();
     }
+
     // If no fonts were actually rendered, then compute a baseline based on the
     // font of the paragraph style.
-    if (paint_records.empty()) {
+    if (!has_glyphs) {
       SkPaint::FontMetrics metrics;
       TextStyle style(paragraph_style_.GetTextStyle());
       paint.setTypeface(GetDefaultSkiaTypeface(style));
@@ -757,13 +591,8 @@ void Paragraph::Layout(double width, bool force) {
                             round(max_line_spacing + max_descent));
     line_baselines_.push_back(line_heights_.back() - max_descent);
     y_offset += round(max_line_spacing + prev_max_descent);
+    line_y_offsets_.push_back(y_offset);
     prev_max_descent = max_descent;
-
-    for (PaintRecord& paint_record : paint_records) {
-      paint_record.SetOffset(
-          SkPoint::Make(paint_record.offset().x() + line_x_offset, y_offset));
-      records_.emplace_back(std::move(paint_record));
-    }
   }
 
   max_intrinsic_width_ = 0;
@@ -783,6 +612,184 @@ void Paragraph::Layout(double width, bool force) {
   } else {
     min_intrinsic_width_ = std::min(max_word_width, max_intrinsic_width_);
   }
+}
+
+void Paragraph::BuildPaintData() const {
+  if (!needs_paint_data_)
+    return;
+  needs_paint_data_ = false;
+
+  SkPaint paint;
+  paint.setAntiAlias(true);
+  paint.setTextEncoding(SkPaint::kGlyphID_TextEncoding);
+  paint.setSubpixelText(true);
+  paint.setHinting(SkPaint::kSlight_Hinting);
+
+  records_.clear();
+  glyph_positions_.clear();
+  line_glyph_starts_.clear();
+  code_unit_order_.clear();
+  code_unit_runs_.clear();
+
+  // Most code units produce one glyph, so size the storage for the text up
+  // front rather than growing it glyph by glyph.
+  glyph_positions_.reserve(text_.size());
+  code_unit_order_.reserve(text_.size());
+  line_glyph_starts_.reserve(line_heights_.size() + 1);
+
+  SkTextBlobBuilder builder;
+  size_t run_layout_index = 0;
+
+  // The line limit as seen by Layout() before any ellipsizing, which decides
+  // whether a line is the last one for justification.
+  size_t line_limit = std::min(paragraph_style_.max_lines, line_ranges_.size());
+
+  for (size_t line_number = 0; line_number < line_heights_.size();
+       ++line_number) {
+    const LineRange& line_range = line_ranges_[line_number];
+
+    // Break the line into words if justification should be applied.
+    std::vector<Range<size_t>> words;
+    double word_gap_width = 0;
+    size_t word_index = 0;
+    bool justify_line =
+        (paragraph_style_.text_align == TextAlign::justify &&
+         line_number != line_limit - 1 && !line_range.hard_break);
+    FindWords(text_, line_range.start, line_range.end, &words);
+    if (justify_line) {
+      if (words.size() > 1) {
+        word_gap_width =
+            (width_ - line_widths_[line_number]) / (words.size() - 1);
+      }
+    }
+
+    std::vector<BidiRun> line_runs = GetLineRuns(line_range);
+    size_t line_glyph_start = glyph_positions_.size();
+    size_t line_code_unit_run_start = code_unit_runs_.size();
+    size_t line_record_start = records_.size();
+    line_glyph_starts_.push_back(line_glyph_start);
+    double run_x_offset = 0;
+    double justify_x_offset = 0;
+
+    for (auto line_run_it = line_runs.begin(); line_run_it != line_runs.end();
+         ++line_run_it) {
+      const BidiRun& run = *line_run_it;
+      minikin::FontStyle font;
+      minikin::MinikinPaint minikin_paint;
+      GetRunFontAndMinikinPaint(line_range, run, &font, &minikin_paint);
+      paint.setTextSize(run.style().font_size);
+
+      // The run was shaped by Layout().
+      FXL_DCHECK(run_layout_index < run_layouts_.size());
+      RunLayout& run_layout = run_layouts_[run_layout_index++];
+      const uint16_t* text_ptr = text_.data();
+      size_t text_start = run.start();
+      size_t text_count = run.end() - run.start();
+      if (!run_layout.ellipsized_text.empty()) {
+        text_ptr = run_layout.ellipsized_text.data();
+        text_start = 0;
+        text_count = run_layout.ellipsized_text.size();
+      }
+
+      // Runs that are neither justified, ellipsized nor hyphenated do not
+      // depend on the rest of the line, so their blobs can be shared with any
+      // other paragraph that lays out the same text with the same style.
+      TextBlobCache& blob_cache = font_collection_->GetTextBlobCache();
+      std::unique_ptr<TextBlobCache::Key> cache_key;
+      std::shared_ptr<const ShapedRun> shaped_run;
+      if (!justify_line && run_layout.ellipsized_text.empty() &&
+          minikin_paint.hyphenEdit == minikin::HyphenEdit::NO_EDIT) {
+        size_t context_start = minikin::getPrevWordBreakForCache(
+            text_.data(), run.start() + 1, text_.size());
+        size_t context_end = minikin::getNextWordBreakForCache(
+            text_.data(), run.end() - 1, text_.size());
+        cache_key = std::make_unique<TextBlobCache::Key>(
+            text_.data(), context_start, context_end, run.start(), run.end(),
+            run_layout.font_collection->getId(), run.is_rtl(), run.style());
+        shaped_run = blob_cache.Get(*cache_key);
+      }
+      if (!shaped_run) {
+        shaped_run = BuildShapedRun(run, text_ptr, text_start, text_count,
+                                    words, word_index, word_gap_width,
+                                    justify_x_offset, &run_layout.layout,
+                                    &paint, &builder);
+        if (cache_key)
+          blob_cache.Put(*cache_key, shaped_run);
+      }
+
+      if (shaped_run->blobs.empty())
+        continue;
+
+      for (const ShapedRun::Blob& blob : shaped_run->blobs) {
+        size_t blob_glyph_start = glyph_positions_.size();
+        for (const ShapedRun::GlyphPosition& position : blob.positions) {
+          double x_start = run_x_offset + position.x_start;
+          size_t code_unit_start = run.start() + position.code_unit_start;
+          glyph_positions_.push_back(x_start, x_start + position.x_advance,
+                                     code_unit_start,
+                                     code_unit_start + position.code_unit_count);
+        }
+        size_t blob_glyph_end = glyph_positions_.size();
+
+        records_.emplace_back(run.style(), SkPoint::Make(run_x_offset, 0),
+                              blob.text, blob.metrics, line_number,
+                              shaped_run->advance);
+
+        // Record the glyphs in code unit order. Glyphs are already in that
+        // order unless the run is right to left.
+        size_t order_start = code_unit_order_.size();
+        for (size_t i = blob_glyph_start; i < blob_glyph_end; ++i)
+          code_unit_order_.push_back(i);
+        auto by_code_unit = [this](uint32_t a, uint32_t b) {
+          return glyph_positions_.code_unit_start[a] <
+                 glyph_positions_.code_unit_start[b];
+        };
+        if (!std::is_sorted(code_unit_order_.begin() + order_start,
+                            code_unit_order_.end(), by_code_unit)) {
+          std::sort(code_unit_order_.begin() + order_start,
+                    code_unit_order_.end(), by_code_unit);
+        }
+        code_unit_runs_.emplace_back(
+            Range<size_t>(order_start, code_unit_order_.size()),
+            Range<size_t>(run.start(), run.end()),
+            Range<double>(glyph_positions_.x_start[blob_glyph_start],
+                          glyph_positions_.x_end[blob_glyph_end - 1]),
+            line_number, blob.metrics, run.direction());
+      }
+
+      // Track the words of the line in order to justify the following runs.
+      for (const ShapedRun::Cluster& cluster : shaped_run->clusters) {
+        if (word_index < words.size() &&
+            words[word_index].end == run.start() + cluster.code_unit_end) {
+          justify_x_offset += word_gap_width;
+          word_index++;
+        }
+      }
+
+      run_x_offset += shaped_run->advance;
+    }
+
+    // Adjust the glyph positions based on the alignment of the line.
+    double line_x_offset = GetLineXOffset(run_x_offset);
+    if (line_x_offset) {
+      for (size_t i = line_code_unit_run_start; i < code_unit_runs_.size();
+           ++i) {
+        code_unit_runs_[i].x_pos.Shift(line_x_offset);
+      }
+      glyph_positions_.Shift(line_glyph_start, glyph_positions_.size(),
+                             line_x_offset);
+    }
+
+    for (size_t i = line_record_start; i < records_.size(); ++i) {
+      PaintRecord& paint_record = records_[i];
+      paint_record.SetOffset(
+          SkPoint::Make(paint_record.offset().x() + line_x_offset,
+                        line_y_offsets_[line_number]));
+    }
+  }
+  line_glyph_starts_.push_back(glyph_positions_.size());
+  FXL_DCHECK(run_layout_index == run_layouts_.size());
+  run_layouts_.clear();
 
   std::sort(code_unit_runs_.begin(), code_unit_runs_.end(),
             [](const CodeUnitRun& a, const CodeUnitRun& b) {
@@ -790,7 +797,226 @@ void Paragraph::Layout(double width, bool force) {
             });
 }
 
-double Paragraph::GetLineXOffset(double line_total_advance) {
+std::vector<Paragraph::BidiRun> Paragraph::GetLineRuns(
+    const LineRange& line_range) const {
+  // Exclude trailing whitespace from right-justified lines so the last
+  // visible character in the line will be flush with the right margin.
+  size_t line_end_index =
+      (paragraph_style_.effective_align() == TextAlign::right ||
+       paragraph_style_.effective_align() == TextAlign::center)
+          ? line_range.end_excluding_whitespace
+          : line_range.end;
+
+  std::vector<BidiRun> line_runs;
+  for (const BidiRun& bidi_run : bidi_runs_) {
+    if (bidi_run.start() < line_end_index &&
+        bidi_run.end() > line_range.start) {
+      line_runs.emplace_back(std::max(bidi_run.start(), line_range.start),
+                             std::min(bidi_run.end(), line_end_index),
+                             bidi_run.direction(), bidi_run.style());
+    }
+  }
+  return line_runs;
+}
+
+void Paragraph::GetRunFontAndMinikinPaint(const LineRange& line_range,
+                                          const BidiRun& run,
+                                          minikin::FontStyle* font,
+                                          minikin::MinikinPaint* paint) const {
+  GetFontAndMinikinPaint(run.style(), font, paint);
+
+  // Draw the hyphens of a line that was broken within a word.
+  uint32_t hyphen_edit = minikin::HyphenEdit::NO_EDIT;
+  if (run.start() == line_range.start)
+    hyphen_edit |=
+        line_range.hyphen_edit & minikin::HyphenEdit::MASK_START_OF_LINE;
+  if (run.end() == line_range.end)
+    hyphen_edit |=
+        line_range.hyphen_edit & minikin::HyphenEdit::MASK_END_OF_LINE;
+  paint->hyphenEdit = hyphen_edit;
+}
+
+bool Paragraph::ShouldEllipsizeRun(const LineRange& line_range,
+                                   size_t line_number,
+                                   size_t line_limit,
+                                   bool is_last_run) const {
+  // Apply ellipsizing if the run was not completely laid out and this is the
+  // last line (or lines are unlimited).
+  return paragraph_style_.ellipsis.length() && !isinf(width_) &&
+         !line_range.hard_break && is_last_run &&
+         (line_number == line_limit - 1 || paragraph_style_.unlimited_lines());
+}
+
+std::vector<uint16_t> Paragraph::EllipsizeRun(
+    const BidiRun& run,
+    const minikin::FontStyle& font,
+    const minikin::MinikinPaint& minikin_paint,
+    const std::shared_ptr<minikin::FontCollection>& minikin_font_collection,
+    double run_x_offset,
+    minikin::Layout* layout) const {
+  const std::u16string& ellipsis = paragraph_style_.ellipsis;
+  size_t text_count = run.end() - run.start();
+
+  float ellipsis_width = layout->measureText(
+      reinterpret_cast<const uint16_t*>(ellipsis.data()), 0, ellipsis.length(),
+      ellipsis.length(), run.is_rtl(), font, minikin_paint,
+      minikin_font_collection, nullptr);
+
+  std::vector<float> text_advances(text_count);
+  float text_width = layout->measureText(
+      text_.data(), run.start(), text_count, text_.size(), run.is_rtl(), font,
+      minikin_paint, minikin_font_collection, text_advances.data());
+
+  // Truncate characters from the text until the ellipsis fits.
+  size_t truncate_count = 0;
+  while (truncate_count < text_count &&
+         run_x_offset + text_width + ellipsis_width > width_) {
+    text_width -= text_advances[text_count - truncate_count - 1];
+    truncate_count++;
+  }
+
+  std::vector<uint16_t> ellipsized_text;
+  ellipsized_text.reserve(text_count - truncate_count + ellipsis.length());
+  ellipsized_text.insert(ellipsized_text.begin(), text_.begin() + run.start(),
+                         text_.begin() + run.end() - truncate_count);
+  ellipsized_text.insert(ellipsized_text.end(), ellipsis.begin(),
+                         ellipsis.end());
+  return ellipsized_text;
+}
+
+std::shared_ptr<const ShapedRun> Paragraph::BuildShapedRun(
+    const BidiRun& run,
+    const uint16_t* text_ptr,
+    size_t text_start,
+    size_t text_count,
+    const std::vector<Range<size_t>>& words,
+    size_t word_index,
+    double word_gap_width,
+    double justify_x_offset,
+    minikin::Layout* layout,
+    SkPaint* paint,
+    SkTextBlobBuilder* builder) const {
+  auto result = std::make_shared<ShapedRun>();
+
+  if (layout->nGlyphs() == 0)
+    return result;
+
+  result->advance = layout->getAdvance();
+
+  std::vector<float> layout_advances(text_count);
+  layout->getAdvances(layout_advances.data());
+
+  // Break the layout into blobs that share the same SkPaint parameters.
+  std::vector<Range<size_t>> glyph_blobs = GetLayoutTypefaceRuns(*layout);
+
+  // Build a Skia text blob from each group of glyphs.
+  for (const Range<size_t>& glyph_blob : glyph_blobs) {
+    ShapedRun::Blob blob;
+
+    GetGlyphTypeface(*layout, glyph_blob.start).apply(*paint);
+    const SkTextBlobBuilder::RunBuffer& blob_buffer =
+        builder->allocRunPos(*paint, glyph_blob.end - glyph_blob.start);
+
+    for (size_t glyph_index = glyph_blob.start;
+         glyph_index < glyph_blob.end;) {
+      size_t cluster_start_glyph_index = glyph_index;
+      uint32_t cluster = layout->getGlyphCluster(cluster_start_glyph_index);
+      double glyph_x_offset;
+
+      // Add all the glyphs in this cluster to the text blob.
+      do {
+        size_t blob_index = glyph_index - glyph_blob.start;
+        blob_buffer.glyphs[blob_index] = layout->getGlyphId(glyph_index);
+
+        size_t pos_index = blob_index * 2;
+        blob_buffer.pos[pos_index] =
+            layout->getX(glyph_index) + justify_x_offset;
+        blob_buffer.pos[pos_index + 1] = layout->getY(glyph_index);
+
+        if (glyph_index == cluster_start_glyph_index)
+          glyph_x_offset = blob_buffer.pos[pos_index];
+
+        glyph_index++;
+      } while (glyph_index < glyph_blob.end &&
+               layout->getGlyphCluster(glyph_index) == cluster);
+
+      Range<int32_t> glyph_code_units(cluster, 0);
+      std::vector<size_t> grapheme_code_unit_counts;
+      if (run.is_rtl()) {
+        if (cluster_start_glyph_index > 0) {
+          glyph_code_units.end =
+              layout->getGlyphCluster(cluster_start_glyph_index - 1);
+        } else {
+          glyph_code_units.end = text_count;
+        }
+        grapheme_code_unit_counts.push_back(glyph_code_units.width());
+      } else {
+        if (glyph_index < layout->nGlyphs()) {
+          glyph_code_units.end = layout->getGlyphCluster(glyph_index);
+        } else {
+          glyph_code_units.end = text_count;
+        }
+
+        // The glyph may be a ligature.  Determine how many graphemes are
+        // joined into this glyph and how many input code units map to
+        // each grapheme.
+        size_t code_unit_count = 1;
+        for (int32_t offset = glyph_code_units.start + 1;
+             offset < glyph_code_units.end; ++offset) {
+          if (minikin::GraphemeBreak::isGraphemeBreak(
+                  layout_advances.data(), text_ptr, text_start, text_count,
+                  offset)) {
+            grapheme_code_unit_counts.push_back(code_unit_count);
+            code_unit_count = 1;
+          } else {
+            code_unit_count++;
+          }
+        }
+        grapheme_code_unit_counts.push_back(code_unit_count);
+      }
+      float glyph_advance = layout->getCharAdvance(glyph_code_units.start);
+      float grapheme_advance = glyph_advance / grapheme_code_unit_counts.size();
+
+      blob.positions.push_back({static_cast<size_t>(glyph_code_units.start),
+                                grapheme_code_unit_counts[0], glyph_x_offset,
+                                grapheme_advance});
+
+      // Compute positions for the additional graphemes in the ligature.
+      for (size_t i = 1; i < grapheme_code_unit_counts.size(); ++i) {
+        const ShapedRun::GlyphPosition& prev = blob.positions.back();
+        blob.positions.push_back(
+            {prev.code_unit_start + grapheme_code_unit_counts[i - 1],
+             grapheme_code_unit_counts[i], prev.x_start + prev.x_advance,
+             grapheme_advance});
+      }
+
+      const ShapedRun::GlyphPosition& last = blob.positions.back();
+      result->clusters.push_back({static_cast<size_t>(glyph_code_units.start),
+                                  static_cast<size_t>(glyph_code_units.end),
+                                  glyph_x_offset,
+                                  last.x_start + last.x_advance});
+
+      // Justified lines widen the gap after each word.
+      if (word_index < words.size() &&
+          words[word_index].end == run.start() + glyph_code_units.end) {
+        justify_x_offset += word_gap_width;
+        word_index++;
+      }
+    }
+
+    paint->getFontMetrics(&blob.metrics);
+    blob.text = builder->make();
+
+    if (blob.positions.empty())
+      continue;
+
+    result->blobs.push_back(std::move(blob));
+  }
+
+  return result;
+}
+
+double Paragraph::GetLineXOffset(double line_total_advance) const {
   if (isinf(width_))
     return 0;
 
@@ -850,7 +1076,7 @@ void Paragraph::SetFontCollection(
 }
 
 std::shared_ptr<minikin::FontCollection>
-Paragraph::GetMinikinFontCollectionForStyle(const TextStyle& style) {
+Paragraph::GetMinikinFontCollectionForStyle(const TextStyle& style) const {
   std::string locale;
   if (!style.locale.empty()) {
     uint32_t language_list_id =
@@ -866,7 +1092,8 @@ Paragraph::GetMinikinFontCollectionForStyle(const TextStyle& style) {
                                                              locale);
 }
 
-sk_sp<SkTypeface> Paragraph::GetDefaultSkiaTypeface(const TextStyle& style) {
+sk_sp<SkTypeface> Paragraph::GetDefaultSkiaTypeface(
+    const TextStyle& style) const {
   std::shared_ptr<minikin::FontCollection> collection =
       GetMinikinFontCollectionForStyle(style);
   minikin::FakedFont faked_font =
@@ -877,6 +1104,7 @@ sk_sp<SkTypeface> Paragraph::GetDefaultSkiaTypeface(const TextStyle& style) {
 // The x,y coordinates will be the very top left corner of the rendered
 // paragraph.
 void Paragraph::Paint(SkCanvas* canvas, double x, double y) {
+  BuildPaintData();
   canvas->translate(x, y);
   SkPaint paint;
   for (const PaintRecord& record : records_) {
@@ -1065,6 +1293,7 @@ void Paragraph::PaintBackground(SkCanvas* canvas, const PaintRecord& record) {
 
 std::vector<Paragraph::TextBox> Paragraph::GetRectsForRange(size_t start,
                                                             size_t end) const {
+  BuildPaintData();
   std::map<size_t, std::vector<Paragraph::TextBox>> line_boxes;
 
   for (const CodeUnitRun& run : code_unit_runs_) {
@@ -1084,10 +1313,19 @@ std::vector<Paragraph::TextBox> Paragraph::GetRectsForRange(size_t start,
     } else {
       left = SK_ScalarMax;
       right = SK_ScalarMin;
-      for (const GlyphPosition& gp : run.positions) {
-        if (gp.code_units.start >= start && gp.code_units.end <= end) {
-          left = std::min(left, static_cast<SkScalar>(gp.x_pos.start));
-          right = std::max(right, static_cast<SkScalar>(gp.x_pos.end));
+      // Glyphs are ordered by code unit, so skip directly to the first glyph
+      // that can be inside the range.
+      const GlyphPositions& positions = glyph_positions_;
+      auto order_end = code_unit_order_.begin() + run.glyphs.end;
+      auto gp = std::lower_bound(
+          code_unit_order_.begin() + run.glyphs.start, order_end, start,
+          [&positions](uint32_t glyph, size_t index) {
+            return positions.code_unit_start[glyph] < index;
+          });
+      for (; gp != order_end && positions.code_unit_start[*gp] < end; ++gp) {
+        if (positions.code_unit_end[*gp] <= end) {
+          left = std::min(left, positions.x_start[*gp]);
+          right = std::max(right, positions.x_end[*gp]);
         }
       }
       if (left == SK_ScalarMax || right == SK_ScalarMin)
@@ -1129,57 +1367,48 @@ Paragraph::PositionWithAffinity Paragraph::GetGlyphPositionAtCoordinate(
     double dy) const {
   if (line_heights_.empty())
     return PositionWithAffinity(0, DOWNSTREAM);
-
-  size_t y_index;
-  for (y_index = 0; y_index < line_heights_.size() - 1; ++y_index) {
-    if (dy < line_heights_[y_index])
-      break;
-  }
-
-  const std::vector<GlyphPosition>& line_glyph_position =
-      glyph_lines_[y_index].positions;
-  if (line_glyph_position.empty()) {
-    int line_start_index =
-        std::accumulate(glyph_lines_.begin(), glyph_lines_.begin() + y_index, 0,
-                        [](const int a, const GlyphLine& b) {
-                          return a + static_cast<int>(b.total_code_units);
-                        });
-    return PositionWithAffinity(line_start_index, DOWNSTREAM);
-  }
-
-  size_t x_index;
-  const GlyphPosition* gp = nullptr;
-  for (x_index = 0; x_index < line_glyph_position.size(); ++x_index) {
-    double glyph_end = (x_index < line_glyph_position.size() - 1)
-                           ? line_glyph_position[x_index + 1].x_pos.start
-                           : line_glyph_position[x_index].x_pos.end;
-    if (dx < glyph_end) {
-      gp = &line_glyph_position[x_index];
-      break;
-    }
-  }
-
-  if (gp == nullptr) {
-    const GlyphPosition& last_glyph = line_glyph_position.back();
-    return PositionWithAffinity(last_glyph.code_units.end, UPSTREAM);
-  }
+  BuildPaintData();
+
+  // Find the first line whose bottom is below dy, or the last line.
+  size_t y_index =
+      std::upper_bound(line_heights_.begin(), line_heights_.end() - 1, dy) -
+      line_heights_.begin();
+
+  const GlyphPositions& positions = glyph_positions_;
+  size_t line_start = line_glyph_starts_[y_index];
+  size_t line_end = line_glyph_starts_[y_index + 1];
+  if (line_start == line_end)
+    return PositionWithAffinity(line_ranges_[y_index].start, DOWNSTREAM);
+
+  // Each glyph extends to the start of the next one, and the last glyph of the
+  // line to its own end. Find the first glyph whose extent ends after dx.
+  size_t gp = std::upper_bound(positions.x_start.begin() + line_start + 1,
+                               positions.x_start.begin() + line_end, dx) -
+              positions.x_start.begin() - 1;
+  if (gp == line_end - 1 && dx >= positions.x_end[gp])
+    return PositionWithAffinity(positions.code_unit_end[gp], UPSTREAM);
 
   // Find the direction of the run that contains this glyph.
   TextDirection direction = TextDirection::ltr;
-  for (const CodeUnitRun& run : code_unit_runs_) {
-    if (gp->code_units.start >= run.code_units.start &&
-        gp->code_units.end <= run.code_units.end) {
-      direction = run.direction;
-      break;
-    }
+  size_t code_unit_start = positions.code_unit_start[gp];
+  size_t code_unit_end = positions.code_unit_end[gp];
+  auto run = std::upper_bound(code_unit_runs_.begin(), code_unit_runs_.end(),
+                              code_unit_start,
+                              [](size_t index, const CodeUnitRun& run) {
+                                return index < run.code_units.start;
+                              });
+  if (run != code_unit_runs_.begin()) {
+    --run;
+    if (code_unit_end <= run->code_units.end)
+      direction = run->direction;
   }
 
-  double glyph_center = (gp->x_pos.start + gp->x_pos.end) / 2;
+  double glyph_center = (positions.x_start[gp] + positions.x_end[gp]) / 2;
   if ((direction == TextDirection::ltr && dx < glyph_center) ||
       (direction == TextDirection::rtl && dx >= glyph_center)) {
-    return PositionWithAffinity(gp->code_units.start, DOWNSTREAM);
+    return PositionWithAffinity(code_unit_start, DOWNSTREAM);
   } else {
-    return PositionWithAffinity(gp->code_units.end, UPSTREAM);
+    return PositionWithAffinity(code_unit_end, UPSTREAM);
   }
 }
 
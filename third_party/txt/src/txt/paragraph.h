@@ -24,15 +24,18 @@
 #include "font_collection.h"
 #include "lib/fxl/compiler_specific.h"
 #include "lib/fxl/macros.h"
+#include "minikin/Layout.h"
 #include "minikin/LineBreaker.h"
 #include "paint_record.h"
 #include "paragraph_style.h"
 #include "styled_runs.h"
+#include "text_blob_cache.h"
 #include "third_party/googletest/googletest/include/gtest/gtest_prod.h"  // nogncheck
 #include "third_party/skia/include/core/SkRect.h"
 #include "utils/WindowsUtils.h"
 
 class SkCanvas;
+class SkTextBlobBuilder;
 
 namespace txt {
 
@@ -94,8 +97,11 @@ class Paragraph {
   // paragraphs. It is currently recommended to break up very long paragraphs
   // (10k+ characters) to ensure speedy layout.
   //
-  // Layout calculates the positioning of all the glyphs. Must call this method
-  // before Painting and getting any statistics from this class.
+  // Layout breaks the text into lines and measures them. Must call this method
+  // before Painting and getting any statistics from this class. The glyph
+  // positions and text blobs are only built once they are needed by Paint(),
+  // GetRectsForRange() or GetGlyphPositionAtCoordinate(), so querying the
+  // height, line count or intrinsic widths does not pay for them.
   void Layout(double width, bool force = false);
 
   // Paints the Laid out text onto the supplied SkCanvas at (x, y) offset from
@@ -184,6 +190,9 @@ class Paragraph {
   FRIEND_TEST(ParagraphTest, HyphenBreakParagraph);
   FRIEND_TEST(ParagraphTest, RepeatLayoutParagraph);
   FRIEND_TEST(ParagraphTest, Ellipsize);
+  FRIEND_TEST(ParagraphTest, SharedTextBlobParagraph);
+  FRIEND_TEST(ParagraphTest, SoftHyphenParagraph);
+  FRIEND_TEST(ParagraphTest, LazyPaintDataParagraph);
 
   // Starting data to layout.
   std::vector<uint16_t> text_;
@@ -192,28 +201,44 @@ class Paragraph {
   std::shared_ptr<FontCollection> font_collection_;
 
   minikin::LineBreaker breaker_;
+  // The locale and hyphenator last passed to breaker_. Setting the locale
+  // rebuilds the ICU break iterator, so it is only done when they change.
+  std::string breaker_locale_;
+  minikin::Hyphenator* breaker_hyphenator_ = nullptr;
   mutable std::unique_ptr<icu::BreakIterator> word_breaker_;
 
   struct LineRange {
-    LineRange(size_t s, size_t e, size_t eew, size_t ein, bool h)
+    LineRange(size_t s,
+              size_t e,
+              size_t eew,
+              size_t ein,
+              bool h,
+              uint32_t hyph = minikin::HyphenEdit::NO_EDIT)
         : start(s),
           end(e),
           end_excluding_whitespace(eew),
           end_including_newline(ein),
-          hard_break(h) {}
+          hard_break(h),
+          hyphen_edit(hyph) {}
     size_t start, end;
     size_t end_excluding_whitespace;
     size_t end_including_newline;
     bool hard_break;
+    // Hyphens to insert at the start and end of the line if it was broken
+    // within a word.
+    uint32_t hyphen_edit;
   };
   std::vector<LineRange> line_ranges_;
   std::vector<double> line_widths_;
 
-  // Stores the result of Layout().
-  std::vector<PaintRecord> records_;
+  // The text blobs to paint. Built lazily by BuildPaintData().
+  mutable std::vector<PaintRecord> records_;
 
+  // Metrics of the lines that are laid out, computed by Layout().
   std::vector<double> line_heights_;
   std::vector<double> line_baselines_;
+  // The y coordinate at which the glyphs of each line are drawn.
+  std::vector<double> line_y_offsets_;
   bool did_exceed_max_lines_;
 
   class BidiRun {
@@ -233,51 +258,83 @@ class Paragraph {
     const TextStyle* style_;
   };
 
-  struct GlyphPosition {
-    Range<size_t> code_units;
-    Range<double> x_pos;
+  // The positions of all laid out glyphs, stored as parallel arrays so that
+  // hit testing only touches the columns it searches. Glyphs are stored line
+  // by line in visual order, so the x coordinates of a line are ascending.
+  struct GlyphPositions {
+    std::vector<float> x_start;
+    std::vector<float> x_end;
+    std::vector<uint32_t> code_unit_start;
+    std::vector<uint32_t> code_unit_end;
 
-    GlyphPosition(double x_start,
-                  double x_advance,
-                  size_t code_unit_index,
-                  size_t code_unit_width);
+    size_t size() const { return x_start.size(); }
 
-    void Shift(double delta);
-  };
+    void push_back(double x_s, double x_e, size_t cu_s, size_t cu_e);
 
-  struct GlyphLine {
-    // Glyph positions sorted by x coordinate.
-    const std::vector<GlyphPosition> positions;
-    const size_t total_code_units;
+    // Moves the glyphs in [begin, end) horizontally.
+    void Shift(size_t begin, size_t end, double delta);
 
-    GlyphLine(std::vector<GlyphPosition>&& p, size_t tcu);
+    // Clears the positions, keeping the storage for the next layout.
+    void clear();
+
+    void reserve(size_t count);
   };
 
   struct CodeUnitRun {
-    // Glyph positions sorted by code unit index.
-    std::vector<GlyphPosition> positions;
+    // Range of code_unit_order_ holding the glyphs of the run sorted by code
+    // unit index.
+    Range<size_t> glyphs;
     Range<size_t> code_units;
     Range<double> x_pos;
     size_t line_number;
     SkPaint::FontMetrics font_metrics;
     TextDirection direction;
 
-    CodeUnitRun(std::vector<GlyphPosition>&& p,
+    CodeUnitRun(Range<size_t> g,
                 Range<size_t> cu,
                 Range<double> x,
                 size_t line,
                 const SkPaint::FontMetrics& metrics,
                 TextDirection dir);
+  };
+
+  // The runs of text in visual order within each bidi level.
+  std::vector<BidiRun> bidi_runs_;
 
-    void Shift(double delta);
+  // The shaping of a run of a measured line.
+  struct RunLayout {
+    explicit RunLayout(std::shared_ptr<minikin::FontCollection> collection)
+        : font_collection(std::move(collection)) {}
+
+    // Keeps the fonts used by the layout alive.
+    std::shared_ptr<minikin::FontCollection> font_collection;
+    // The text of the run followed by the ellipsis, if it was ellipsized.
+    std::vector<uint16_t> ellipsized_text;
+    minikin::Layout layout;
   };
 
-  // Holds the laid out x positions of each glyph.
-  std::vector<GlyphLine> glyph_lines_;
+  // The layouts of the runs of the measured lines in the order Layout() shaped
+  // them. BuildPaintData() builds the text blobs from them and then drops them,
+  // so no run is shaped twice.
+  mutable std::vector<RunLayout> run_layouts_;
+
+  // The storage below is built lazily by BuildPaintData(). Its capacity is
+  // kept across layouts, so relaying out a paragraph does not reallocate it.
+
+  // Holds the laid out positions of each glyph.
+  mutable GlyphPositions glyph_positions_;
+
+  // Index of the first glyph of each line in glyph_positions_, followed by
+  // the total number of glyphs.
+  mutable std::vector<size_t> line_glyph_starts_;
+
+  // Indices into glyph_positions_ ordered by code unit within each
+  // CodeUnitRun.
+  mutable std::vector<uint32_t> code_unit_order_;
 
   // Holds the positions of each range of code units in the text.
   // Sorted in code unit index order.
-  std::vector<CodeUnitRun> code_unit_runs_;
+  mutable std::vector<CodeUnitRun> code_unit_runs_;
 
   // The max width of the paragraph as provided in the most recent Layout()
   // call.
@@ -288,6 +345,9 @@ class Paragraph {
   double ideographic_baseline_ = FLT_MAX;
 
   bool needs_layout_ = true;
+  // Set by Layout() when records_, glyph_positions_ and code_unit_runs_ are
+  // stale.
+  mutable bool needs_paint_data_ = false;
 
   struct WaveCoordinates {
     double x_start;
@@ -313,9 +373,55 @@ class Paragraph {
   // Break the text into runs based on LTR/RTL text direction.
   bool ComputeBidiRuns(std::vector<BidiRun>* result);
 
+  // Builds the paint records, glyph positions and code unit runs of the lines
+  // measured by the last Layout() if they are not up to date.
+  void BuildPaintData() const;
+
+  // Returns the bidi runs clipped to the visible part of a line.
+  std::vector<BidiRun> GetLineRuns(const LineRange& line_range) const;
+
+  // Gets the fonts and paint for a run, including the hyphens to draw if the
+  // run is at the edge of a hyphenated line.
+  void GetRunFontAndMinikinPaint(const LineRange& line_range,
+                                 const BidiRun& run,
+                                 minikin::FontStyle* font,
+                                 minikin::MinikinPaint* paint) const;
+
+  // Whether the run is the last run of a line that must end with an ellipsis.
+  bool ShouldEllipsizeRun(const LineRange& line_range,
+                          size_t line_number,
+                          size_t line_limit,
+                          bool is_last_run) const;
+
+  // Returns the text of the run truncated so that it fits within the
+  // paragraph width followed by the ellipsis.
+  std::vector<uint16_t> EllipsizeRun(
+      const BidiRun& run,
+      const minikin::FontStyle& font,
+      const minikin::MinikinPaint& minikin_paint,
+      const std::shared_ptr<minikin::FontCollection>& minikin_font_collection,
+      double run_x_offset,
+      minikin::Layout* layout) const;
+
+  // Builds the Skia text blobs used to paint a run from the layout that shaped
+  // it. Glyphs are offset by the justification gap following each completed
+  // word when |word_gap_width| is nonzero.
+  std::shared_ptr<const ShapedRun> BuildShapedRun(
+      const BidiRun& run,
+      const uint16_t* text_ptr,
+      size_t text_start,
+      size_t text_count,
+      const std::vector<Range<size_t>>& words,
+      size_t word_index,
+      double word_gap_width,
+      double justify_x_offset,
+      minikin::Layout* layout,
+      SkPaint* paint,
+      SkTextBlobBuilder* builder) const;
+
   // Calculate the starting X offset of a line based on the line's width and
   // alignment.
-  double GetLineXOffset(double line_total_advance);
+  double GetLineXOffset(double line_total_advance) const;
 
   // Creates and draws the decorations onto the canvas.
   void PaintDecorations(SkCanvas* canvas, const PaintRecord& record);
@@ -325,10 +431,10 @@ class Paragraph {
 
   // Obtain a Minikin font collection matching this text style.
   std::shared_ptr<minikin::FontCollection> GetMinikinFontCollectionForStyle(
-      const TextStyle& style);
+      const TextStyle& style) const;
 
   // Get a default SkTypeface for a text style.
-  sk_sp<SkTypeface> GetDefaultSkiaTypeface(const TextStyle& style);
+  sk_sp<SkTypeface> GetDefaultSkiaTypeface(const TextStyle& style) const;
 
   FXL_DISALLOW_COPY_AND_ASSIGN(Paragraph);
 };
@@ -62,6 +62,14 @@ class ParagraphStyle {
   minikin::BreakStrategy break_strategy =
       minikin::BreakStrategy::kBreakStrategy_Greedy;
 
+  // Hyphenation is off by default. When enabled, words may be broken using the
+  // hyphenation patterns for |locale| (see HyphenatorCache) as well as at soft
+  // hyphens. kHyphenationFrequency_Full hyphenates more aggressively, which
+  // mostly helps justified text in narrow columns. This is not exposed
+  // through dart:ui and is only set by users of txt in C++.
+  minikin::HyphenationFrequency hyphenation_frequency =
+      minikin::HyphenationFrequency::kHyphenationFrequency_None;
+
   TextStyle GetTextStyle() const;
 
   bool unlimited_lines() const;
@@ -10,4 +10,8 @@ std::string GetDefaultFontFamily() {
   return "Arial";
 }
 
+std::string GetHyphenationPatternDirectory() {
+  return "";
+}
+
 }  // namespace txt
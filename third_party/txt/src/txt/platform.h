@@ -12,6 +12,10 @@ namespace txt {
 
 std::string GetDefaultFontFamily();
 
+// Directory containing the system's hyphenation pattern files, or an empty
+// string if the platform does not provide any.
+std::string GetHyphenationPatternDirectory();
+
 }  // namespace txt
 
 #endif  // TXT_PLATFORM_H_
@@ -10,4 +10,8 @@ std::string GetDefaultFontFamily() {
   return "sans-serif";
 }
 
+std::string GetHyphenationPatternDirectory() {
+  return "/system/usr/hyphen-data";
+}
+
 }  // namespace txt
@@ -24,4 +24,8 @@ std::string GetDefaultFontFamily() {
   }
 }
 
+std::string GetHyphenationPatternDirectory() {
+  return "";
+}
+
 }  // namespace txt
@@ -0,0 +1,186 @@
+/*
+ * Copyright 2018 Google Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "text_blob_cache.h"
+
+#include <functional>
+
+#include "font_style.h"
+#include "font_weight.h"
+
+namespace txt {
+
+namespace {
+
+// Rough per-glyph storage of an SkTextBlob positioned run: the glyph id and an
+// x/y position pair.
+const size_t kBytesPerBlobGlyph = sizeof(uint16_t) + 2 * sizeof(SkScalar);
+
+// Fixed overhead of an SkTextBlob and its run record.
+const size_t kBytesPerBlob = 128;
+
+void HashCombine(size_t* seed, size_t value) {
+  *seed ^= value + 0x9e3779b9 + (*seed << 6) + (*seed >> 2);
+}
+
+}  // namespace
+
+size_t ShapedRun::EstimateMemoryUsage() const {
+  size_t bytes = sizeof(ShapedRun) + clusters.capacity() * sizeof(Cluster);
+  for (const Blob& blob : blobs) {
+    bytes += sizeof(Blob) + kBytesPerBlob +
+             blob.positions.capacity() * sizeof(GlyphPosition) +
+             blob.positions.size() * kBytesPerBlobGlyph;
+  }
+  return bytes;
+}
+
+TextBlobCache::Key::Key(const uint16_t* text,
+                        size_t context_start,
+                        size_t context_end,
+                        size_t run_start,
+                        size_t run_end,
+                        uint32_t font_collection_id,
+                        bool is_rtl,
+                        const TextStyle& style)
+    : text(text + context_start, text + context_end),
+      run_start(run_start - context_start),
+      run_end(run_end - context_start),
+      font_collection_id(font_collection_id),
+      is_rtl(is_rtl),
+      font_weight(static_cast<int>(style.font_weight)),
+      italic(style.font_style == FontStyle::italic),
+      font_size(style.font_size),
+      letter_spacing(style.letter_spacing),
+      word_spacing(style.word_spacing),
+      locale(style.locale) {}
+
+bool TextBlobCache::Key::operator==(const Key& other) const {
+  return run_start == other.run_start && run_end == other.run_end &&
+         font_collection_id == other.font_collection_id &&
+         is_rtl == other.is_rtl && font_weight == other.font_weight &&
+         italic == other.italic && font_size == other.font_size &&
+         letter_spacing == other.letter_spacing &&
+         word_spacing == other.word_spacing && locale == other.locale &&
+         text == other.text;
+}
+
+size_t TextBlobCache::Key::Hasher::operator()(const Key& key) const {
+  size_t hash = std::hash<std::u16string>()(key.text);
+  HashCombine(&hash, key.run_start);
+  HashCombine(&hash, key.run_end);
+  HashCombine(&hash, key.font_collection_id);
+  HashCombine(&hash, key.is_rtl);
+  HashCombine(&hash, key.font_weight);
+  HashCombine(&hash, key.italic);
+  HashCombine(&hash, std::hash<double>()(key.font_size));
+  HashCombine(&hash, std::hash<double>()(key.letter_spacing));
+  HashCombine(&hash, std::hash<double>()(key.word_spacing));
+  HashCombine(&hash, std::hash<std::string>()(key.locale));
+  return hash;
+}
+
+TextBlobCache::TextBlobCache() = default;
+
+TextBlobCache::~TextBlobCache() = default;
+
+std::shared_ptr<const ShapedRun> TextBlobCache::Get(const Key& key) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (max_bytes_ == 0)
+    return nullptr;
+
+  auto found = index_.find(key);
+  if (found == index_.end()) {
+    misses_++;
+    return nullptr;
+  }
+  hits_++;
+
+  // Move the entry to the front of the recency list.
+  entries_.splice(entries_.begin(), entries_, found->second);
+  return found->second->run;
+}
+
+void TextBlobCache::Put(const Key& key, std::shared_ptr<const ShapedRun> run) {
+  size_t bytes = run->EstimateMemoryUsage() +
+                 key.text.capacity() * sizeof(char16_t) + sizeof(Entry);
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (bytes > max_bytes_)
+    return;
+
+  auto found = index_.find(key);
+  if (found != index_.end()) {
+    bytes_ -= found->second->bytes;
+    entries_.erase(found->second);
+    index_.erase(found);
+  }
+
+  EvictLocked(max_bytes_ - bytes);
+
+  entries_.push_front(Entry{key, std::move(run), bytes});
+  index_.emplace(key, entries_.begin());
+  bytes_ += bytes;
+}
+
+void TextBlobCache::Clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  index_.clear();
+  entries_.clear();
+  bytes_ = 0;
+}
+
+void TextBlobCache::SetMaxBytes(size_t max_bytes) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  max_bytes_ = max_bytes;
+  EvictLocked(max_bytes_);
+}
+
+size_t TextBlobCache::GetMaxBytes() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return max_bytes_;
+}
+
+size_t TextBlobCache::GetMemoryUsage() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return bytes_;
+}
+
+size_t TextBlobCache::GetEntryCount() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return entries_.size();
+}
+
+size_t TextBlobCache::GetHitCount() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return hits_;
+}
+
+size_t TextBlobCache::GetMissCount() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return misses_;
+}
+
+void TextBlobCache::EvictLocked(size_t max_bytes) {
+  while (bytes_ > max_bytes && !entries_.empty()) {
+    const Entry& oldest = entries_.back();
+    bytes_ -= oldest.bytes;
+    index_.erase(oldest.key);
+    entries_.pop_back();
+  }
+}
+
+}  // namespace txt
@@ -0,0 +1,157 @@
+/*
+ * Copyright 2018 Google Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LIB_TXT_SRC_TEXT_BLOB_CACHE_H_
+#define LIB_TXT_SRC_TEXT_BLOB_CACHE_H_
+
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "lib/fxl/macros.h"
+#include "text_style.h"
+#include "third_party/skia/include/core/SkPaint.h"
+#include "third_party/skia/include/core/SkTextBlob.h"
+
+namespace txt {
+
+// The result of shaping a single styled bidi run and converting it into Skia
+// text blobs. All x coordinates are relative to the start of the run and all
+// code unit indices are relative to the first code unit of the run.
+struct ShapedRun {
+  struct GlyphPosition {
+    size_t code_unit_start, code_unit_count;
+    double x_start, x_advance;
+  };
+
+  // A group of glyphs sharing the same typeface and fakery.
+  struct Blob {
+    sk_sp<SkTextBlob> text;
+    SkPaint::FontMetrics metrics;
+    // Glyph positions in visual order.
+    std::vector<GlyphPosition> positions;
+  };
+
+  // A cluster of glyphs mapping to a contiguous range of code units. Used to
+  // locate word boundaries without reshaping the run.
+  struct Cluster {
+    size_t code_unit_start, code_unit_end;
+    double x_start, x_end;
+  };
+
+  std::vector<Blob> blobs;
+  std::vector<Cluster> clusters;
+  double advance = 0;
+
+  // Approximate number of bytes retained by this run, including its blobs.
+  size_t EstimateMemoryUsage() const;
+};
+
+// A cache of shaped runs shared by all paragraphs that use the same
+// FontCollection. Lists, tables and other repeated labels often lay out the
+// same string with the same style many times. Reusing the shaped run avoids
+// reshaping and rebuilding the SkTextBlob, and lets Skia's own per-blob caches
+// hit when the shared blob is drawn again.
+//
+// The cache is bounded by the estimated memory footprint of its entries and
+// evicts the least recently used runs first.
+class TextBlobCache {
+ public:
+  struct Key {
+    // The text of the run including the surrounding code units that minikin
+    // uses as shaping context.
+    std::u16string text;
+    size_t run_start;
+    size_t run_end;
+    uint32_t font_collection_id;
+    bool is_rtl;
+    int font_weight;
+    bool italic;
+    double font_size;
+    double letter_spacing;
+    double word_spacing;
+    std::string locale;
+
+    Key(const uint16_t* text,
+        size_t context_start,
+        size_t context_end,
+        size_t run_start,
+        size_t run_end,
+        uint32_t font_collection_id,
+        bool is_rtl,
+        const TextStyle& style);
+
+    bool operator==(const Key& other) const;
+
+    struct Hasher {
+      size_t operator()(const Key& key) const;
+    };
+  };
+
+  static const size_t kDefaultMaxBytes = 4 * 1024 * 1024;
+
+  TextBlobCache();
+
+  ~TextBlobCache();
+
+  // Returns the shaped run for the key or nullptr if it is not cached.
+  std::shared_ptr<const ShapedRun> Get(const Key& key);
+
+  void Put(const Key& key, std::shared_ptr<const ShapedRun> run);
+
+  void Clear();
+
+  // Sets the memory budget of the cache. A budget of zero disables caching.
+  void SetMaxBytes(size_t max_bytes);
+
+  size_t GetMaxBytes() const;
+
+  // Estimated number of bytes held by the cached runs.
+  size_t GetMemoryUsage() const;
+
+  size_t GetEntryCount() const;
+
+  size_t GetHitCount() const;
+
+  size_t GetMissCount() const;
+
+ private:
+  struct Entry {
+    Key key;
+    std::shared_ptr<const ShapedRun> run;
+    size_t bytes;
+  };
+  using EntryList = std::list<Entry>;
+
+  mutable std::mutex mutex_;
+  EntryList entries_;
+  std::unordered_map<Key, EntryList::iterator, Key::Hasher> index_;
+  size_t max_bytes_ = kDefaultMaxBytes;
+  size_t bytes_ = 0;
+  size_t hits_ = 0;
+  size_t misses_ = 0;
+
+  void EvictLocked(size_t max_bytes);
+
+  FXL_DISALLOW_COPY_AND_ASSIGN(TextBlobCache);
+};
+
+}  // namespace txt
+
+#endif  // LIB_TXT_SRC_TEXT_BLOB_CACHE_H_
@@ -0,0 +1,191 @@
+/*
+ * Copyright 2018 Google Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "text_scanner.h"
+
+#include "third_party/icu/source/common/unicode/uchar.h"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define TXT_SCANNER_SSE2 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define TXT_SCANNER_NEON 1
+#endif
+
+namespace txt {
+
+namespace {
+
+// Number of code units classified by each block scan.
+const size_t kBlockSize = 8;
+
+const uint16_t kLineFeed = 0x0A;
+const uint16_t kFormFeed = 0x0C;
+const uint16_t kSpace = 0x20;
+const uint16_t kNoBreakSpace = 0xA0;
+const uint16_t kLatin1Max = 0xFF;
+
+// Within Latin-1 the only code units in the LF and BK line break classes are
+// LF, VT and FF.
+bool IsMandatoryLineBreak(uint16_t code_unit) {
+  if (code_unit <= kLatin1Max)
+    return code_unit >= kLineFeed && code_unit <= kFormFeed;
+  ULineBreak ulb = static_cast<ULineBreak>(
+      u_getIntPropertyValue(code_unit, UCHAR_LINE_BREAK));
+  return ulb == U_LB_LINE_FEED || ulb == U_LB_MANDATORY_BREAK;
+}
+
+bool IsWordSpace(uint16_t code_unit) {
+  return code_unit == kSpace || code_unit == kNoBreakSpace;
+}
+
+#if TXT_SCANNER_SSE2
+
+// Returns a bit for each lane of a mask of 16-bit comparison results.
+uint32_t MoveMask(__m128i mask) {
+  return _mm_movemask_epi8(_mm_packs_epi16(mask, _mm_setzero_si128()));
+}
+
+// Returns a bit for each code unit in the block that is either a Latin-1 line
+// break or outside of Latin-1.
+uint32_t LineBreakCandidates(const uint16_t* text) {
+  __m128i units = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text));
+  __m128i zero = _mm_setzero_si128();
+  // (unit - LF) <= (FF - LF) using saturating unsigned arithmetic.
+  __m128i breaks = _mm_cmpeq_epi16(
+      _mm_subs_epu16(_mm_sub_epi16(units, _mm_set1_epi16(kLineFeed)),
+                     _mm_set1_epi16(kFormFeed - kLineFeed)),
+      zero);
+  __m128i latin1 =
+      _mm_cmpeq_epi16(_mm_subs_epu16(units, _mm_set1_epi16(kLatin1Max)), zero);
+  return MoveMask(breaks) | (~MoveMask(latin1) & 0xFF);
+}
+
+uint32_t WordSpaces(const uint16_t* text) {
+  __m128i units = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text));
+  __m128i spaces =
+      _mm_or_si128(_mm_cmpeq_epi16(units, _mm_set1_epi16(kSpace)),
+                   _mm_cmpeq_epi16(units, _mm_set1_epi16(kNoBreakSpace)));
+  return MoveMask(spaces);
+}
+
+#elif TXT_SCANNER_NEON
+
+uint32_t MoveMask(uint16x8_t mask) {
+  static const uint16_t kLaneBits[kBlockSize] = {1,  2,  4,  8,
+                                                 16, 32, 64, 128};
+  uint16x8_t bits = vandq_u16(mask, vld1q_u16(kLaneBits));
+  uint16x4_t sum = vadd_u16(vget_low_u16(bits), vget_high_u16(bits));
+  sum = vpadd_u16(sum, sum);
+  sum = vpadd_u16(sum, sum);
+  return vget_lane_u16(sum, 0);
+}
+
+uint32_t LineBreakCandidates(const uint16_t* text) {
+  uint16x8_t units = vld1q_u16(text);
+  uint16x8_t breaks = vcleq_u16(vsubq_u16(units, vdupq_n_u16(kLineFeed)),
+                                vdupq_n_u16(kFormFeed - kLineFeed));
+  uint16x8_t non_latin1 = vcgtq_u16(units, vdupq_n_u16(kLatin1Max));
+  return MoveMask(vorrq_u16(breaks, non_latin1));
+}
+
+uint32_t WordSpaces(const uint16_t* text) {
+  uint16x8_t units = vld1q_u16(text);
+  return MoveMask(vorrq_u16(vceqq_u16(units, vdupq_n_u16(kSpace)),
+                            vceqq_u16(units, vdupq_n_u16(kNoBreakSpace))));
+}
+
+#else
+
+uint32_t LineBreakCandidates(const uint16_t* text) {
+  uint32_t mask = 0;
+  for (size_t i = 0; i < kBlockSize; ++i) {
+    uint16_t code_unit = text[i];
+    if (code_unit > kLatin1Max ||
+        (code_unit >= kLineFeed && code_unit <= kFormFeed))
+      mask |= 1 << i;
+  }
+  return mask;
+}
+
+uint32_t WordSpaces(const uint16_t* text) {
+  uint32_t mask = 0;
+  for (size_t i = 0; i < kBlockSize; ++i) {
+    if (IsWordSpace(text[i]))
+      mask |= 1 << i;
+  }
+  return mask;
+}
+
+#endif
+
+size_t CountTrailingZeros(uint32_t mask) {
+#if defined(_MSC_VER)
+  unsigned long index;
+  _BitScanForward(&index, mask);
+  return index;
+#else
+  return __builtin_ctz(mask);
+#endif
+}
+
+}  // namespace
+
+void FindMandatoryLineBreaks(const uint16_t* text,
+                             size_t start,
+                             size_t end,
+                             std::vector<size_t>* result) {
+  size_t i = start;
+  for (; i + kBlockSize <= end; i += kBlockSize) {
+    uint32_t candidates = LineBreakCandidates(text + i);
+    while (candidates) {
+      size_t lane = CountTrailingZeros(candidates);
+      candidates &= candidates - 1;
+      if (IsMandatoryLineBreak(text[i + lane]))
+        result->push_back(i + lane);
+    }
+  }
+  for (; i < end; ++i) {
+    if (IsMandatoryLineBreak(text[i]))
+      result->push_back(i);
+  }
+}
+
+size_t FindWordSpace(const uint16_t* text,
+                     size_t start,
+                     size_t end,
+                     bool is_space) {
+  size_t i = start;
+  for (; i + kBlockSize <= end; i += kBlockSize) {
+    uint32_t matches = WordSpaces(text + i);
+    if (!is_space)
+      matches = ~matches & 0xFF;
+    if (matches)
+      return i + CountTrailingZeros(matches);
+  }
+  for (; i < end; ++i) {
+    if (IsWordSpace(text[i]) == is_space)
+      return i;
+  }
+  return end;
+}
+
+}  // namespace txt
@@ -0,0 +1,47 @@
+/*
+ * Copyright 2018 Google Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LIB_TXT_SRC_TEXT_SCANNER_H_
+#define LIB_TXT_SRC_TEXT_SCANNER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace txt {
+
+// Scans UTF-16 text for the code units that Paragraph needs to find before
+// shaping. Blocks of Latin-1 text are classified several code units at a time
+// using SIMD instructions where available. ICU is only consulted for code
+// units outside of Latin-1.
+
+// Appends to |result| the index of each code unit in [start, end) that forces
+// a line break (Unicode line break classes LF and BK).
+void FindMandatoryLineBreaks(const uint16_t* text,
+                             size_t start,
+                             size_t end,
+                             std::vector<size_t>* result);
+
+// Returns the index of the first code unit in [start, end) for which
+// minikin::isWordSpace() equals |is_space|, or |end| if there is none.
+size_t FindWordSpace(const uint16_t* text,
+                     size_t start,
+                     size_t end,
+                     bool is_space);
+
+}  // namespace txt
+
+#endif  // LIB_TXT_SRC_TEXT_SCANNER_H_
@@ -15,6 +15,7 @@
  */
 
 #include <random>
+#include <vector>
 
 #include <gtest/gtest.h>
 #include <minikin/SparseBitSet.h>
@@ -51,4 +52,38 @@ TEST(SparseBitSetTest, randomTest) {
   }
 }
 
+TEST(SparseBitSetTest, serializeTest) {
+  const uint32_t ranges[] = {0x20, 0x7F, 0x4E00, 0x9FA6, 0x1F600, 0x1F650};
+  SparseBitSet bitset(ranges, 3);
+
+  std::vector<uint8_t> data(bitset.serializedSize());
+  bitset.serialize(data.data());
+
+  SparseBitSet restored;
+  ASSERT_TRUE(restored.deserialize(data.data(), data.size()));
+  ASSERT_EQ(bitset.length(), restored.length());
+  for (uint32_t ch = 0; ch < 0x20000; ++ch) {
+    ASSERT_EQ(bitset.get(ch), restored.get(ch)) << std::hex << ch;
+  }
+  ASSERT_EQ(bitset.nextSetBit(0x80), restored.nextSetBit(0x80));
+
+  // Truncated data leaves the set empty.
+  ASSERT_FALSE(restored.deserialize(data.data(), data.size() - 1));
+  ASSERT_EQ(0u, restored.length());
+  ASSERT_FALSE(restored.get(0x20));
+
+  // An index pointing past the bitmaps is rejected.
+  std::vector<uint8_t> corrupted(data);
+  const size_t kHeaderSize = 3 * sizeof(uint32_t);
+  corrupted[kHeaderSize] = 0xFF;
+  corrupted[kHeaderSize + 1] = 0xFF;
+  ASSERT_FALSE(restored.deserialize(corrupted.data(), corrupted.size()));
+
+  SparseBitSet empty;
+  data.resize(empty.serializedSize());
+  empty.serialize(data.data());
+  ASSERT_TRUE(restored.deserialize(data.data(), data.size()));
+  ASSERT_EQ(0u, restored.length());
+}
+
 }  // namespace minikin
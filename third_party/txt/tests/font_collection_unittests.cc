@@ -14,6 +14,8 @@
  * limitations under the License.
  */
 
+#include <thread>
+
 #include "gtest/gtest.h"
 #include "lib/fxl/command_line.h"
 #include "lib/fxl/logging.h"
@@ -22,6 +24,59 @@
 
 namespace txt {
 
+TEST(FontCollection, CachesMissingFallbackFonts) {
+  std::shared_ptr<FontCollection> collection = GetTestFontCollection();
+
+  // The asset font manager never provides fallback fonts.
+  ASSERT_EQ(collection->MatchFallbackFont(0x10FFFD, "en-US"), nullptr);
+  FontCollection::FallbackCacheStats stats =
+      collection->GetFallbackCacheStats();
+  ASSERT_EQ(stats.hits, 0ull);
+  ASSERT_EQ(stats.misses, 1ull);
+  ASSERT_EQ(stats.negative_entries, 1ull);
+
+  ASSERT_EQ(collection->MatchFallbackFont(0x10FFFD, "en-US"), nullptr);
+  stats = collection->GetFallbackCacheStats();
+  ASSERT_EQ(stats.hits, 1ull);
+  ASSERT_EQ(stats.misses, 1ull);
+
+  // Entries are kept per locale and per code point.
+  collection->MatchFallbackFont(0x10FFFD, "ja");
+  collection->MatchFallbackFont(0x10FFFC, "en-US");
+  stats = collection->GetFallbackCacheStats();
+  ASSERT_EQ(stats.hits, 1ull);
+  ASSERT_EQ(stats.misses, 3ull);
+  ASSERT_EQ(stats.negative_entries, 3ull);
+
+  // Changing the font managers invalidates the cache.
+  collection->SetDefaultFontManager(nullptr);
+  collection->MatchFallbackFont(0x10FFFD, "en-US");
+  stats = collection->GetFallbackCacheStats();
+  ASSERT_EQ(stats.misses, 4ull);
+  ASSERT_EQ(stats.negative_entries, 1ull);
+}
+
+TEST(FontCollection, IsWarmedOnAnotherThread) {
+  std::shared_ptr<FontCollection> collection = GetTestFontCollection();
+
+  std::shared_ptr<minikin::FontCollection> warmed;
+  std::thread warm_up([&collection, &warmed]() {
+    for (uint32_t ch = 0x10FF00; ch < 0x10FF80; ch++) {
+      collection->MatchFallbackFont(ch, "en-US");
+    }
+    warmed = collection->GetMinikinFontCollectionForFamily("Roboto", "en-US");
+  });
+  for (uint32_t ch = 0x10FF00; ch < 0x10FF80; ch++) {
+    collection->MatchFallbackFont(ch, "ja");
+  }
+  warm_up.join();
+
+  ASSERT_NE(warmed, nullptr);
+  ASSERT_EQ(collection->GetMinikinFontCollectionForFamily("Roboto", "en-US"),
+            warmed);
+  ASSERT_EQ(collection->GetFallbackCacheStats().misses, 256ull);
+}
+
 #if 0
 
 TEST(FontCollection, HasDefaultRegistrations) {
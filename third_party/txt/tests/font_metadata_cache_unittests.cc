@@ -0,0 +1,109 @@
+/*
+ * Copyright 2018 Google, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+
+#include "gtest/gtest.h"
+#include "txt/font_metadata_cache.h"
+
+#if !defined(_WIN32)
+#include <unistd.h>
+
+namespace txt {
+
+TEST(FontMetadataCache, PersistsEntries) {
+  FontMetadataCache& cache = FontMetadataCache::GetInstance();
+
+  char directory[] = "/tmp/txt_font_metadata_cache_XXXXXX";
+  ASSERT_NE(mkdtemp(directory), nullptr);
+  std::string path = std::string(directory) + "/txt_font_metadata.cache";
+
+  ASSERT_FALSE(cache.IsEnabled());
+  cache.SetCacheDirectory(directory);
+  ASSERT_TRUE(cache.IsEnabled());
+  ASSERT_EQ(cache.GetEntryCount(), 0u);
+
+  const uint32_t ranges[] = {0x20, 0x7F, 0x4E00, 0x4E10};
+  minikin::SparseBitSet coverage(ranges, 2);
+  cache.Store(42, {minikin::FontStyle(4, false), minikin::FontStyle(7, true)},
+              coverage, true);
+
+  FontMetadataCache::Metadata metadata;
+  ASSERT_TRUE(cache.Lookup(42, 2, &metadata));
+  // Entries only match families with the same number of fonts.
+  ASSERT_FALSE(cache.Lookup(42, 1, &metadata));
+  ASSERT_FALSE(cache.Lookup(43, 2, &metadata));
+
+  ASSERT_TRUE(cache.Flush());
+
+  // Map the file again as a new process would.
+  cache.SetCacheDirectory("");
+  ASSERT_FALSE(cache.IsEnabled());
+  ASSERT_EQ(cache.GetEntryCount(), 0u);
+  cache.SetCacheDirectory(directory);
+  ASSERT_EQ(cache.GetEntryCount(), 1u);
+
+  ASSERT_TRUE(cache.Lookup(42, 2, &metadata));
+  ASSERT_EQ(metadata.styles.size(), 2u);
+  ASSERT_EQ(metadata.styles[0].getWeight(), 4);
+  ASSERT_FALSE(metadata.styles[0].getItalic());
+  ASSERT_EQ(metadata.styles[1].getWeight(), 7);
+  ASSERT_TRUE(metadata.styles[1].getItalic());
+  ASSERT_TRUE(metadata.has_vs_table);
+  ASSERT_TRUE(metadata.coverage.get('A'));
+  ASSERT_FALSE(metadata.coverage.get(0x7F));
+  ASSERT_TRUE(metadata.coverage.get(0x4E05));
+  ASSERT_FALSE(metadata.coverage.get(0x4E10));
+
+  // Later flushes keep the entries of the mapped file.
+  cache.Store(43, {minikin::FontStyle()}, coverage, false);
+  ASSERT_TRUE(cache.Flush());
+  ASSERT_EQ(cache.GetEntryCount(), 2u);
+  ASSERT_TRUE(cache.Lookup(42, 2, &metadata));
+  ASSERT_TRUE(cache.Lookup(43, 1, &metadata));
+
+  cache.SetCacheDirectory("");
+  unlink(path.c_str());
+  rmdir(directory);
+}
+
+TEST(FontMetadataCache, IgnoresFilesWithOtherVersion) {
+  FontMetadataCache& cache = FontMetadataCache::GetInstance();
+
+  char directory[] = "/tmp/txt_font_metadata_cache_XXXXXX";
+  ASSERT_NE(mkdtemp(directory), nullptr);
+  std::string path = std::string(directory) + "/txt_font_metadata.cache";
+  {
+    std::ofstream file(path, std::ios::binary);
+    const uint32_t header[] = {0x4D465854,
+                               FontMetadataCache::kFormatVersion + 1, 1, 0};
+    file.write(reinterpret_cast<const char*>(header), sizeof(header));
+    file << std::string(64, '\0');
+  }
+
+  cache.SetCacheDirectory(directory);
+  ASSERT_EQ(cache.GetEntryCount(), 0u);
+
+  cache.SetCacheDirectory("");
+  unlink(path.c_str());
+  rmdir(directory);
+}
+
+}  // namespace txt
+
+#endif  // !defined(_WIN32)
@@ -0,0 +1,108 @@
+/*
+ * Copyright 2018 Google, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "txt/hyphenator_cache.h"
+#include "utils/WindowsUtils.h"
+
+#if !defined(_WIN32)
+#include <unistd.h>
+#endif
+
+namespace txt {
+
+TEST(HyphenatorCache, ReturnsSameHyphenatorForLocale) {
+  HyphenatorCache& cache = HyphenatorCache::GetInstance();
+
+  minikin::Hyphenator* hyphenator = cache.GetHyphenator("zz-Test");
+  ASSERT_NE(hyphenator, nullptr);
+  ASSERT_EQ(cache.GetHyphenator("zz-Test"), hyphenator);
+  // Locales are matched case insensitively and with either separator.
+  ASSERT_EQ(cache.GetHyphenator("zz_TEST"), hyphenator);
+  ASSERT_NE(cache.GetHyphenator("zy"), hyphenator);
+}
+
+#if !defined(_WIN32)
+// Writes a .hyb file without patterns: a header, an empty alphabet, an empty
+// trie and an empty pattern table.
+static void WriteEmptyPatternFile(const std::string& path) {
+  const std::vector<uint32_t> words = {
+      0x62ad7968, 0, 24, 36, 60, 80,  // header
+      0, 0, 0,                        // alphabet
+      0, 0, 0, 0, 0, 0,               // trie
+      0, 0, 16, 0,                    // patterns
+      0,                              // padding
+  };
+  std::ofstream file(path, std::ios::binary);
+  file.write(reinterpret_cast<const char*>(words.data()),
+             words.size() * sizeof(uint32_t));
+}
+
+TEST(HyphenatorCache, MapsPatternsForLanguageSubtag) {
+  HyphenatorCache& cache = HyphenatorCache::GetInstance();
+  std::string old_directory = cache.GetPatternDirectory();
+
+  char directory[] = "/tmp/txt_hyphenator_cache_XXXXXX";
+  ASSERT_NE(mkdtemp(directory), nullptr);
+  std::string path = std::string(directory) + "/hyph-yy.hyb";
+  WriteEmptyPatternFile(path);
+
+  cache.SetPatternDirectory(directory);
+  size_t mapped_bytes = cache.GetMappedBytes();
+  // "yy-Latn-XX" falls back to the patterns of its language.
+  ASSERT_NE(cache.GetHyphenator("yy-Latn-XX"), nullptr);
+  ASSERT_EQ(cache.GetMappedBytes(), mapped_bytes + 80);
+  // The mapping is shared by later lookups.
+  cache.GetHyphenator("yy-Latn-XX");
+  ASSERT_EQ(cache.GetMappedBytes(), mapped_bytes + 80);
+
+  cache.SetPatternDirectory(old_directory);
+  unlink(path.c_str());
+  rmdir(directory);
+}
+
+TEST(HyphenatorCache, IgnoresInvalidPatternFiles) {
+  HyphenatorCache& cache = HyphenatorCache::GetInstance();
+  std::string old_directory = cache.GetPatternDirectory();
+
+  char directory[] = "/tmp/txt_hyphenator_cache_XXXXXX";
+  ASSERT_NE(mkdtemp(directory), nullptr);
+  std::string path = std::string(directory) + "/hyph-yx.hyb";
+  {
+    // No magic, and the tables would lie past the end of the file.
+    std::ofstream file(path, std::ios::binary);
+    file << std::string(64, '\xff');
+  }
+
+  cache.SetPatternDirectory(directory);
+  size_t mapped_bytes = cache.GetMappedBytes();
+  // The locale is still hyphenated at soft hyphens.
+  ASSERT_NE(cache.GetHyphenator("yx"), nullptr);
+  ASSERT_EQ(cache.GetMappedBytes(), mapped_bytes);
+
+  cache.SetPatternDirectory(old_directory);
+  unlink(path.c_str());
+  rmdir(directory);
+}
+#endif  // !defined(_WIN32)
+
+}  // namespace txt
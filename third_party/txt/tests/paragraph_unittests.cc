@@ -1475,6 +1475,96 @@ TEST_F(ParagraphTest, HyphenBreakParagraph) {
   ASSERT_TRUE(Snapshot());
 }
 
+TEST_F(ParagraphTest, LazyPaintDataParagraph) {
+  const char* text = "A paragraph that is only measured does not build blobs.";
+  auto icu_text = icu::UnicodeString::fromUTF8(text);
+  std::u16string u16_text(icu_text.getBuffer(),
+                          icu_text.getBuffer() + icu_text.length());
+
+  txt::ParagraphStyle paragraph_style;
+  txt::ParagraphBuilder builder(paragraph_style, GetTestFontCollection());
+
+  txt::TextStyle text_style;
+  text_style.font_family = "Roboto";
+  text_style.font_size = 26;
+  text_style.color = SK_ColorBLACK;
+  builder.PushStyle(text_style);
+  builder.AddText(u16_text);
+  builder.Pop();
+
+  auto paragraph = builder.Build();
+  paragraph->Layout(GetTestCanvasWidth() / 3);
+
+  // Measuring computes the metrics without any paint data, but keeps the
+  // shaped runs to build it from.
+  ASSERT_TRUE(paragraph->needs_paint_data_);
+  ASSERT_TRUE(paragraph->records_.empty());
+  ASSERT_GE(paragraph->run_layouts_.size(), paragraph->GetLineCount());
+  ASSERT_EQ(paragraph->glyph_positions_.size(), 0ull);
+  ASSERT_GT(paragraph->GetLineCount(), 1ull);
+  ASSERT_GT(paragraph->GetHeight(), 0);
+  ASSERT_GT(paragraph->GetMinIntrinsicWidth(), 0);
+  ASSERT_GE(paragraph->GetMaxIntrinsicWidth(),
+            paragraph->GetMinIntrinsicWidth());
+  double height = paragraph->GetHeight();
+
+  // Hit testing builds the paint data for every measured line.
+  ASSERT_FALSE(paragraph->GetRectsForRange(0, 1).empty());
+  ASSERT_FALSE(paragraph->needs_paint_data_);
+  ASSERT_TRUE(paragraph->run_layouts_.empty());
+  ASSERT_EQ(paragraph->line_glyph_starts_.size(),
+            paragraph->GetLineCount() + 1);
+  ASSERT_FALSE(paragraph->records_.empty());
+  ASSERT_EQ(paragraph->records_.back().line(),
+            paragraph->GetLineCount() - 1);
+  ASSERT_EQ(paragraph->GetHeight(), height);
+
+  // A new layout discards the stale paint data.
+  paragraph->Layout(GetTestCanvasWidth());
+  ASSERT_TRUE(paragraph->records_.empty());
+  ASSERT_EQ(paragraph->GetLineCount(), 1ull);
+
+  paragraph->Paint(GetCanvas(), 0, 0);
+  ASSERT_FALSE(paragraph->records_.empty());
+  ASSERT_TRUE(Snapshot());
+}
+
+TEST_F(ParagraphTest, SoftHyphenParagraph) {
+  const char* text = "Supercalifragilistic\u00ADexpialidocious";
+  auto icu_text = icu::UnicodeString::fromUTF8(text);
+  std::u16string u16_text(icu_text.getBuffer(),
+                          icu_text.getBuffer() + icu_text.length());
+  size_t soft_hyphen = u16_text.find(u'\u00AD');
+
+  txt::ParagraphStyle paragraph_style;
+  paragraph_style.hyphenation_frequency = minikin::kHyphenationFrequency_Normal;
+  txt::ParagraphBuilder builder(paragraph_style, GetTestFontCollection());
+
+  txt::TextStyle text_style;
+  text_style.font_family = "Roboto";
+  text_style.font_size = 30;
+  text_style.color = SK_ColorBLACK;
+  builder.PushStyle(text_style);
+  builder.AddText(u16_text);
+  builder.Pop();
+
+  auto paragraph = builder.Build();
+  paragraph->Layout(GetTestCanvasWidth());
+  ASSERT_EQ(paragraph->GetLineCount(), 1ull);
+
+  // Narrow the paragraph so that only the first half of the word fits.
+  paragraph->Layout(paragraph->GetMaxIntrinsicWidth() * 0.75);
+  paragraph->Paint(GetCanvas(), 0, 0);
+
+  ASSERT_EQ(paragraph->GetLineCount(), 2ull);
+  ASSERT_EQ(paragraph->line_ranges_[0].end, soft_hyphen + 1);
+  ASSERT_EQ(paragraph->line_ranges_[0].hyphen_edit,
+            minikin::HyphenEdit::INSERT_HYPHEN_AT_END);
+  ASSERT_EQ(paragraph->line_ranges_[1].hyphen_edit,
+            minikin::HyphenEdit::NO_EDIT);
+  ASSERT_TRUE(Snapshot());
+}
+
 TEST_F(ParagraphTest, RepeatLayoutParagraph) {
   const char* text =
       "Sentence to layout at diff widths to get diff line counts. short words "
@@ -1569,4 +1659,58 @@ TEST_F(ParagraphTest, Ellipsize) {
   ASSERT_EQ(paragraph->records_.size(), 1ull);
 }
 
+TEST_F(ParagraphTest, SharedTextBlobParagraph) {
+  const char* text = "$9.99";
+  auto icu_text = icu::UnicodeString::fromUTF8(text);
+  std::u16string u16_text(icu_text.getBuffer(),
+                          icu_text.getBuffer() + icu_text.length());
+
+  auto font_collection = GetTestFontCollection();
+  TextBlobCache& blob_cache = font_collection->GetTextBlobCache();
+  blob_cache.Clear();
+
+  txt::TextStyle text_style;
+  text_style.font_family = "Roboto";
+  text_style.color = SK_ColorBLACK;
+
+  std::vector<std::unique_ptr<Paragraph>> paragraphs;
+  for (size_t i = 0; i < 2; ++i) {
+    txt::ParagraphStyle paragraph_style;
+    txt::ParagraphBuilder builder(paragraph_style, font_collection);
+    builder.PushStyle(text_style);
+    builder.AddText(u16_text);
+    builder.Pop();
+    paragraphs.push_back(builder.Build());
+    paragraphs.back()->Layout(GetTestCanvasWidth());
+    paragraphs.back()->BuildPaintData();
+  }
+
+  ASSERT_EQ(paragraphs[0]->records_.size(), 1ull);
+  ASSERT_EQ(paragraphs[1]->records_.size(), 1ull);
+  ASSERT_EQ(paragraphs[0]->records_[0].text(),
+            paragraphs[1]->records_[0].text());
+  ASSERT_EQ(blob_cache.GetEntryCount(), 1ull);
+  ASSERT_EQ(blob_cache.GetHitCount(), 1ull);
+  ASSERT_GT(blob_cache.GetMemoryUsage(), 0ull);
+
+  // A different style must not reuse the blob.
+  text_style.font_size = 28;
+  txt::ParagraphStyle paragraph_style;
+  txt::ParagraphBuilder builder(paragraph_style, font_collection);
+  builder.PushStyle(text_style);
+  builder.AddText(u16_text);
+  builder.Pop();
+  auto large_paragraph = builder.Build();
+  large_paragraph->Layout(GetTestCanvasWidth());
+  large_paragraph->BuildPaintData();
+
+  ASSERT_NE(large_paragraph->records_[0].text(),
+            paragraphs[0]->records_[0].text());
+  ASSERT_EQ(blob_cache.GetEntryCount(), 2ull);
+
+  paragraphs[1]->Paint(GetCanvas(), 0, 0);
+  large_paragraph->Paint(GetCanvas(), 0, 50);
+  ASSERT_TRUE(Snapshot());
+}
+
 }  // namespace txt
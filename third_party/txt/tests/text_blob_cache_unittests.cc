@@ -0,0 +1,89 @@
+/*
+ * Copyright 2018 Google, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "gtest/gtest.h"
+#include "txt/text_blob_cache.h"
+
+namespace txt {
+
+namespace {
+
+TextBlobCache::Key MakeKey(const std::u16string& text, const TextStyle& style) {
+  const uint16_t* chars = reinterpret_cast<const uint16_t*>(text.data());
+  return TextBlobCache::Key(chars, 0, text.size(), 0, text.size(), 1, false,
+                            style);
+}
+
+std::shared_ptr<const ShapedRun> MakeRun(size_t glyph_count) {
+  auto run = std::make_shared<ShapedRun>();
+  run->blobs.emplace_back();
+  for (size_t i = 0; i < glyph_count; ++i)
+    run->blobs.back().positions.push_back({i, 1, i * 10.0, 10.0});
+  run->advance = glyph_count * 10.0;
+  return run;
+}
+
+}  // namespace
+
+TEST(TextBlobCache, GetReturnsPutRun) {
+  TextBlobCache cache;
+  TextStyle style;
+  auto run = MakeRun(4);
+
+  ASSERT_EQ(cache.Get(MakeKey(u"abcd", style)), nullptr);
+  cache.Put(MakeKey(u"abcd", style), run);
+  ASSERT_EQ(cache.Get(MakeKey(u"abcd", style)), run);
+  ASSERT_EQ(cache.GetHitCount(), 1ull);
+  ASSERT_EQ(cache.GetMissCount(), 1ull);
+
+  // The key includes the style.
+  style.font_size = 20;
+  ASSERT_EQ(cache.Get(MakeKey(u"abcd", style)), nullptr);
+}
+
+TEST(TextBlobCache, EvictsLeastRecentlyUsed) {
+  TextBlobCache cache;
+  TextStyle style;
+  cache.Put(MakeKey(u"a", style), MakeRun(1));
+  size_t entry_bytes = cache.GetMemoryUsage();
+  ASSERT_GT(entry_bytes, 0ull);
+
+  cache.SetMaxBytes(entry_bytes * 2);
+  cache.Put(MakeKey(u"b", style), MakeRun(1));
+  ASSERT_NE(cache.Get(MakeKey(u"a", style)), nullptr);
+
+  // "b" is now the least recently used entry.
+  cache.Put(MakeKey(u"c", style), MakeRun(1));
+  ASSERT_EQ(cache.GetEntryCount(), 2ull);
+  ASSERT_NE(cache.Get(MakeKey(u"a", style)), nullptr);
+  ASSERT_EQ(cache.Get(MakeKey(u"b", style)), nullptr);
+  ASSERT_NE(cache.Get(MakeKey(u"c", style)), nullptr);
+  ASSERT_LE(cache.GetMemoryUsage(), cache.GetMaxBytes());
+}
+
+TEST(TextBlobCache, ZeroBudgetDisablesCaching) {
+  TextBlobCache cache;
+  TextStyle style;
+  cache.Put(MakeKey(u"a", style), MakeRun(1));
+  cache.SetMaxBytes(0);
+  ASSERT_EQ(cache.GetEntryCount(), 0ull);
+  ASSERT_EQ(cache.GetMemoryUsage(), 0ull);
+
+  cache.Put(MakeKey(u"a", style), MakeRun(1));
+  ASSERT_EQ(cache.Get(MakeKey(u"a", style)), nullptr);
+}
+
+}  // namespace txt
@@ -0,0 +1,66 @@
+/*
+ * Copyright 2018 Google, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "gtest/gtest.h"
+#include "minikin/LayoutUtils.h"
+#include "third_party/icu/source/common/unicode/uchar.h"
+#include "txt/text_scanner.h"
+
+namespace txt {
+
+TEST(TextScanner, MandatoryLineBreaksMatchICU) {
+  std::vector<uint16_t> text;
+  for (uint32_t code_unit = 0; code_unit <= 0xFFFF; ++code_unit)
+    text.push_back(code_unit);
+
+  std::vector<size_t> expected;
+  for (size_t i = 0; i < text.size(); ++i) {
+    ULineBreak ulb = static_cast<ULineBreak>(
+        u_getIntPropertyValue(text[i], UCHAR_LINE_BREAK));
+    if (ulb == U_LB_LINE_FEED || ulb == U_LB_MANDATORY_BREAK)
+      expected.push_back(i);
+  }
+
+  // Use every alignment of the start and end of the scanned range.
+  for (size_t offset = 0; offset < 9; ++offset) {
+    std::vector<size_t> breaks;
+    FindMandatoryLineBreaks(text.data(), offset, text.size() - offset,
+                            &breaks);
+    std::vector<size_t> expected_in_range;
+    for (size_t index : expected) {
+      if (index >= offset && index < text.size() - offset)
+        expected_in_range.push_back(index);
+    }
+    ASSERT_EQ(breaks, expected_in_range);
+  }
+}
+
+TEST(TextScanner, FindWordSpace) {
+  std::u16string str = u"one two three   four five six seven eight";
+  const uint16_t* text = reinterpret_cast<const uint16_t*>(str.data());
+  for (size_t start = 0; start < str.size(); ++start) {
+    for (bool is_space : {false, true}) {
+      size_t expected = start;
+      while (expected < str.size() &&
+             minikin::isWordSpace(text[expected]) != is_space)
+        expected++;
+      ASSERT_EQ(FindWordSpace(text, start, str.size(), is_space), expected);
+    }
+  }
+  ASSERT_EQ(FindWordSpace(text, 3, 3, true), 3ull);
+}
+
+}  // namespace txt